@@ -0,0 +1,279 @@
+/**
+ * meshconverter_bench: throughput of every reader, writer and operation of the library
+ * over a range of mesh sizes, on generated meshes (MeshGenerator.h). Every case is run --repeat times on a fresh copy of the
+ * mesh, and min / median / mean / stddev of the wall time are reported, with the
+ * throughput of the median run in elements/s (points + facets) and MB/s (file size,
+ * readers and writers only). --csv writes the same table for diffing between builds.
+ *
+ *   meshconverter_bench --sizes 10000,100000,1000000,10000000 --repeat 5 --csv bench.csv
+ */
+#include "MeshAPI.h"
+#include "MeshGenerator.h"
+#include "CLI11.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Mesh {
+    Eigen::MatrixXd V;
+    Eigen::MatrixXi F;
+    Eigen::MatrixXi M;
+};
+
+struct Result {
+    string name;
+    long facets = 0;
+    long points = 0;
+    int repeats = 0;
+    double minSeconds = 0, medianSeconds = 0, meanSeconds = 0, stddevSeconds = 0;
+    long bytes = 0;
+};
+
+// The library reports progress on std::cout, silenced while timing.
+class QuietCout {
+public:
+    QuietCout() : saved(std::cout.rdbuf(sink.rdbuf())) {}
+    ~QuietCout() { std::cout.rdbuf(saved); }
+
+private:
+    std::ostringstream sink;
+    std::streambuf *saved;
+};
+
+/**
+ * Run body repeats times, prepare runs untimed before every repetition.
+ */
+Result measure(const string &name, const Mesh &mesh, int repeats, const function<void()> &prepare, const function<void()> &body)
+{
+    vector<double> seconds;
+    for(int k = 0; k < repeats; k++) {
+        prepare();
+        QuietCout quiet;
+        auto start = chrono::steady_clock::now();
+        body();
+        seconds.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    Result r;
+    r.name = name;
+    r.facets = mesh.F.rows();
+    r.points = mesh.V.rows();
+    r.repeats = repeats;
+    sort(seconds.begin(), seconds.end());
+    r.minSeconds = seconds.front();
+    r.medianSeconds = seconds[seconds.size() / 2];
+    for(double s : seconds)
+        r.meanSeconds += s / seconds.size();
+    for(double s : seconds)
+        r.stddevSeconds += (s - r.meanSeconds) * (s - r.meanSeconds) / seconds.size();
+    r.stddevSeconds = sqrt(r.stddevSeconds);
+    return r;
+}
+
+double elementsPerSecond(const Result &r)
+{
+    return r.medianSeconds > 0 ? (r.points + r.facets) / r.medianSeconds : 0.0;
+}
+
+double megabytesPerSecond(const Result &r)
+{
+    return r.medianSeconds > 0 ? r.bytes / r.medianSeconds / (1 << 20) : 0.0;
+}
+
+void printResult(const Result &r)
+{
+    printf("%-22s %10ld %8d %10.5f %10.5f %10.5f %12.4g %10.1f\n", r.name.c_str(), r.facets, r.repeats,
+           r.minSeconds, r.medianSeconds, r.stddevSeconds, elementsPerSecond(r), megabytesPerSecond(r));
+    fflush(stdout);
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    CLI::App app{"meshconverter_bench"};
+    vector<long> sizes = {10000, 100000, 1000000};
+    int repeats = 5;
+    string csvFile;
+    string filter;
+    string workDir = (fs::temp_directory_path() / "meshconverter_bench").string();
+    string shapeName = "sphere";
+    app.add_option("--sizes", sizes, "Facet counts to measure, up to 10M. (default: 10000,100000,1000000)")->delimiter(',');
+    app.add_option("--repeat", repeats, "Runs of every case. (default: 5)");
+    app.add_option("--csv", csvFile, "Also write the results as CSV.");
+    app.add_option("--filter", filter, "Only run the cases whose name contains this string.");
+    app.add_option("--dir", workDir, "Directory for the files written and read back.");
+    app.add_option("--shape", shapeName, "Generated mesh, sphere | torus | shells | patches | soup | markers. (default: sphere)");
+    CLI11_PARSE(app, argc, argv);
+    repeats = max(1, repeats);
+    MESHIO::GeneratorOptions generator;
+    if(!MESHIO::shapeFromName(shapeName, generator.shape))
+        return -1;
+
+    fs::create_directories(workDir);
+    vector<Result> results;
+    printf("%-22s %10s %8s %10s %10s %10s %12s %10s\n", "case", "facets", "repeats", "min(s)", "median(s)", "stddev(s)", "elements/s", "MB/s");
+
+    for(long size : sizes) {
+        Mesh mesh;
+        generator.facets = size;
+        MESHIO::generateMesh(generator, mesh.V, mesh.F, mesh.M);
+        Mesh work;
+        auto copy = [&]() { work = mesh; };
+        auto none = []() {};
+        auto run = [&](const string &name, const function<void()> &prepare, const function<void()> &body, long bytes) {
+            if(!filter.empty() && name.find(filter) == string::npos)
+                return;
+            Result r = measure(name, mesh, repeats, prepare, body);
+            r.bytes = bytes;
+            printResult(r);
+            results.push_back(r);
+        };
+
+        //********* Writers, their files are the inputs of the readers *********
+        const string base = (fs::path(workDir) / (shapeName + to_string(size))).string();
+        const vector<string> formats = {"vtk", "mesh", "ply", "pls", "facet", "obj", "mcb"};
+        for(const string &format : formats) {
+            const string file = base + "." + format;
+            const MESHIO::MeshFormat fmt = MESHIO::formatFromName(format);
+            auto write = [&]() {
+                std::ofstream out(file, std::ios::binary);
+                MESHIO::writeMesh(out, fmt, mesh.V, mesh.F, mesh.M);
+            };
+            if(!filter.empty() && ("write:" + format).find(filter) == string::npos && ("read:" + format).find(filter) == string::npos)
+                continue;
+            write();
+            run("write:" + format, none, write, MESHIO::fileBytes(file));
+        }
+
+        //********* The same writers on the row-major layout *********
+        const MESHIO::MeshData<MESHIO::MeshLayout::AoS> aos = MESHIO::toLayout<MESHIO::MeshLayout::AoS>(
+            MESHIO::MeshData<MESHIO::MeshLayout::SoA>{mesh.V, mesh.F, mesh.M});
+        for(const char *format : {"vtk", "mesh", "ply", "pls", "facet", "obj"}) {
+            const string file = base + ".aos." + format;
+            const MESHIO::MeshFormat fmt = MESHIO::formatFromName(format);
+            auto write = [&]() {
+                std::ofstream out(file, std::ios::binary);
+                MESHIO::writeMesh(out, fmt, aos);
+            };
+            if(!filter.empty() && (string("write:") + format + ":aos").find(filter) == string::npos)
+                continue;
+            write();
+            run(string("write:") + format + ":aos", none, write, MESHIO::fileBytes(file));
+            fs::remove(file);
+        }
+
+        //********* Readers *********
+        for(const char *format : {"vtk", "mesh", "pls", "obj", "mcb"}) {
+            const string file = base + "." + format;
+            if(!fs::exists(file))
+                continue;
+            run(string("read:") + format, none, [&]() {
+                Mesh in;
+                MESHIO::readMesh(file, in.V, in.F, in.M);
+            }, MESHIO::fileBytes(file));
+        }
+        for(const char *format : {"vtk", "pls", "obj"}) {
+            const string file = base + "." + format;
+            if(!fs::exists(file))
+                continue;
+            run(string("read:") + format + ":f32", none, [&]() {
+                MESHIO::MeshData<MESHIO::MeshLayout::SoA, float> in;
+                MESHIO::readMesh(file, in);
+            }, MESHIO::fileBytes(file));
+        }
+
+        if(fs::exists(base + ".vtk")) {
+            run("read:vtk:arrays", none, [&]() {
+                Mesh in;
+                MESHIO::MeshAttributes attributes;
+                MESHIO::readMesh(base + ".vtk", in.V, in.F, in.M, attributes);
+            }, MESHIO::fileBytes(base + ".vtk"));
+            run("read:vtk:cells", none, [&]() {
+                MESHIO::CellMesh in;
+                MESHIO::readVTK(base + ".vtk", in);
+            }, MESHIO::fileBytes(base + ".vtk"));
+        }
+
+        if(fs::exists(base + ".mcb")) {
+            run("open:mcb", none, [&]() {
+                MESHIO::MappedMesh mapped;
+                mapped.open(base + ".mcb");
+            }, 0);
+        }
+
+        //********* Operations *********
+        const vector<double> rotateVec = {0, 0, 1, 0.25};
+        const vector<double> boxVec = {3, 3, 3};
+        run("rotatePoint", copy, [&]() { MESHIO::rotatePoint(rotateVec, work.V, work.F); }, 0);
+        run("addBox", copy, [&]() { MESHIO::addBox(boxVec, work.V, work.F, work.M); }, 0);
+        run("repair", copy, [&]() { MESHIO::repair(work.V, work.F, work.M); }, 0);
+        MESHIO::MeshData<MESHIO::MeshLayout::AoS> workAoS;
+        run("repair:aos", [&]() { workAoS = aos; }, [&]() { MESHIO::repair(workAoS); }, 0);
+        const MESHIO::MeshData<MESHIO::MeshLayout::SoA, float> f32{mesh.V.cast<float>(), mesh.F, mesh.M};
+        MESHIO::MeshData<MESHIO::MeshLayout::SoA, float> workF32;
+        run("repair:f32", [&]() { workF32 = f32; }, [&]() { MESHIO::repair(workF32); }, 0);
+        run("toLayout:aos", none, [&]() { MESHIO::toLayout<MESHIO::MeshLayout::AoS>(MESHIO::MeshData<MESHIO::MeshLayout::SoA>{mesh.V, mesh.F, mesh.M}); }, 0);
+        MESHIO::CellMesh cells;
+        MESHIO::toCells(mesh.V, mesh.F, mesh.M, cells);
+        run("triangulate", none, [&]() { MESHIO::triangulate(cells, work.F, work.M); }, 0);
+        MESHIO::GeneratorOptions volumeGenerator;
+        volumeGenerator.shape = MESHIO::GeneratedShape::Tetrahedra;
+        volumeGenerator.facets = size;
+        Mesh volume;
+        MESHIO::generateMesh(volumeGenerator, volume.V, volume.F, volume.M);
+        run("extractSurface", none, [&]() { MESHIO::extractSurface(volume.V, volume.F, volume.M, work.F, work.M); }, 0);
+        Eigen::MatrixXd normals;
+        run("normals:area", none, [&]() { MESHIO::computeVertexNormals(mesh.V, mesh.F, normals, MESHIO::NormalWeighting::Area); }, 0);
+        run("normals:angle", none, [&]() { MESHIO::computeVertexNormals(mesh.V, mesh.F, normals, MESHIO::NormalWeighting::Angle); }, 0);
+        MESHIO::MeshQuality quality;
+        run("quality", none, [&]() { MESHIO::computeQuality(mesh.V, mesh.F, quality); }, 0);
+        MESHIO::FacetBVH bvh;
+        run("bvh:build", none, [&]() { MESHIO::buildBVH(mesh.V, mesh.F, bvh); }, 0);
+        const Eigen::MatrixXd queries = mesh.V * 1.05;
+        const Eigen::MatrixXd origins = Eigen::MatrixXd::Zero(mesh.V.rows(), 3);
+        Eigen::MatrixXd closest;
+        Eigen::VectorXd distance;
+        Eigen::VectorXi hitFacet;
+        run("bvh:closest", none, [&]() { MESHIO::closestPoints(bvh, mesh.V, mesh.F, queries, closest, hitFacet, distance); }, 0);
+        run("bvh:rays", none, [&]() { MESHIO::intersectRays(bvh, mesh.V, mesh.F, origins, mesh.V, distance, hitFacet); }, 0);
+        const long nCheck = min<long>(2000, mesh.V.rows());
+        if(MESHIO::checkBVH(bvh, mesh.V, mesh.F, queries.topRows(nCheck), origins.topRows(nCheck), mesh.V.topRows(nCheck)) < 0)
+            return 1;
+        MESHIO::DecimateOptions decimation;
+        decimation.targetFacets = mesh.F.rows() / 10;
+        run("decimate", copy, [&]() { MESHIO::decimate(work.V, work.F, work.M, decimation); }, 0);
+        MESHIO::DecimateOptions partitioned = decimation;
+        partitioned.parallel = true;
+        run("decimate:parallel", copy, [&]() { MESHIO::decimate(work.V, work.F, work.M, partitioned); }, 0);
+        run("reverseOrient", copy, [&]() { MESHIO::reverseOrient(work.F); }, 0);
+        run("resetOrientation", copy, [&]() { MESHIO::resetOrientation(work.V, work.F, work.M); }, 0);
+
+        for(const string &format : formats)
+            fs::remove(base + "." + format);
+    }
+
+    if(!csvFile.empty()) {
+        std::ofstream csv(csvFile);
+        csv.precision(6);
+        csv << "case,facets,points,repeats,min_s,median_s,mean_s,stddev_s,elements_per_s,mb_per_s\n";
+        for(const Result &r : results)
+            csv << r.name << "," << r.facets << "," << r.points << "," << r.repeats << "," << r.minSeconds << ","
+                << r.medianSeconds << "," << r.meanSeconds << "," << r.stddevSeconds << "," << elementsPerSecond(r) << ","
+                << megabytesPerSecond(r) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,250 @@
+#include "MeshAPI.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define CHUNK_SIZE (1 << 16)
+
+using namespace std;
+
+namespace {
+
+// Reads a caller's buffer in place, without copying it into a stringstream.
+class MemoryStreamBuf : public std::streambuf {
+public:
+    MemoryStreamBuf(const char *data, size_t size) {
+        char *begin = const_cast<char *>(data);
+        setg(begin, begin, begin + size);
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        if(!(which & std::ios_base::in))
+            return pos_type(off_type(-1));
+        char *target = dir == std::ios_base::beg ? eback() + off : dir == std::ios_base::cur ? gptr() + off : egptr() + off;
+        if(target < eback() || target > egptr())
+            return pos_type(off_type(-1));
+        setg(eback(), target, egptr());
+        return pos_type(target - eback());
+    }
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+// Buffered writes to a file descriptor.
+class FdStreamBuf : public std::streambuf {
+public:
+    explicit FdStreamBuf(int fd) : fd(fd), buffer(CHUNK_SIZE) {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+    ~FdStreamBuf() {
+        sync();
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if(sync() != 0)
+            return traits_type::eof();
+        if(!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+    int sync() override {
+        const char *p = pbase();
+        while(p < pptr()) {
+#ifdef _WIN32
+            long n = _write(fd, p, (unsigned)(pptr() - p));
+#else
+            long n = ::write(fd, p, pptr() - p);
+#endif
+            if(n <= 0)
+                return -1;
+            p += n;
+        }
+        setp(buffer.data(), buffer.data() + buffer.size());
+        return 0;
+    }
+
+private:
+    int fd;
+    std::vector<char> buffer;
+};
+
+}
+
+MESHIO::MeshFormat MESHIO::formatFromName(const std::string &name)
+{
+    size_t dotpos = name.find_last_of('.');
+    string ext = dotpos == string::npos ? name : name.substr(dotpos + 1);
+    transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if(ext == "vtk") return MeshFormat::VTK;
+    if(ext == "mesh") return MeshFormat::MESH;
+    if(ext == "ply") return MeshFormat::PLY;
+    if(ext == "pls") return MeshFormat::PLS;
+    if(ext == "facet") return MeshFormat::Facet;
+    if(ext == "obj") return MeshFormat::OBJ;
+    if(ext == "mcb") return MeshFormat::MCB;
+    return MeshFormat::Unknown;
+}
+
+const char *MESHIO::formatExtension(MeshFormat format)
+{
+    switch(format) {
+    case MeshFormat::VTK: return "vtk";
+    case MeshFormat::MESH: return "mesh";
+    case MeshFormat::PLY: return "ply";
+    case MeshFormat::PLS: return "pls";
+    case MeshFormat::Facet: return "facet";
+    case MeshFormat::OBJ: return "obj";
+    case MeshFormat::MCB: return "mcb";
+    default: return "";
+    }
+}
+
+/**
+ * Read a whole mesh from a stream into matrices.
+ * @return 1/-1, -1 as well for the formats without reader (PLY, facet).
+ */
+int MESHIO::readMesh(std::istream &in, MeshFormat format, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M)
+{
+    switch(format) {
+    case MeshFormat::VTK: return MESHIO::readVTK(in, V, T, M);
+    case MeshFormat::MESH: return MESHIO::readMESH(in, V, T, M);
+    case MeshFormat::PLS: return MESHIO::readPLS(in, V, T, M);
+    case MeshFormat::OBJ: return MESHIO::readOBJ(in, V, T, M);
+    case MeshFormat::MCB: return MESHIO::readMCB(in, V, T, M);
+    default:
+        cout << "Unsupported input format - " << formatExtension(format) << endl;
+        return -1;
+    }
+}
+
+int MESHIO::readMesh(const char *data, size_t size, MeshFormat format, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M)
+{
+    MemoryStreamBuf buf(data, size);
+    std::istream in(&buf);
+    return MESHIO::readMesh(in, format, V, T, M);
+}
+
+/**
+ * Read a mesh chunk by chunk straight into the caller's buffers, see MeshBuffer.
+ * @return 1, or -1 on failure or when the buffers are too small.
+ */
+static int readIntoBuffer(MESHIO::MeshStreamReader &reader, MESHIO::MeshBuffer &buffer)
+{
+    vector<double> points;
+    vector<int64_t> facets;
+    vector<int> marks;
+    bool fits = true;
+
+    buffer.nPoints = 0;
+    long n;
+    while((n = reader.readPoints(points, CHUNK_SIZE)) > 0) {
+        long keep = max(0L, min(n, buffer.pointCapacity - buffer.nPoints));
+        if(keep > 0)
+            memcpy(buffer.points + 3 * buffer.nPoints, points.data(), 3 * keep * sizeof(double));
+        fits = fits && keep == n;
+        buffer.nPoints += n;
+    }
+    if(!reader.beginFacets())
+        return -1;
+
+    buffer.nFacets = 0;
+    buffer.nCorner = reader.nCorner;
+    buffer.hasMarks = reader.hasMarks;
+    while((n = reader.readFacets(facets, marks, CHUNK_SIZE)) > 0) {
+        long keep = max(0L, min(n, buffer.facetCapacity - buffer.nFacets));
+        if(keep > 0) {
+            copy(facets.begin(), facets.begin() + buffer.nCorner * keep, buffer.facets + buffer.nCorner * buffer.nFacets);
+            if(buffer.marks) {
+                if(buffer.hasMarks)
+                    memcpy(buffer.marks + buffer.nFacets, marks.data(), keep * sizeof(int));
+                else
+                    fill(buffer.marks + buffer.nFacets, buffer.marks + buffer.nFacets + keep, 0);
+            }
+        }
+        fits = fits && keep == n;
+        buffer.nFacets += n;
+    }
+    return fits ? 1 : -1;
+}
+
+int MESHIO::readMesh(std::istream &in, MeshFormat format, MeshBuffer &buffer)
+{
+    std::unique_ptr<MeshStreamReader> reader = makeStreamReader(formatExtension(format));
+    if(!reader) {
+        cout << "Unsupported input format - " << formatExtension(format) << endl;
+        return -1;
+    }
+    if(!reader->open(in))
+        return -1;
+    return readIntoBuffer(*reader, buffer);
+}
+
+int MESHIO::readMesh(const char *data, size_t size, MeshFormat format, MeshBuffer &buffer)
+{
+    MemoryStreamBuf buf(data, size);
+    std::istream in(&buf);
+    return MESHIO::readMesh(in, format, buffer);
+}
+
+int MESHIO::readMesh(const std::string &filename, MeshBuffer &buffer)
+{
+    std::unique_ptr<MeshStreamReader> reader = makeStreamReader(formatExtension(formatFromName(filename)));
+    if(!reader) {
+        cout << "Unsupported input format - " << filename << endl;
+        return -1;
+    }
+    if(!reader->open(filename))
+        return -1;
+    return readIntoBuffer(*reader, buffer);
+}
+
+/**
+ * Write a mesh to a stream. M may be empty when the format or the mesh has no markers.
+ * @return 1/-1
+ */
+int MESHIO::writeMesh(std::ostream &out, MeshFormat format, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M)
+{
+    int result = -1;
+    switch(format) {
+    case MeshFormat::VTK: result = MESHIO::writeVTK(out, V, T, M); break;
+    case MeshFormat::MESH: result = MESHIO::writeMESH(out, V, T); break;
+    case MeshFormat::PLY: result = MESHIO::writePLY(out, V, T); break;
+    case MeshFormat::PLS: result = MESHIO::writePLS(out, V, T, M); break;
+    case MeshFormat::Facet: MESHIO::writeFacet(out, V, T, M); result = 1; break;
+    case MeshFormat::OBJ: result = MESHIO::writeOBJ(out, V, T, M); break;
+    case MeshFormat::MCB: result = MESHIO::writeMCB(out, V, T, M); break;
+    default:
+        cout << "Unsupported output format." << endl;
+        return -1;
+    }
+    out.flush();
+    return result > 0 && out ? 1 : -1;
+}
+
+int MESHIO::writeMesh(std::string &out, MeshFormat format, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M)
+{
+    std::ostringstream ss;
+    int result = MESHIO::writeMesh(ss, format, V, T, M);
+    out += ss.str();
+    return result;
+}
+
+int MESHIO::writeMesh(int fd, MeshFormat format, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M)
+{
+    FdStreamBuf buf(fd);
+    std::ostream out(&buf);
+    return MESHIO::writeMesh(out, format, V, T, M);
+}
@@ -0,0 +1,121 @@
+#ifndef MESH_API_H
+#define MESH_API_H
+
+/**
+ * Public interface of the meshconverter library, for programs that convert meshes in
+ * process instead of spawning MeshConverter on temporary files.
+ *  - readers fill Eigen matrices or caller-provided buffers, from a file, a stream or memory,
+ *  - .mcb files open as MappedMesh, Eigen::Map views of the file without parsing,
+ *  - VTK cells of mixed sizes read into a CellMesh (MeshCells.h), triangulate() splits them,
+ *  - VTK point and cell data arrays read into MeshAttributes (MeshAttributes.h),
+ *  - writers write to a file, a stream, a string in memory or a file descriptor,
+ *  - a FacetBVH (MeshBVH.h) answers closest-point and ray queries on the triangles,
+ *  - the operations (meshIO.h, MeshTransform.h, MeshStats.h, MeshBoundary.h, MeshOrient.h, MeshNormals.h,
+ *    MeshQuality.h, MeshDecimate.h)
+ *    work on the in-memory mesh, processMesh applies a whole ConvertOptions to it.
+ * Every function returns 1 on success and -1 on failure, like the rest of MESHIO.
+ */
+
+#include "meshIO.h"
+#include "MeshOrient.h"
+#include "MeshBoundary.h"
+#include "MeshTransform.h"
+#include "MeshStats.h"
+#include "MeshStream.h"
+#include "MeshConvert.h"
+#include "MeshBinary.h"
+#include "MeshLayout.h"
+#include "MeshCells.h"
+#include "MeshNormals.h"
+#include "MeshQuality.h"
+#include "MeshBVH.h"
+#include "MeshDecimate.h"
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace MESHIO {
+
+	enum class MeshFormat { Unknown, VTK, MESH, PLY, PLS, Facet, OBJ, MCB };
+
+	// Format of a file name or of a bare extension ("obj", ".obj", "part.obj").
+	MeshFormat formatFromName(const std::string &name);
+	const char *formatExtension(MeshFormat format);
+
+	/**
+	 * Mesh storage owned by the caller: points holds 3 doubles per point, facets nCorner ints
+	 * per facet, marks one int per facet and may be null. On return nPoints, nFacets and
+	 * nCorner give the size of the mesh. When a capacity is too small nothing past it is
+	 * written, the read goes on to count the mesh and -1 is returned, so a call with zero
+	 * capacities gives the sizes to allocate.
+	 */
+	struct MeshBuffer {
+		double *points = nullptr;
+		long pointCapacity = 0;
+		int *facets = nullptr;
+		long facetCapacity = 0;
+		int *marks = nullptr;
+		long nPoints = 0;
+		long nFacets = 0;
+		int nCorner = 3;
+		bool hasMarks = false;
+	};
+
+	int readMesh(std::istream &in, MeshFormat format, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
+	int readMesh(const char *data, size_t size, MeshFormat format, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
+	int readMesh(std::istream &in, MeshFormat format, MeshBuffer &buffer);
+	int readMesh(const char *data, size_t size, MeshFormat format, MeshBuffer &buffer);
+	int readMesh(const std::string &filename, MeshBuffer &buffer);
+
+	int writeMesh(std::ostream &out, MeshFormat format, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M);
+	// Appends to out.
+	int writeMesh(std::string &out, MeshFormat format, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M);
+	// Writes to an open descriptor (file, pipe, socket), which is left open.
+	int writeMesh(int fd, MeshFormat format, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M);
+
+	// A mesh in either layout (MeshLayout.h). The readers parse into SoA, AoS costs one toLayout copy.
+	template<MeshLayout L, class Scalar, class Index>
+	int readMesh(const std::string &filename, MeshData<L, Scalar, Index> &mesh)
+	{
+		MeshData<MeshLayout::SoA, Scalar, Index> soa;
+		if(MESHIO::readMesh(filename, soa.V, soa.T, soa.M) < 0)
+			return -1;
+		if constexpr(L == MeshLayout::SoA)
+			mesh = std::move(soa);
+		else
+			mesh = toLayout<L>(soa);
+		return 1;
+	}
+
+	// The text writers walk the layout as it is; .mcb is column-major, so AoS is copied first.
+	template<MeshLayout L, class Scalar, class Index>
+	int writeMesh(std::ostream &out, MeshFormat format, const MeshData<L, Scalar, Index> &mesh)
+	{
+		int result = -1;
+		switch(format) {
+		case MeshFormat::VTK: result = Kernels::writeVTK(out, mesh.V, mesh.T, mesh.M); break;
+		case MeshFormat::MESH: result = Kernels::writeMESH(out, mesh.V, mesh.T); break;
+		case MeshFormat::PLY: result = Kernels::writePLY(out, mesh.V, mesh.T); break;
+		case MeshFormat::PLS: result = Kernels::writePLS(out, mesh.V, mesh.T, mesh.M); break;
+		case MeshFormat::Facet: Kernels::writeFacet(out, mesh.V, mesh.T, mesh.M); result = 1; break;
+		case MeshFormat::OBJ: result = Kernels::writeOBJ(out, mesh.V, mesh.T, mesh.M); break;
+		case MeshFormat::MCB:
+			if constexpr(L == MeshLayout::SoA) {
+				result = MESHIO::writeMCB(out, mesh.V, mesh.T, mesh.M);
+			} else {
+				MeshData<MeshLayout::SoA, Scalar, Index> soa = toLayout<MeshLayout::SoA>(mesh);
+				result = MESHIO::writeMCB(out, soa.V, soa.T, soa.M);
+			}
+			break;
+		default:
+			std::cout << "Unsupported output format." << std::endl;
+			return -1;
+		}
+		out.flush();
+		return result > 0 && out ? 1 : -1;
+	}
+};
+
+#endif
@@ -0,0 +1,328 @@
+#include "MeshAttributes.h"
+#include "MeshLayout.h"
+#include "MeshTrace.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+// Call f with a value of the C++ type of type.
+template<class F>
+void dispatch(MESHIO::AttributeType type, F f)
+{
+    using MESHIO::AttributeType;
+    switch(type) {
+    case AttributeType::Int8: f(int8_t()); break;
+    case AttributeType::UInt8: f(uint8_t()); break;
+    case AttributeType::Int16: f(int16_t()); break;
+    case AttributeType::UInt16: f(uint16_t()); break;
+    case AttributeType::Int32: f(int32_t()); break;
+    case AttributeType::UInt32: f(uint32_t()); break;
+    case AttributeType::Int64: f(int64_t()); break;
+    case AttributeType::UInt64: f(uint64_t()); break;
+    case AttributeType::Float32: f(float()); break;
+    case AttributeType::Float64: f(double()); break;
+    }
+}
+
+/**
+ * Read the rows x components values of a, listed tuple by tuple, into its column-major
+ * buffer. Tokens go through strtod / strtoll, so nan and inf are read too.
+ */
+template<class T>
+bool parseValues(std::istream &in, MESHIO::MeshAttribute &a)
+{
+    T *v = a.values<T>();
+    std::string token;
+    for(long r = 0; r < a.rows; r++) {
+        for(int c = 0; c < a.components; c++) {
+            if(!(in >> token))
+                return false;
+            if(std::is_same<T, float>::value)
+                v[c * a.rows + r] = (T)strtof(token.c_str(), nullptr);
+            else if(std::is_floating_point<T>::value)
+                v[c * a.rows + r] = (T)strtod(token.c_str(), nullptr);
+            else if(std::is_same<T, uint64_t>::value)
+                v[c * a.rows + r] = (T)strtoull(token.c_str(), nullptr, 10);
+            else
+                v[c * a.rows + r] = (T)strtoll(token.c_str(), nullptr, 10);
+        }
+    }
+    return true;
+}
+
+bool parseAttribute(std::istream &in, MESHIO::MeshAttribute &a, long rows)
+{
+    a.resize(rows);
+    bool ok = false;
+    dispatch(a.type, [&](auto t) { ok = parseValues<decltype(t)>(in, a); });
+    return ok;
+}
+
+template<class T>
+void printValues(std::ostream &f, const MESHIO::MeshAttribute &a)
+{
+    // +v prints the 8-bit types as numbers, not characters.
+    const T *v = a.values<T>();
+    for(long r = 0; r < a.rows; r++) {
+        for(int c = 0; c < a.components; c++)
+            f << (c ? " " : "") << +v[c * a.rows + r];
+        f << "\n";
+    }
+}
+
+void printAttribute(std::ostream &f, const MESHIO::MeshAttribute &a)
+{
+    f.precision(a.type == MESHIO::AttributeType::Float32 ? MESHIO::Kernels::outputPrecision<float>()
+                                                         : MESHIO::Kernels::outputPrecision<double>());
+    dispatch(a.type, [&](auto t) { printValues<decltype(t)>(f, a); });
+}
+
+// Skip whitespace, then read a line when the next word is keyword.
+void skipLine(std::istream &in, const char *keyword)
+{
+    in >> std::ws;
+    if(in.peek() != keyword[0])
+        return;
+    std::string line;
+    std::streampos at = in.tellg();
+    getline(in, line);
+    if(line.compare(0, strlen(keyword), keyword) != 0) {
+        in.clear();
+        in.seekg(at);
+    }
+}
+
+}
+
+size_t MESHIO::attributeTypeBytes(AttributeType type)
+{
+    size_t bytes = 0;
+    dispatch(type, [&](auto t) { bytes = sizeof(t); });
+    return bytes;
+}
+
+const char *MESHIO::vtkTypeName(AttributeType type)
+{
+    switch(type) {
+    case AttributeType::Int8: return "char";
+    case AttributeType::UInt8: return "unsigned_char";
+    case AttributeType::Int16: return "short";
+    case AttributeType::UInt16: return "unsigned_short";
+    case AttributeType::Int32: return "int";
+    case AttributeType::UInt32: return "unsigned_int";
+    case AttributeType::Int64: return "vtktypeint64";
+    case AttributeType::UInt64: return "vtktypeuint64";
+    case AttributeType::Float32: return "float";
+    case AttributeType::Float64: return "double";
+    }
+    return "double";
+}
+
+bool MESHIO::vtkType(const std::string &name, AttributeType &type)
+{
+    static const std::pair<const char *, AttributeType> names[] = {
+        {"bit", AttributeType::UInt8}, {"char", AttributeType::Int8}, {"signed_char", AttributeType::Int8},
+        {"unsigned_char", AttributeType::UInt8}, {"short", AttributeType::Int16}, {"unsigned_short", AttributeType::UInt16},
+        {"int", AttributeType::Int32}, {"unsigned_int", AttributeType::UInt32}, {"long", AttributeType::Int64},
+        {"unsigned_long", AttributeType::UInt64}, {"vtkIdType", AttributeType::Int64}, {"vtktypeint64", AttributeType::Int64},
+        {"vtktypeuint64", AttributeType::UInt64}, {"float", AttributeType::Float32}, {"double", AttributeType::Float64}};
+    for(const auto &n : names) {
+        if(name == n.first) {
+            type = n.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+MESHIO::MeshAttribute::MeshAttribute(const std::string &name, bool onPoints, const Eigen::MatrixXd &values)
+    : name(name), onPoints(onPoints), components((int)values.cols())
+{
+    resize(values.rows());
+    memcpy(data.data(), values.data(), data.size());
+}
+
+void MESHIO::MeshAttribute::resize(long n)
+{
+    rows = n;
+    data.assign(rows * components * attributeTypeBytes(type), 0);
+}
+
+double MESHIO::MeshAttribute::value(long r, int c) const
+{
+    double v = 0.0;
+    dispatch(type, [&](auto t) { v = (double)values<decltype(t)>()[c * rows + r]; });
+    return v;
+}
+
+Eigen::MatrixXd MESHIO::MeshAttribute::toMatrix() const
+{
+    Eigen::MatrixXd m(rows, components);
+    dispatch(type, [&](auto t) {
+        const auto *v = values<decltype(t)>();
+        for(long i = 0; i < m.size(); i++)
+            m.data()[i] = (double)v[i];
+    });
+    return m;
+}
+
+MESHIO::MeshAttribute MESHIO::MeshAttribute::gather(const std::vector<long> &keep) const
+{
+    MeshAttribute a;
+    a.name = name;
+    a.onPoints = onPoints;
+    a.kind = kind;
+    a.type = type;
+    a.components = components;
+    a.resize((long)keep.size());
+    const size_t bytes = attributeTypeBytes(type);
+    for(int c = 0; c < components; c++)
+        for(long r = 0; r < a.rows; r++)
+            memcpy(&a.data[(c * a.rows + r) * bytes], &data[(c * rows + keep[r]) * bytes], bytes);
+    return a;
+}
+
+int MESHIO::readVTKArray(std::istream &in, const std::string &line, bool onPoints, long rows, MeshAttributes &attributes)
+{
+    std::stringstream ss(line);
+    std::vector<std::string> words;
+    for(std::string w; ss >> w;)
+        words.push_back(w);
+    if(words.empty())
+        return 0;
+    const std::string &keyword = words[0];
+    MeshAttribute a;
+    a.onPoints = onPoints;
+    std::string typeName = "float";
+    if(keyword == "SCALARS" && words.size() >= 3) {
+        // "SCALARS  int 1" is what the writers give when the marker name is empty.
+        const bool unnamed = words.size() == 3 && isdigit((unsigned char)words[2][0]) && vtkType(words[1], a.type);
+        a.name = unnamed ? "" : words[1];
+        typeName = unnamed ? words[1] : words[2];
+        a.components = unnamed ? stoi(words[2]) : words.size() > 3 ? stoi(words[3]) : 1;
+        skipLine(in, "LOOKUP_TABLE");
+    }
+    else if((keyword == "VECTORS" || keyword == "NORMALS") && words.size() >= 3) {
+        a.kind = keyword == "VECTORS" ? AttributeKind::Vectors : AttributeKind::Normals;
+        a.name = words[1];
+        typeName = words[2];
+        a.components = 3;
+    }
+    else if((keyword == "TENSORS" || keyword == "TENSORS6") && words.size() >= 3) {
+        a.kind = AttributeKind::Tensors;
+        a.name = words[1];
+        typeName = words[2];
+        a.components = keyword == "TENSORS" ? 9 : 6;
+    }
+    else if(keyword == "TEXTURE_COORDINATES" && words.size() >= 4) {
+        a.kind = AttributeKind::TextureCoordinates;
+        a.name = words[1];
+        a.components = stoi(words[2]);
+        typeName = words[3];
+    }
+    else if(keyword == "COLOR_SCALARS" && words.size() >= 3) {
+        // Floats in [0, 1] in ASCII files; kept as plain scalars.
+        a.name = words[1];
+        a.components = stoi(words[2]);
+    }
+    else if(keyword == "LOOKUP_TABLE" && words.size() >= 3) {
+        // A table of its own, rgba for every entry: read past it.
+        a.components = 4;
+        return parseAttribute(in, a, stol(words[2])) ? 1 : -1;
+    }
+    else if(keyword == "FIELD" && words.size() >= 3) {
+        const int nArrays = stoi(words[2]);
+        for(int k = 0; k < nArrays; k++) {
+            MeshAttribute field;
+            field.onPoints = onPoints;
+            field.kind = AttributeKind::Field;
+            long tuples = 0;
+            if(!(in >> field.name >> field.components >> tuples >> typeName))
+                return -1;
+            if(!vtkType(typeName, field.type))
+                field.type = AttributeType::Float64;
+            if(!parseAttribute(in, field, tuples))
+                return -1;
+            if(tuples != rows)
+                std::cout << "Skipped field array " << field.name << ", it has " << tuples << " tuples for " << rows << " elements." << std::endl;
+            else
+                attributes.push_back(std::move(field));
+        }
+        return 1;
+    }
+    else {
+        return 0;
+    }
+    if(keyword != "COLOR_SCALARS" && !vtkType(typeName, a.type)) {
+        std::cout << "Unknown VTK data type " << typeName << " of " << a.name << ", read as double." << std::endl;
+        a.type = AttributeType::Float64;
+    }
+    if(keyword == "COLOR_SCALARS")
+        a.type = AttributeType::Float32;
+    if(!parseAttribute(in, a, rows))
+        return -1;
+    attributes.push_back(std::move(a));
+    return 1;
+}
+
+int MESHIO::writeVTKArrays(std::ostream &f, const MeshAttributes &attributes, long nPoints, long nCells, bool cellDataOpen)
+{
+    MESH_TRACE("writeVTKArrays");
+    const std::streamsize precision = f.precision();
+    for(bool onPoints : {false, true}) {
+        const long rows = onPoints ? nPoints : nCells;
+        std::vector<const MeshAttribute *> arrays, fields;
+        for(const MeshAttribute &a : attributes) {
+            if(a.onPoints != onPoints)
+                continue;
+            if(a.rows != rows) {
+                std::cout << "Left out attribute " << a.name << ", it has " << a.rows << " rows for " << rows << " elements." << std::endl;
+                continue;
+            }
+            (a.kind == AttributeKind::Field ? fields : arrays).push_back(&a);
+        }
+        if(arrays.empty() && fields.empty())
+            continue;
+        if(onPoints)
+            f << "POINT_DATA " << nPoints << "\n";
+        else if(!cellDataOpen)
+            f << "CELL_DATA " << nCells << "\n";
+        for(const MeshAttribute *a : arrays) {
+            switch(a->kind) {
+            case AttributeKind::Vectors: f << "VECTORS " << a->name << " " << vtkTypeName(a->type) << "\n"; break;
+            case AttributeKind::Normals: f << "NORMALS " << a->name << " " << vtkTypeName(a->type) << "\n"; break;
+            case AttributeKind::Tensors: f << (a->components == 6 ? "TENSORS6 " : "TENSORS ") << a->name << " " << vtkTypeName(a->type) << "\n"; break;
+            case AttributeKind::TextureCoordinates:
+                f << "TEXTURE_COORDINATES " << a->name << " " << a->components << " " << vtkTypeName(a->type) << "\n";
+                break;
+            default:
+                f << "SCALARS " << a->name << " " << vtkTypeName(a->type) << " " << a->components << "\n";
+                f << "LOOKUP_TABLE default\n";
+            }
+            printAttribute(f, *a);
+        }
+        if(!fields.empty()) {
+            f << "FIELD FieldData " << fields.size() << "\n";
+            for(const MeshAttribute *a : fields) {
+                f << a->name << " " << a->components << " " << a->rows << " " << vtkTypeName(a->type) << "\n";
+                printAttribute(f, *a);
+            }
+        }
+    }
+    f.precision(precision);
+    return f ? 1 : -1;
+}
+
+void MESHIO::gatherCells(MeshAttributes &attributes, const std::vector<long> &cells)
+{
+    for(MeshAttribute &a : attributes)
+        if(!a.onPoints)
+            a = a.gather(cells);
+}
@@ -0,0 +1,68 @@
+#ifndef MESH_ATTRIBUTES_H
+#define MESH_ATTRIBUTES_H
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace MESHIO {
+
+	// Element type of an attribute, as declared in the file.
+	enum class AttributeType : uint8_t { Int8, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64, Float32, Float64 };
+	// What a VTK data array is: SCALARS, VECTORS, NORMALS, TENSORS, TEXTURE_COORDINATES or an array of a FIELD.
+	enum class AttributeKind : uint8_t { Scalars, Vectors, Normals, Tensors, TextureCoordinates, Field };
+
+	size_t attributeTypeBytes(AttributeType type);
+	// VTK name of a type ("unsigned_char", "int", "double", ..) and back, false for an unknown name.
+	const char *vtkTypeName(AttributeType type);
+	bool vtkType(const std::string &name, AttributeType &type);
+
+	/**
+	 * Values attached to every point or every facet: rows tuples of components values of
+	 * one type, in a single buffer of rows * components * attributeTypeBytes(type) bytes.
+	 * The buffer is column-major like Eigen and .mcb, component c of row r at c * rows + r.
+	 */
+	struct MeshAttribute {
+		std::string name;
+		bool onPoints = true;
+		AttributeKind kind = AttributeKind::Scalars;
+		AttributeType type = AttributeType::Float64;
+		int components = 1;
+		long rows = 0;
+		std::vector<unsigned char> data;
+
+		MeshAttribute() = default;
+		// A float64 attribute holding values, one row per point or facet.
+		MeshAttribute(const std::string &name, bool onPoints, const Eigen::MatrixXd &values);
+
+		void resize(long rows);
+		template<class T> T *values() { return reinterpret_cast<T *>(data.data()); }
+		template<class T> const T *values() const { return reinterpret_cast<const T *>(data.data()); }
+		double value(long r, int c) const;
+		Eigen::MatrixXd toMatrix() const;
+		// The given rows in their order, e.g. the cell of every triangle a cell split into.
+		MeshAttribute gather(const std::vector<long> &rows) const;
+	};
+
+	typedef std::vector<MeshAttribute> MeshAttributes;
+
+	/**
+	 * Parse the array that the VTK line starts (SCALARS, VECTORS, NORMALS, TENSORS,
+	 * TEXTURE_COORDINATES, COLOR_SCALARS, FIELD), the values following on in.
+	 * @return 1 when the arrays were read, 0 when line starts none, -1 on truncated values
+	 */
+	int readVTKArray(std::istream &in, const std::string &line, bool onPoints, long rows, MeshAttributes &attributes);
+	/**
+	 * Write the attributes as CELL_DATA and POINT_DATA sections. cellDataOpen tells that the
+	 * markers already opened CELL_DATA. Attributes whose row count no longer matches the
+	 * mesh, after an operation, are left out.
+	 */
+	int writeVTKArrays(std::ostream &f, const MeshAttributes &attributes, long nPoints, long nCells, bool cellDataOpen);
+	// Keep the cell attributes of the given cells (see triangulate), point attributes are kept as they are.
+	void gatherCells(MeshAttributes &attributes, const std::vector<long> &cells);
+};
+
+#endif
@@ -0,0 +1,580 @@
+#include "MeshBVH.h"
+#include "MeshConvert.h"
+#include "MeshTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+using namespace std;
+
+namespace {
+
+const int BINS = 16;
+const int MAX_LEAF = 64;            // a node past this is split even when the SAH prefers a leaf
+const long PARALLEL_NODE = 1 << 16; // nodes of more facets bin them in parallel
+const int NODE_BLOCKS = 64;
+const double INF = numeric_limits<double>::infinity();
+
+struct Box {
+    double lo[3] = {INF, INF, INF};
+    double hi[3] = {-INF, -INF, -INF};
+
+    void grow(const double *p, const double *q) {
+        for(int k = 0; k < 3; k++) {
+            lo[k] = min(lo[k], p[k]);
+            hi[k] = max(hi[k], q[k]);
+        }
+    }
+    void grow(const Box &b) { grow(b.lo, b.hi); }
+    double area() const {
+        if(lo[0] > hi[0])
+            return 0.0;
+        const double dx = hi[0] - lo[0], dy = hi[1] - lo[1], dz = hi[2] - lo[2];
+        return 2.0 * (dx * dy + dy * dz + dz * dx);
+    }
+};
+
+struct Bin {
+    Box box;
+    long count = 0;
+};
+
+// Float bounds that contain the double ones.
+float roundDown(double v)
+{
+    float f = (float)v;
+    return (double)f > v ? nextafterf(f, -numeric_limits<float>::infinity()) : f;
+}
+
+float roundUp(double v)
+{
+    float f = (float)v;
+    return (double)f < v ? nextafterf(f, numeric_limits<float>::infinity()) : f;
+}
+
+struct Task {
+    uint32_t node;
+    long begin, end;
+    long mid = -1;    // split position, -1 for a leaf
+};
+
+class Builder {
+public:
+    Builder(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, MESHIO::FacetBVH &bvh, int leafSize)
+        : bvh(bvh), leafSize(max(1, leafSize)), box(F.rows() * 6)
+    {
+#pragma omp parallel for schedule(static)
+        for(long f = 0; f < F.rows(); f++) {
+            double *b = &box[f * 6];
+            for(int k = 0; k < 3; k++) {
+                b[k] = min(V(F(f, 0), k), min(V(F(f, 1), k), V(F(f, 2), k)));
+                b[k + 3] = max(V(F(f, 0), k), max(V(F(f, 1), k), V(F(f, 2), k)));
+            }
+        }
+    }
+
+    double centroid(int f, int k) const { return 0.5 * (box[f * 6 + k] + box[f * 6 + k + 3]); }
+
+    // Bounds and centroid bounds of a range, over blocks in parallel for a large range.
+    void bounds(long begin, long end, Box &bounds, Box &centroids) const {
+        const long n = end - begin;
+        const int blocks = n > PARALLEL_NODE ? NODE_BLOCKS : 1;
+        vector<Box> partial(blocks * 2);
+#pragma omp parallel for schedule(static) if(blocks > 1)
+        for(int b = 0; b < blocks; b++) {
+            for(long i = begin + n * b / blocks; i < begin + n * (b + 1) / blocks; i++) {
+                const int f = bvh.order[i];
+                partial[b * 2].grow(&box[f * 6], &box[f * 6 + 3]);
+                double c[3] = {centroid(f, 0), centroid(f, 1), centroid(f, 2)};
+                partial[b * 2 + 1].grow(c, c);
+            }
+        }
+        for(int b = 0; b < blocks; b++) {
+            bounds.grow(partial[b * 2]);
+            centroids.grow(partial[b * 2 + 1]);
+        }
+    }
+
+    static int binOf(double c, double lo, double scale) {
+        return min(BINS - 1, max(0, (int)((c - lo) * scale)));
+    }
+
+    // Split the range of a task, or leave it a leaf.
+    void split(Task &task) {
+        const long n = task.end - task.begin;
+        Box nodeBox, centroidBox;
+        bounds(task.begin, task.end, nodeBox, centroidBox);
+        MESHIO::BVHNode &node = bvh.nodes[task.node];
+        for(int k = 0; k < 3; k++) {
+            node.lo[k] = roundDown(nodeBox.lo[k]);
+            node.hi[k] = roundUp(nodeBox.hi[k]);
+        }
+        if(n <= leafSize)
+            return;
+
+        double scale[3];
+        for(int k = 0; k < 3; k++) {
+            const double extent = centroidBox.hi[k] - centroidBox.lo[k];
+            scale[k] = extent > 0 ? BINS / extent : 0.0;
+        }
+        const int blocks = n > PARALLEL_NODE ? NODE_BLOCKS : 1;
+        vector<Bin> partial(blocks * 3 * BINS);
+#pragma omp parallel for schedule(static) if(blocks > 1)
+        for(int b = 0; b < blocks; b++) {
+            Bin *bins = &partial[b * 3 * BINS];
+            for(long i = task.begin + n * b / blocks; i < task.begin + n * (b + 1) / blocks; i++) {
+                const int f = bvh.order[i];
+                for(int k = 0; k < 3; k++) {
+                    Bin &bin = bins[k * BINS + binOf(centroid(f, k), centroidBox.lo[k], scale[k])];
+                    bin.box.grow(&box[f * 6], &box[f * 6 + 3]);
+                    bin.count++;
+                }
+            }
+        }
+        Bin bins[3 * BINS];
+        for(int b = 0; b < blocks; b++)
+            for(int j = 0; j < 3 * BINS; j++) {
+                bins[j].box.grow(partial[b * 3 * BINS + j].box);
+                bins[j].count += partial[b * 3 * BINS + j].count;
+            }
+
+        // Cost of a split relative to intersecting every facet of the node: 1 + (Al Nl + Ar Nr) / A.
+        double bestCost = INF;
+        int bestAxis = -1, bestBin = 0;
+        const double area = nodeBox.area();
+        for(int k = 0; k < 3; k++) {
+            if(scale[k] == 0.0)
+                continue;
+            const Bin *axisBins = &bins[k * BINS];
+            double rightArea[BINS];
+            long rightCount[BINS];
+            Box right;
+            long count = 0;
+            for(int j = BINS - 1; j > 0; j--) {
+                right.grow(axisBins[j].box);
+                count += axisBins[j].count;
+                rightArea[j] = right.area();
+                rightCount[j] = count;
+            }
+            Box left;
+            count = 0;
+            for(int j = 0; j + 1 < BINS; j++) {
+                left.grow(axisBins[j].box);
+                count += axisBins[j].count;
+                if(count == 0 || rightCount[j + 1] == 0)
+                    continue;
+                const double cost = 1.0 + (left.area() * count + rightArea[j + 1] * rightCount[j + 1]) / max(area, 1e-300);
+                if(cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = k;
+                    bestBin = j;
+                }
+            }
+        }
+        if(bestAxis < 0 || bestCost >= n) {
+            if(n <= MAX_LEAF)
+                return;
+            if(bestAxis < 0) {
+                // Every centroid at the same place: halve the range.
+                task.mid = task.begin + n / 2;
+                return;
+            }
+        }
+        const double lo = centroidBox.lo[bestAxis], s = scale[bestAxis];
+        auto midIt = std::partition(bvh.order.begin() + task.begin, bvh.order.begin() + task.end, [&](int f) {
+            return binOf(centroid(f, bestAxis), lo, s) <= bestBin;
+        });
+        task.mid = midIt - bvh.order.begin();
+    }
+
+    void build() {
+        vector<Task> level = {Task{0, 0, (long)bvh.order.size()}};
+        bvh.nodes.resize(1);
+        while(!level.empty()) {
+            bvh.depth++;
+            // Large nodes one after the other, outside a parallel region, so that their
+            // binning loops get the threads; the other nodes of the level side by side.
+            for(Task &task : level)
+                if(task.end - task.begin > PARALLEL_NODE)
+                    split(task);
+#pragma omp parallel for schedule(dynamic, 1)
+            for(long i = 0; i < (long)level.size(); i++)
+                if(level[i].end - level[i].begin <= PARALLEL_NODE)
+                    split(level[i]);
+            // Children are numbered in level order, so the tree is the same for any thread count.
+            vector<Task> next;
+            for(const Task &task : level) {
+                MESHIO::BVHNode &node = bvh.nodes[task.node];
+                if(task.mid < 0) {
+                    node.index = (uint32_t)task.begin;
+                    node.count = (uint32_t)(task.end - task.begin);
+                    continue;
+                }
+                const uint32_t child = (uint32_t)bvh.nodes.size();
+                node.index = child;
+                node.count = 0;
+                // node is not used past the resize, which may move the nodes.
+                bvh.nodes.resize(bvh.nodes.size() + 2);
+                next.push_back(Task{child, task.begin, task.mid});
+                next.push_back(Task{child + 1, task.mid, task.end});
+            }
+            level.swap(next);
+        }
+    }
+
+private:
+    MESHIO::FacetBVH &bvh;
+    const int leafSize;
+    vector<double> box;   // lo xyz, hi xyz of every facet
+};
+
+double boxDistance2(const MESHIO::BVHNode &node, const Eigen::Vector3d &p)
+{
+    double d2 = 0.0;
+    for(int k = 0; k < 3; k++) {
+        const double d = max(max((double)node.lo[k] - p[k], p[k] - (double)node.hi[k]), 0.0);
+        d2 += d * d;
+    }
+    return d2;
+}
+
+// Closest point of triangle abc to p, by the Voronoi regions of its corners and edges.
+Eigen::Vector3d closestOnTriangle(const Eigen::Vector3d &p, const Eigen::Vector3d &a, const Eigen::Vector3d &b, const Eigen::Vector3d &c)
+{
+    const Eigen::Vector3d ab = b - a, ac = c - a, ap = p - a;
+    const double d1 = ab.dot(ap), d2 = ac.dot(ap);
+    if(d1 <= 0 && d2 <= 0)
+        return a;
+    const Eigen::Vector3d bp = p - b;
+    const double d3 = ab.dot(bp), d4 = ac.dot(bp);
+    if(d3 >= 0 && d4 <= d3)
+        return b;
+    const double vc = d1 * d4 - d3 * d2;
+    if(vc <= 0 && d1 >= 0 && d3 <= 0)
+        return a + ab * (d1 / (d1 - d3));
+    const Eigen::Vector3d cp = p - c;
+    const double d5 = ab.dot(cp), d6 = ac.dot(cp);
+    if(d6 >= 0 && d5 <= d6)
+        return c;
+    const double vb = d5 * d2 - d1 * d6;
+    if(vb <= 0 && d2 >= 0 && d6 <= 0)
+        return a + ac * (d2 / (d2 - d6));
+    const double va = d3 * d6 - d5 * d4;
+    if(va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    const double denom = 1.0 / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+// Entry distance of the ray into the node, infinity when it misses or enters past tMax.
+double rayBox(const MESHIO::BVHNode &node, const Eigen::Vector3d &o, const Eigen::Vector3d &inv, double tMax)
+{
+    double t0 = 0.0, t1 = tMax;
+    for(int k = 0; k < 3; k++) {
+        double a = ((double)node.lo[k] - o[k]) * inv[k];
+        double b = ((double)node.hi[k] - o[k]) * inv[k];
+        if(a > b)
+            swap(a, b);
+        // NaN from 0 * inf (ray in the slab plane) leaves the interval as it is.
+        if(a > t0)
+            t0 = a;
+        if(b < t1)
+            t1 = b;
+        if(t0 > t1)
+            return INF;
+    }
+    return t0;
+}
+
+// Möller-Trumbore, t of the hit or infinity.
+double rayTriangle(const Eigen::Vector3d &o, const Eigen::Vector3d &d, const Eigen::Vector3d &a, const Eigen::Vector3d &b, const Eigen::Vector3d &c)
+{
+    const Eigen::Vector3d e1 = b - a, e2 = c - a;
+    const Eigen::Vector3d p = d.cross(e2);
+    const double det = e1.dot(p);
+    if(det == 0.0)
+        return INF;
+    const double inv = 1.0 / det;
+    const Eigen::Vector3d s = o - a;
+    const double u = s.dot(p) * inv;
+    if(u < 0.0 || u > 1.0)
+        return INF;
+    const Eigen::Vector3d q = s.cross(e1);
+    const double v = d.dot(q) * inv;
+    if(v < 0.0 || u + v > 1.0)
+        return INF;
+    const double t = e2.dot(q) * inv;
+    return t >= 0.0 ? t : INF;
+}
+
+}
+
+long MESHIO::FacetBVH::nLeaves() const
+{
+    long n = 0;
+    for(const BVHNode &node : nodes)
+        n += node.isLeaf();
+    return n;
+}
+
+int MESHIO::buildBVH(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, FacetBVH &bvh, int leafSize)
+{
+    MESH_TRACE("buildBVH");
+    bvh = FacetBVH();
+    if(F.cols() != 3) {
+        std::cout << "The BVH needs triangles." << std::endl;
+        return -1;
+    }
+    if(F.rows() == 0)
+        return 1;
+    bvh.order.resize(F.rows());
+    iota(bvh.order.begin(), bvh.order.end(), 0);
+    Builder builder(V, F, bvh, leafSize);
+    builder.build();
+    return 1;
+}
+
+int MESHIO::closestPoints(const FacetBVH &bvh, const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::MatrixXd &P,
+                          Eigen::MatrixXd &C, Eigen::VectorXi &facet, Eigen::VectorXd &distance)
+{
+    MESH_TRACE("closestPoints");
+    const long nP = P.rows();
+    C.resize(nP, 3);
+    facet.setConstant(nP, -1);
+    distance.setConstant(nP, INF);
+    if(bvh.nodes.empty())
+        return 1;
+#pragma omp parallel
+    {
+        vector<uint32_t> stack;
+#pragma omp for schedule(dynamic, 256)
+        for(long i = 0; i < nP; i++) {
+            const Eigen::Vector3d p = P.row(i).transpose();
+            double best = INF;
+            Eigen::Vector3d bestPoint = p;
+            int bestFacet = -1;
+            stack.assign(1, 0);
+            while(!stack.empty()) {
+                const BVHNode &node = bvh.nodes[stack.back()];
+                stack.pop_back();
+                if(boxDistance2(node, p) >= best)
+                    continue;
+                if(node.isLeaf()) {
+                    for(uint32_t j = node.index; j < node.index + node.count; j++) {
+                        const int f = bvh.order[j];
+                        const Eigen::Vector3d q = closestOnTriangle(p, V.row(F(f, 0)).transpose(), V.row(F(f, 1)).transpose(), V.row(F(f, 2)).transpose());
+                        const double d2 = (q - p).squaredNorm();
+                        if(d2 < best) {
+                            best = d2;
+                            bestPoint = q;
+                            bestFacet = f;
+                        }
+                    }
+                    continue;
+                }
+                // Nearer child on top of the stack.
+                const double d0 = boxDistance2(bvh.nodes[node.index], p);
+                const double d1 = boxDistance2(bvh.nodes[node.index + 1], p);
+                const uint32_t nearChild = d0 <= d1 ? node.index : node.index + 1;
+                const double nearD = min(d0, d1), farD = max(d0, d1);
+                if(farD < best)
+                    stack.push_back(nearChild == node.index ? node.index + 1 : node.index);
+                if(nearD < best)
+                    stack.push_back(nearChild);
+            }
+            C.row(i) = bestPoint.transpose();
+            facet(i) = bestFacet;
+            distance(i) = sqrt(best);
+        }
+    }
+    return 1;
+}
+
+int MESHIO::intersectRays(const FacetBVH &bvh, const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::MatrixXd &origins,
+                          const Eigen::MatrixXd &directions, Eigen::VectorXd &t, Eigen::VectorXi &facet)
+{
+    MESH_TRACE("intersectRays");
+    const long nR = origins.rows();
+    if(directions.rows() != nR) {
+        std::cout << "Every ray needs an origin and a direction." << std::endl;
+        return -1;
+    }
+    t.setConstant(nR, INF);
+    facet.setConstant(nR, -1);
+    if(bvh.nodes.empty())
+        return 1;
+#pragma omp parallel
+    {
+        vector<uint32_t> stack;
+#pragma omp for schedule(dynamic, 256)
+        for(long i = 0; i < nR; i++) {
+            const Eigen::Vector3d o = origins.row(i).transpose();
+            const Eigen::Vector3d d = directions.row(i).transpose();
+            const Eigen::Vector3d inv(1.0 / d[0], 1.0 / d[1], 1.0 / d[2]);
+            double best = INF;
+            int bestFacet = -1;
+            stack.assign(1, 0);
+            while(!stack.empty()) {
+                const BVHNode &node = bvh.nodes[stack.back()];
+                stack.pop_back();
+                if(rayBox(node, o, inv, best) == INF)
+                    continue;
+                if(node.isLeaf()) {
+                    for(uint32_t j = node.index; j < node.index + node.count; j++) {
+                        const int f = bvh.order[j];
+                        const double hit = rayTriangle(o, d, V.row(F(f, 0)).transpose(), V.row(F(f, 1)).transpose(), V.row(F(f, 2)).transpose());
+                        if(hit < best) {
+                            best = hit;
+                            bestFacet = f;
+                        }
+                    }
+                    continue;
+                }
+                const double t0 = rayBox(bvh.nodes[node.index], o, inv, best);
+                const double t1 = rayBox(bvh.nodes[node.index + 1], o, inv, best);
+                const uint32_t nearChild = t0 <= t1 ? node.index : node.index + 1;
+                if(max(t0, t1) != INF)
+                    stack.push_back(nearChild == node.index ? node.index + 1 : node.index);
+                if(min(t0, t1) != INF)
+                    stack.push_back(nearChild);
+            }
+            t(i) = best;
+            facet(i) = bestFacet;
+        }
+    }
+    return 1;
+}
+
+int MESHIO::checkBVH(const FacetBVH &bvh, const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::MatrixXd &P,
+                     const Eigen::MatrixXd &origins, const Eigen::MatrixXd &directions)
+{
+    MESH_TRACE("checkBVH");
+    const long nF = F.rows();
+    long errors = 0;
+    auto report = [&errors](const std::string &message) {
+        if(errors++ < 10)
+            std::cout << "BVH check - " << message << std::endl;
+    };
+
+    // Walk the tree from the root: every facet once, inside the bounds of its leaf.
+    std::vector<int> seen(nF, 0);
+    if(!bvh.nodes.empty()) {
+        std::vector<uint32_t> stack(1, 0);
+        while(!stack.empty()) {
+            const uint32_t n = stack.back();
+            stack.pop_back();
+            if(n >= bvh.nodes.size()) {
+                report("node " + std::to_string(n) + " past the end");
+                continue;
+            }
+            const BVHNode &node = bvh.nodes[n];
+            if(!node.isLeaf()) {
+                stack.push_back(node.index);
+                stack.push_back(node.index + 1);
+                continue;
+            }
+            for(uint32_t j = node.index; j < node.index + node.count && j < bvh.order.size(); j++) {
+                const int f = bvh.order[j];
+                seen[f]++;
+                for(int c = 0; c < 3; c++)
+                    for(int k = 0; k < 3; k++)
+                        if(V(F(f, c), k) < node.lo[k] || V(F(f, c), k) > node.hi[k])
+                            report("facet " + std::to_string(f) + " outside its leaf " + std::to_string(n));
+            }
+        }
+    }
+    for(long f = 0; f < nF; f++)
+        if(seen[f] != 1)
+            report("facet " + std::to_string(f) + " in " + std::to_string(seen[f]) + " leaves");
+
+    // One leaf of every facet gives the brute force answers.
+    FacetBVH flat;
+    if(nF > 0) {
+        flat.order = bvh.order;
+        flat.nodes.resize(1);
+        BVHNode &root = flat.nodes[0];
+        for(int k = 0; k < 3; k++) {
+            root.lo[k] = -std::numeric_limits<float>::infinity();
+            root.hi[k] = std::numeric_limits<float>::infinity();
+        }
+        root.index = 0;
+        root.count = (uint32_t)nF;
+    }
+    Eigen::MatrixXd C, bruteC;
+    Eigen::VectorXi facet, bruteFacet;
+    Eigen::VectorXd distance, bruteDistance, t, bruteT;
+    closestPoints(bvh, V, F, P, C, facet, distance);
+    closestPoints(flat, V, F, P, bruteC, bruteFacet, bruteDistance);
+    for(long i = 0; i < P.rows(); i++)
+        if(!(std::abs(distance(i) - bruteDistance(i)) <= 1e-12 * (1.0 + bruteDistance(i))))
+            report("closest point " + std::to_string(i) + " at " + std::to_string(distance(i)) + " instead of " + std::to_string(bruteDistance(i)));
+    if(intersectRays(bvh, V, F, origins, directions, t, facet) < 0 || intersectRays(flat, V, F, origins, directions, bruteT, bruteFacet) < 0)
+        return -1;
+    for(long i = 0; i < origins.rows(); i++)
+        if(t(i) != bruteT(i) && !(std::abs(t(i) - bruteT(i)) <= 1e-12 * (1.0 + bruteT(i))))
+            report("ray " + std::to_string(i) + " hits at " + std::to_string(t(i)) + " instead of " + std::to_string(bruteT(i)));
+    if(errors > 0)
+        std::cout << "BVH check failed, " << errors << " mismatches." << std::endl;
+    return errors == 0 ? 1 : -1;
+}
+
+int MESHIO::projectPoints(const std::string &meshFile, const std::string &pointsFile, const std::string &outputFile, bool check)
+{
+    Eigen::MatrixXd V;
+    Eigen::MatrixXi F, M;
+    if(MESHIO::readMesh(meshFile, V, F, M) < 0)
+        return -1;
+
+    std::ifstream in(pointsFile);
+    if(!in.is_open()) {
+        std::cout << "No such file. - " << pointsFile << std::endl;
+        return -1;
+    }
+    std::vector<double> values;
+    std::string line;
+    while(getline(in, line)) {
+        double x, y, z;
+        if(line.empty() || line[0] == '#' || sscanf(line.c_str(), "%lf %lf %lf", &x, &y, &z) != 3)
+            continue;
+        values.push_back(x); values.push_back(y); values.push_back(z);
+    }
+    Eigen::MatrixXd P = Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>>(values.data(), values.size() / 3, 3);
+    std::cout << "Number of query points : " << P.rows() << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    FacetBVH bvh;
+    if(buildBVH(V, F, bvh) < 0)
+        return -1;
+    const double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "BVH : " << bvh.nodes.size() << " nodes, " << bvh.nLeaves() << " leaves, depth " << bvh.depth
+              << ", built in " << buildSeconds << " s" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    Eigen::MatrixXd C;
+    Eigen::VectorXi facet;
+    Eigen::VectorXd distance;
+    closestPoints(bvh, V, F, P, C, facet, distance);
+    const double querySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Projected " << P.rows() << " points in " << querySeconds << " s ("
+              << (querySeconds > 0 ? P.rows() / querySeconds : 0.0) << " points/s)" << std::endl;
+    // The rays of the check go from the points to their closest points.
+    if(check && checkBVH(bvh, V, F, P, P, C - P) < 0)
+        return -1;
+
+    std::ofstream out(outputFile);
+    if(!out.is_open()) {
+        std::cout << "Write file failed. - " << outputFile << std::endl;
+        return -1;
+    }
+    std::cout << "Writing points to - " << outputFile << std::endl;
+    out.precision(std::numeric_limits<double>::digits10 + 1);
+    for(long i = 0; i < C.rows(); i++)
+        out << C(i, 0) << " " << C(i, 1) << " " << C(i, 2) << " " << facet(i) << " " << distance(i) << "\n";
+    return out ? 1 : -1;
+}
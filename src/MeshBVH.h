@@ -0,0 +1,81 @@
+#ifndef MESH_BVH_H
+#define MESH_BVH_H
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MESHIO {
+
+	/**
+	 * Node of a FacetBVH, 32 bytes so two siblings share a cache line. The bounds are
+	 * floats rounded outwards, so they always contain their facets. An inner node has
+	 * count 0 and its children at index and index + 1; a leaf holds the facets
+	 * order[index] .. order[index + count - 1].
+	 */
+	struct BVHNode {
+		float lo[3];
+		float hi[3];
+		uint32_t index;
+		uint32_t count;
+
+		bool isLeaf() const { return count > 0; }
+	};
+	static_assert(sizeof(BVHNode) == 32, "BVHNode is meant to be 32 bytes");
+
+	/**
+	 * Bounding volume hierarchy over the triangles of a mesh, node 0 being the root. It
+	 * holds no reference to the mesh: queries take the V and F it was built from.
+	 */
+	struct FacetBVH {
+		std::vector<BVHNode> nodes;
+		std::vector<int> order;      // facets in leaf order
+		int depth = 0;
+
+		long nLeaves() const;
+	};
+
+	/**
+	 * Top-down build, splitting every node at the best of 16 bins per axis by the surface
+	 * area heuristic. The nodes of a level are split in parallel, the large nodes of the
+	 * first levels bin their facets in parallel.
+	 * @param leafSize facets under which a node is not split.
+	 * @return 1/-1
+	 */
+	int buildBVH(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, FacetBVH &bvh, int leafSize = 4);
+
+	/**
+	 * Closest point of the mesh to every row of P, in parallel. C gets the points, facet
+	 * their facet and distance their distance; -1 and infinity for an empty mesh.
+	 * @return 1/-1
+	 */
+	int closestPoints(const FacetBVH &bvh, const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::MatrixXd &P,
+	                  Eigen::MatrixXd &C, Eigen::VectorXi &facet, Eigen::VectorXd &distance);
+	/**
+	 * First hit of every ray origin + t direction, t >= 0, in parallel. Misses get facet -1
+	 * and t infinity.
+	 * @return 1/-1
+	 */
+	int intersectRays(const FacetBVH &bvh, const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::MatrixXd &origins,
+	                  const Eigen::MatrixXd &directions, Eigen::VectorXd &t, Eigen::VectorXi &facet);
+
+	/**
+	 * Check the tree and the queries against brute force: every facet in exactly one leaf,
+	 * every node containing its facets, and closestPoints and intersectRays giving the
+	 * distances and hits of a test of every facet, for the points P and the rays.
+	 * @return 1 when all agree, -1 with the first mismatches printed
+	 */
+	int checkBVH(const FacetBVH &bvh, const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::MatrixXd &P,
+	             const Eigen::MatrixXd &origins, const Eigen::MatrixXd &directions);
+
+	/**
+	 * Project the points listed in pointsFile (x y z per line) onto the mesh of meshFile and
+	 * write x y z facet distance per line to outputFile, with the build and query times.
+	 * check also runs checkBVH on the points.
+	 * @return 1/-1
+	 */
+	int projectPoints(const std::string &meshFile, const std::string &pointsFile, const std::string &outputFile, bool check = false);
+};
+
+#endif
@@ -0,0 +1,240 @@
+#include "MeshBatch.h"
+#include "ThreadPool.h"
+#include "MiniJson.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Rough peak memory of an in-memory conversion per byte of ASCII input.
+#define MEMORY_PER_INPUT_BYTE 4
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct BatchEntry {
+    std::string input;
+    uintmax_t fileSize = 0;
+    std::string status = "pending";
+    std::string message;
+    double waitSeconds = 0.0;
+    double totalSeconds = 0.0;
+    MESHIO::ConvertReport report;
+};
+
+/**
+ * Admission control: a job may start once its estimated memory fits in the budget next to
+ * the running ones. A job larger than the whole budget still runs, alone.
+ */
+class MemoryGate {
+public:
+    explicit MemoryGate(double budget) : budget(budget) {}
+    void acquire(double bytes) {
+        std::unique_lock<std::mutex> guard(lock);
+        released.wait(guard, [&] { return budget <= 0.0 || running == 0 || used + bytes <= budget; });
+        used += bytes;
+        running++;
+    }
+    void release(double bytes) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            used -= bytes;
+            running--;
+        }
+        released.notify_all();
+    }
+private:
+    std::mutex lock;
+    std::condition_variable released;
+    double budget;
+    double used = 0.0;
+    int running = 0;
+};
+
+bool isMeshFile(const fs::path &path)
+{
+    std::string ext = path.extension().string();
+    return ext == ".vtk" || ext == ".mesh" || ext == ".pls" || ext == ".obj" || ext == ".mcb";
+}
+
+// What the converter writes next to an input: <base>.o.<format>, <base>.boundary.vtk, <base>.eps.vtk.
+bool isConverterOutput(const fs::path &path)
+{
+    std::string suffix = path.stem().extension().string();
+    return suffix == ".o" || suffix == ".boundary" || suffix == ".eps";
+}
+
+}
+
+/**
+ * Inputs of a batch: the mesh files of a directory (outputs of an earlier run, *.o.*,
+ * *.boundary.vtk and *.eps.vtk, are skipped) or the lines of a manifest.
+ */
+std::vector<std::string> MESHIO::listBatchInputs(const std::string &source)
+{
+    std::vector<std::string> inputs;
+    std::error_code ec;
+    if(fs::is_directory(source, ec)) {
+        for(const auto &entry : fs::directory_iterator(source, ec)) {
+            const fs::path &path = entry.path();
+            if(entry.is_regular_file() && isMeshFile(path) && !isConverterOutput(path))
+                inputs.push_back(path.string());
+        }
+        std::sort(inputs.begin(), inputs.end());
+        return inputs;
+    }
+    std::ifstream manifest(source);
+    if(!manifest.is_open()) {
+        std::cout << "No such file. - " << source << std::endl;
+        return inputs;
+    }
+    std::string line;
+    while(getline(manifest, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if(first == std::string::npos || line[first] == '#')
+            continue;
+        size_t last = line.find_last_not_of(" \t\r");
+        inputs.push_back(line.substr(first, last - first + 1));
+    }
+    return inputs;
+}
+
+/**
+ * Convert every input of the batch with the same options on a work-stealing pool.
+ * Largest files are scheduled first, each job waits for its estimated memory to fit in
+ * the budget, and a JSON summary with the status and timings of every file is written,
+ * to the standard output when there is no report file, all other messages then going to stderr.
+ * @param batch
+ * @param base conversion options, the input is replaced per file.
+ * @return 1 if every file converted, -1 otherwise.
+ */
+int MESHIO::runBatch(const BatchOptions &batch, const ConvertOptions &base)
+{
+    std::vector<std::string> inputs = listBatchInputs(batch.source);
+    std::vector<BatchEntry> entries(inputs.size());
+    for(size_t i = 0; i < inputs.size(); i++) {
+        std::error_code ec;
+        entries[i].input = inputs[i];
+        entries[i].fileSize = fs::file_size(inputs[i], ec);
+        if(ec)
+            entries[i].fileSize = 0;
+    }
+    // a.vtk and a.obj would both write a.o.*: only the first of them is converted.
+    std::map<std::string, std::string> bases;
+    for(BatchEntry &entry : entries) {
+        ConvertOptions opt = base;
+        opt.input = entry.input;
+        auto inserted = bases.emplace(opt.outputBase(), entry.input);
+        if(!inserted.second) {
+            entry.status = "failed";
+            entry.message = "Outputs would overwrite those of " + inserted.first->second;
+        }
+    }
+    std::vector<size_t> order(entries.size());
+    for(size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return entries[a].fileSize > entries[b].fileSize; });
+
+    auto batchStart = std::chrono::steady_clock::now();
+    ThreadPool pool(batch.jobs);
+    MemoryGate gate(batch.memoryBudgetMB * 1024.0 * 1024.0);
+    // Without --batch-report the summary is the standard output, so the progress of the jobs goes to stderr.
+    std::streambuf *stdoutBuffer = batch.report.empty() ? std::cout.rdbuf(std::cerr.rdbuf()) : nullptr;
+    std::cout << "Converting " << entries.size() << " files on " << pool.size() << " threads." << std::endl;
+
+    for(size_t index : order) {
+        if(entries[index].status != "pending")
+            continue;
+        pool.submit([&, index] {
+            BatchEntry &entry = entries[index];
+            const double estimate = (double)entry.fileSize * MEMORY_PER_INPUT_BYTE;
+            auto queued = std::chrono::steady_clock::now();
+            gate.acquire(estimate);
+            auto start = std::chrono::steady_clock::now();
+            entry.waitSeconds = std::chrono::duration<double>(start - queued).count();
+#ifdef _OPENMP
+            // The pool already keeps the cores busy.
+            if(pool.size() > 1)
+                omp_set_num_threads(1);
+#endif
+            ConvertOptions opt = base;
+            opt.input = entry.input;
+            try {
+                int result = MESHIO::convertMesh(opt, &entry.report);
+                entry.status = result > 0 ? "ok" : "failed";
+            } catch(const std::exception &e) {
+                entry.status = "failed";
+                entry.message = e.what();
+            }
+            entry.totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            gate.release(estimate);
+        });
+    }
+    pool.wait();
+    if(stdoutBuffer)
+        std::cout.rdbuf(stdoutBuffer);
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStart).count();
+
+    int nFailed = 0, nHits = 0, nMisses = 0;
+    std::stringstream json;
+    json << "{\n  \"source\": " << jsonString(batch.source) << ",\n";
+    json << "  \"threads\": " << pool.size() << ",\n";
+    json << "  \"wall_seconds\": " << wallSeconds << ",\n";
+    json << "  \"files\": [";
+    for(size_t i = 0; i < entries.size(); i++) {
+        const BatchEntry &e = entries[i];
+        if(e.status != "ok")
+            nFailed++;
+        json << (i ? "," : "") << "\n    {\"input\": " << jsonString(e.input);
+        json << ", \"status\": " << jsonString(e.status);
+        if(!e.message.empty())
+            json << ", \"message\": " << jsonString(e.message);
+        json << ", \"bytes\": " << e.fileSize;
+        json << ", \"points\": " << e.report.nPoints << ", \"facets\": " << e.report.nFacets;
+        json << ", \"wait_seconds\": " << e.waitSeconds;
+        json << ", \"read_seconds\": " << e.report.readSeconds;
+        json << ", \"operation_seconds\": " << e.report.operationSeconds;
+        json << ", \"write_seconds\": " << e.report.writeSeconds;
+        json << ", \"total_seconds\": " << e.totalSeconds;
+        if(!e.report.cache.empty())
+            json << ", \"cache\": " << jsonString(e.report.cache);
+        nHits += e.report.cache == "hit";
+        nMisses += e.report.cache == "miss";
+        json << ", \"outputs\": [";
+        for(size_t k = 0; k < e.report.outputs.size(); k++)
+            json << (k ? ", " : "") << jsonString(e.report.outputs[k]);
+        json << "]}";
+    }
+    json << "\n  ],\n";
+    if(!base.cacheDir.empty())
+        json << "  \"cache_hits\": " << nHits << ",\n  \"cache_misses\": " << nMisses << ",\n";
+    json << "  \"succeeded\": " << entries.size() - nFailed << ",\n";
+    json << "  \"failed\": " << nFailed << "\n}\n";
+
+    if(batch.report.empty()) {
+        std::cout << json.str();
+    }
+    else {
+        std::ofstream f(batch.report);
+        if(!f.is_open()) {
+            std::cout << "Write batch report failed. - " << batch.report << std::endl;
+            return -1;
+        }
+        f << json.str();
+        std::cout << "Batch report written to - " << batch.report << std::endl;
+    }
+    (stdoutBuffer ? std::cerr : std::cout) << entries.size() - nFailed << " converted, " << nFailed << " failed." << std::endl;
+    return nFailed == 0 ? 1 : -1;
+}
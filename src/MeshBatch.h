@@ -0,0 +1,26 @@
+#ifndef MESH_BATCH_H
+#define MESH_BATCH_H
+
+#include "MeshConvert.h"
+
+#include <string>
+#include <vector>
+
+namespace MESHIO {
+
+	/**
+	 * Many conversions in one process. The source is either a directory, whose mesh files
+	 * are all converted, or a manifest listing one input file per line ('#' starts a comment).
+	 */
+	struct BatchOptions {
+		std::string source;
+		int jobs = 0;                   // worker threads, 0 for one per core
+		double memoryBudgetMB = 0.0;    // estimated memory of the running jobs, 0 for no limit
+		std::string report;             // JSON summary file, empty for standard output
+	};
+
+	std::vector<std::string> listBatchInputs(const std::string &source);
+	int runBatch(const BatchOptions &batch, const ConvertOptions &base);
+};
+
+#endif
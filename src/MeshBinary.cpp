@@ -0,0 +1,489 @@
+#include "MeshBinary.h"
+#include "MeshTrace.h"
+
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MCB_MAGIC "MCBMESH1"
+#define MCB_BYTE_ORDER 0x01020304u
+#define MCB_VERSION 2         // 2 added McbArray::kind, 1 is still read
+#define MCB_ALIGN 64
+
+using namespace std;
+
+namespace {
+
+size_t typeBytes(uint32_t type)
+{
+    return type == MESHIO::McbInt32 || type == MESHIO::McbFloat32 ? 4 : type == MESHIO::McbFloat64 || type == MESHIO::McbInt64 ? 8 : 0;
+}
+
+template<class T> uint32_t mcbType();
+template<> uint32_t mcbType<double>() { return MESHIO::McbFloat64; }
+template<> uint32_t mcbType<float>() { return MESHIO::McbFloat32; }
+template<> uint32_t mcbType<int>() { return MESHIO::McbInt32; }
+template<> uint32_t mcbType<int64_t>() { return MESHIO::McbInt64; }
+
+uint64_t alignUp(uint64_t offset)
+{
+    return (offset + MCB_ALIGN - 1) / MCB_ALIGN * MCB_ALIGN;
+}
+
+/**
+ * Check that the header and every array lie inside the size bytes at base, and that V, T,
+ * M and the attributes have the rows and columns the header counts give them, so the views
+ * can never read past the mapping.
+ */
+bool validate(const char *base, size_t size, const MESHIO::McbHeader *&header, const MESHIO::McbArray *&arrays)
+{
+    header = nullptr;
+    arrays = nullptr;
+    if(size < sizeof(MESHIO::McbHeader) || memcmp(base, MCB_MAGIC, 8) != 0) {
+        std::cout << "Not a MCB mesh file." << std::endl;
+        return false;
+    }
+    const MESHIO::McbHeader *h = (const MESHIO::McbHeader *)base;
+    if(h->byteOrder != MCB_BYTE_ORDER || h->version < 1 || h->version > MCB_VERSION) {
+        std::cout << "MCB file of another byte order or version " << h->version << "." << std::endl;
+        return false;
+    }
+    if(h->fileBytes > size || sizeof(MESHIO::McbHeader) + (uint64_t)h->nArrays * sizeof(MESHIO::McbArray) > size) {
+        std::cout << "The MCB file is truncated." << std::endl;
+        return false;
+    }
+    const MESHIO::McbArray *a = (const MESHIO::McbArray *)(base + sizeof(MESHIO::McbHeader));
+    for(uint32_t i = 0; i < h->nArrays; i++) {
+        const std::string name(a[i].name, strnlen(a[i].name, sizeof(a[i].name)));
+        const size_t bytes = typeBytes(a[i].type);
+        // Divided, not multiplied: rows * cols of a crafted table may overflow.
+        bool legal = bytes != 0 && a[i].offset % MCB_ALIGN == 0 && a[i].offset <= size
+                     && (a[i].cols == 0 || a[i].rows <= (size - a[i].offset) / bytes / a[i].cols);
+        // The views index by the header counts, so the mesh arrays must have their shape.
+        if(name == "V")
+            legal = legal && a[i].rows == h->nPoints && a[i].cols == 3;
+        else if(name == "T")
+            legal = legal && a[i].rows == h->nFacets && a[i].cols == h->nCorner;
+        else if(name == "M")
+            legal = legal && a[i].rows == h->nFacets && a[i].cols == 1;
+        else if(a[i].owner == MESHIO::McbPoints || a[i].owner == MESHIO::McbFacets)
+            legal = legal && a[i].rows == (a[i].owner == MESHIO::McbPoints ? h->nPoints : h->nFacets);
+        if(!legal) {
+            std::cout << "The MCB file is illegal, bad array " << name << "." << std::endl;
+            return false;
+        }
+    }
+    header = h;
+    arrays = a;
+    return true;
+}
+
+const MESHIO::McbArray *findArray(const MESHIO::McbHeader *header, const MESHIO::McbArray *arrays, const char *name, uint32_t type)
+{
+    for(uint32_t i = 0; header && i < header->nArrays; i++)
+        if(arrays[i].type == type && strncmp(arrays[i].name, name, sizeof(arrays[i].name)) == 0)
+            return &arrays[i];
+    return nullptr;
+}
+
+// Copy the mesh arrays of a validated file into matrices.
+int copyArrays(const char *base, const MESHIO::McbHeader *header, const MESHIO::McbArray *arrays,
+               Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M)
+{
+    const MESHIO::McbArray *v = findArray(header, arrays, "V", MESHIO::McbFloat64);
+    const MESHIO::McbArray *vf = findArray(header, arrays, "V", MESHIO::McbFloat32);
+    const MESHIO::McbArray *t = findArray(header, arrays, "T", MESHIO::McbInt32);
+    const MESHIO::McbArray *tl = findArray(header, arrays, "T", MESHIO::McbInt64);
+    const MESHIO::McbArray *m = findArray(header, arrays, "M", MESHIO::McbInt32);
+    if((!v && !vf) || (!t && !tl)) {
+        std::cout << "The MCB file is illegal, no V or T array." << std::endl;
+        return -1;
+    }
+    if(v)
+        V = Eigen::Map<const Eigen::MatrixXd>((const double *)(base + v->offset), v->rows, v->cols);
+    else
+        V = Eigen::Map<const Eigen::MatrixXf>((const float *)(base + vf->offset), vf->rows, vf->cols).cast<double>();
+    if(!t && header->nPoints > (uint64_t)INT_MAX) {
+        std::cout << "The MCB file has more points than 32-bit indices address." << std::endl;
+        return -1;
+    }
+    if(t)
+        T = Eigen::Map<const Eigen::MatrixXi>((const int *)(base + t->offset), t->rows, t->cols);
+    else
+        T = Eigen::Map<const MESHIO::MatrixXl>((const int64_t *)(base + tl->offset), tl->rows, tl->cols).cast<int>();
+    if(m)
+        M = Eigen::Map<const Eigen::MatrixXi>((const int *)(base + m->offset), m->rows, m->cols);
+    else
+        M = Eigen::MatrixXi::Zero(T.rows(), 1);
+    return 1;
+}
+
+/**
+ * Write a mesh as .mcb, see McbHeader. V and T are column-major of any McbType.
+ * M may be empty, every attribute must have one row per point or per facet.
+ * @return 1/-1
+ */
+template<class MV, class MT>
+int writeArrays(std::ostream &out, const MV &V, const MT &T, const Eigen::MatrixXi &M,
+                const std::vector<MESHIO::MeshAttribute> &attributes)
+{
+    using namespace MESHIO;
+    MESH_TRACE("writeMCB");
+    struct Source {
+        McbArray array;
+        const char *data;
+    };
+    std::vector<Source> sources;
+    auto add = [&](const std::string &name, uint32_t type, uint32_t owner, long rows, long cols, const void *data, uint8_t kind = 0) {
+        Source s;
+        memset(&s.array, 0, sizeof(s.array));
+        strncpy(s.array.name, name.c_str(), sizeof(s.array.name) - 1);
+        s.array.type = type;
+        s.array.owner = owner;
+        s.array.kind = kind;
+        s.array.rows = rows;
+        s.array.cols = cols;
+        s.data = (const char *)data;
+        sources.push_back(s);
+    };
+    add("V", mcbType<typename MV::Scalar>(), McbPoints, V.rows(), V.cols(), V.data());
+    add("T", mcbType<typename MT::Scalar>(), McbFacets, T.rows(), T.cols(), T.data());
+    // Only the first marker column is kept, like every other writer; it is contiguous.
+    if(M.rows() == T.rows() && M.cols() > 0)
+        add("M", McbInt32, McbFacets, M.rows(), 1, M.data());
+    std::vector<Eigen::MatrixXd> widened;
+    widened.reserve(attributes.size());
+    for(const MeshAttribute &a : attributes) {
+        if(a.rows != (a.onPoints ? V.rows() : T.rows()) || a.name.empty() || a.name.size() >= sizeof(McbArray::name)
+           || a.name == "V" || a.name == "T" || a.name == "M") {
+            std::cout << "Skipped attribute " << a.name << ", its name or row count does not fit." << std::endl;
+            continue;
+        }
+        const uint32_t owner = a.onPoints ? McbPoints : McbFacets;
+        const uint8_t kind = (uint8_t)a.kind + 1;
+        if(a.type == AttributeType::Float64)
+            add(a.name, McbFloat64, owner, a.rows, a.components, a.data.data(), kind);
+        else if(a.type == AttributeType::Float32)
+            add(a.name, McbFloat32, owner, a.rows, a.components, a.data.data(), kind);
+        else if(a.type == AttributeType::Int32)
+            add(a.name, McbInt32, owner, a.rows, a.components, a.data.data(), kind);
+        else if(a.type == AttributeType::Int64)
+            add(a.name, McbInt64, owner, a.rows, a.components, a.data.data(), kind);
+        else {
+            widened.push_back(a.toMatrix());
+            add(a.name, McbFloat64, owner, a.rows, a.components, widened.back().data(), kind);
+        }
+    }
+
+    uint64_t offset = alignUp(sizeof(McbHeader) + sources.size() * sizeof(McbArray));
+    for(Source &s : sources) {
+        s.array.offset = offset;
+        offset = alignUp(offset + s.array.rows * s.array.cols * typeBytes(s.array.type));
+    }
+    McbHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MCB_MAGIC, 8);
+    header.byteOrder = MCB_BYTE_ORDER;
+    header.version = MCB_VERSION;
+    header.nPoints = V.rows();
+    header.nFacets = T.rows();
+    header.nCorner = T.cols();
+    header.nArrays = sources.size();
+    header.fileBytes = offset;
+
+    static const char zeros[MCB_ALIGN] = {0};
+    uint64_t written = 0;
+    auto put = [&](const char *data, uint64_t bytes) {
+        out.write(data, bytes);
+        written += bytes;
+    };
+    put((const char *)&header, sizeof(header));
+    for(const Source &s : sources)
+        put((const char *)&s.array, sizeof(s.array));
+    for(const Source &s : sources) {
+        put(zeros, s.array.offset - written);
+        put(s.data, s.array.rows * s.array.cols * typeBytes(s.array.type));
+    }
+    put(zeros, header.fileBytes - written);
+    return out ? 1 : -1;
+}
+
+// Copy a mapped file into matrices, converting the precision and index width as needed.
+template<class MV, class MT>
+int readMapped(const std::string &filename, MV &V, MT &T, Eigen::MatrixXi &M, MESHIO::MeshAttributes *attributes = nullptr)
+{
+    MESH_TRACE("readMCB", filename);
+    MESHIO::MappedMesh mesh;
+    if(mesh.open(filename) < 0)
+        return -1;
+    if(mesh.isIndex64() && sizeof(typename MT::Scalar) < 8 && mesh.nPoints() > INT_MAX) {
+        std::cout << "The MCB file has more points than 32-bit indices address. - " << filename << std::endl;
+        return -1;
+    }
+    std::cout << "Reading mesh from - " << filename << std::endl;
+    if(mesh.isFloat32())
+        V = mesh.Vf().cast<typename MV::Scalar>();
+    else
+        V = mesh.V().cast<typename MV::Scalar>();
+    if(mesh.isIndex64())
+        T = mesh.Tl().cast<typename MT::Scalar>();
+    else
+        T = mesh.T().cast<typename MT::Scalar>();
+    if(mesh.M().cols() > 0)
+        M = mesh.M();
+    else
+        M = Eigen::MatrixXi::Zero(T.rows(), 1);
+    if(attributes)
+        mesh.readAttributes(*attributes);
+    return 1;
+}
+
+bool openOutput(std::ofstream &f, const std::string &filename)
+{
+    f.open(filename, std::ios::binary);
+    if(!f.is_open()) {
+        std::cout << "Write MCB file failed. - " << filename << std::endl;
+        return false;
+    }
+    std::cout << "Writing mesh to - " << filename << std::endl;
+    return true;
+}
+
+}
+
+int MESHIO::writeMCB(std::ostream &out, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M,
+                     const std::vector<MeshAttribute> &attributes)
+{
+    return writeArrays(out, V, T, M, attributes);
+}
+
+int MESHIO::writeMCB(std::ostream &out, const Eigen::MatrixXf &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M,
+                     const std::vector<MeshAttribute> &attributes)
+{
+    return writeArrays(out, V, T, M, attributes);
+}
+
+int MESHIO::writeMCB(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M,
+                     const std::vector<MeshAttribute> &attributes)
+{
+    std::ofstream f;
+    return openOutput(f, filename) ? MESHIO::writeMCB(f, V, T, M, attributes) : -1;
+}
+
+int MESHIO::writeMCB(std::string filename, const Eigen::MatrixXf &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M,
+                     const std::vector<MeshAttribute> &attributes)
+{
+    std::ofstream f;
+    return openOutput(f, filename) ? MESHIO::writeMCB(f, V, T, M, attributes) : -1;
+}
+
+int MESHIO::writeMCB(std::ostream &out, const Eigen::MatrixXd &V, const MatrixXl &T, const Eigen::MatrixXi &M,
+                     const std::vector<MeshAttribute> &attributes)
+{
+    return writeArrays(out, V, T, M, attributes);
+}
+
+int MESHIO::writeMCB(std::ostream &out, const Eigen::MatrixXf &V, const MatrixXl &T, const Eigen::MatrixXi &M,
+                     const std::vector<MeshAttribute> &attributes)
+{
+    return writeArrays(out, V, T, M, attributes);
+}
+
+int MESHIO::writeMCB(std::string filename, const Eigen::MatrixXd &V, const MatrixXl &T, const Eigen::MatrixXi &M,
+                     const std::vector<MeshAttribute> &attributes)
+{
+    std::ofstream f;
+    return openOutput(f, filename) ? MESHIO::writeMCB(f, V, T, M, attributes) : -1;
+}
+
+int MESHIO::writeMCB(std::string filename, const Eigen::MatrixXf &V, const MatrixXl &T, const Eigen::MatrixXi &M,
+                     const std::vector<MeshAttribute> &attributes)
+{
+    std::ofstream f;
+    return openOutput(f, filename) ? MESHIO::writeMCB(f, V, T, M, attributes) : -1;
+}
+
+/**
+ * Read a .mcb file into matrices. To use the arrays in place, open a MappedMesh instead.
+ * @return 1/-1
+ */
+int MESHIO::readMCB(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M)
+{
+    return readMapped(filename, V, T, M);
+}
+
+int MESHIO::readMCB(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, MeshAttributes &attributes)
+{
+    return readMapped(filename, V, T, M, &attributes);
+}
+
+int MESHIO::readMCB(std::string filename, Eigen::MatrixXf &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M)
+{
+    return readMapped(filename, V, T, M);
+}
+
+int MESHIO::readMCB(std::string filename, Eigen::MatrixXd &V, MatrixXl &T, Eigen::MatrixXi &M)
+{
+    return readMapped(filename, V, T, M);
+}
+
+int MESHIO::readMCB(std::string filename, Eigen::MatrixXf &V, MatrixXl &T, Eigen::MatrixXi &M)
+{
+    return readMapped(filename, V, T, M);
+}
+
+int MESHIO::readMCB(std::istream &in, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M)
+{
+    MESH_TRACE("readMCB");
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const McbHeader *header;
+    const McbArray *arrays;
+    if(!validate(data.data(), data.size(), header, arrays))
+        return -1;
+    return copyArrays(data.data(), header, arrays, V, T, M);
+}
+
+MESHIO::MappedMesh::~MappedMesh()
+{
+    close();
+}
+
+/**
+ * Map a .mcb file. Only the header and the array table are checked, no array is read.
+ * @return 1/-1
+ */
+int MESHIO::MappedMesh::open(const std::string &filename)
+{
+    MESH_TRACE("MappedMesh::open", filename);
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        std::cout << "No such file. - " << filename << std::endl;
+        return -1;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(McbHeader)) {
+        ::close(fd);
+        std::cout << "Not a MCB mesh file. - " << filename << std::endl;
+        return -1;
+    }
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(data == MAP_FAILED) {
+        std::cout << "Map file failed. - " << filename << std::endl;
+        return -1;
+    }
+    mapping = data;
+    mappedBytes = st.st_size;
+    if(!validate((const char *)mapping, mappedBytes, header, arrays) || (!find("V", McbFloat64) && !isFloat32()) || (!find("T", McbInt32) && !isIndex64())) {
+        close();
+        return -1;
+    }
+    return 1;
+}
+
+void MESHIO::MappedMesh::close()
+{
+    if(mapping)
+        munmap(mapping, mappedBytes);
+    mapping = nullptr;
+    mappedBytes = 0;
+    header = nullptr;
+    arrays = nullptr;
+}
+
+const MESHIO::McbArray *MESHIO::MappedMesh::find(const char *name, uint32_t type) const
+{
+    return findArray(header, arrays, name, type);
+}
+
+Eigen::Map<const Eigen::MatrixXd> MESHIO::MappedMesh::V() const
+{
+    const McbArray *a = find("V", McbFloat64);
+    return a ? Eigen::Map<const Eigen::MatrixXd>((const double *)((const char *)mapping + a->offset), a->rows, a->cols)
+             : Eigen::Map<const Eigen::MatrixXd>(nullptr, 0, 3);
+}
+
+Eigen::Map<const Eigen::MatrixXf> MESHIO::MappedMesh::Vf() const
+{
+    const McbArray *a = find("V", McbFloat32);
+    return a ? Eigen::Map<const Eigen::MatrixXf>((const float *)((const char *)mapping + a->offset), a->rows, a->cols)
+             : Eigen::Map<const Eigen::MatrixXf>(nullptr, 0, 3);
+}
+
+Eigen::Map<const Eigen::MatrixXi> MESHIO::MappedMesh::T() const
+{
+    const McbArray *a = find("T", McbInt32);
+    return a ? Eigen::Map<const Eigen::MatrixXi>((const int *)((const char *)mapping + a->offset), a->rows, a->cols)
+             : Eigen::Map<const Eigen::MatrixXi>(nullptr, 0, 3);
+}
+
+Eigen::Map<const MESHIO::MatrixXl> MESHIO::MappedMesh::Tl() const
+{
+    const McbArray *a = find("T", McbInt64);
+    return a ? Eigen::Map<const MatrixXl>((const int64_t *)((const char *)mapping + a->offset), a->rows, a->cols)
+             : Eigen::Map<const MatrixXl>(nullptr, 0, 3);
+}
+
+Eigen::Map<const Eigen::MatrixXi> MESHIO::MappedMesh::M() const
+{
+    const McbArray *a = find("M", McbInt32);
+    return a ? Eigen::Map<const Eigen::MatrixXi>((const int *)((const char *)mapping + a->offset), a->rows, a->cols)
+             : Eigen::Map<const Eigen::MatrixXi>(nullptr, nFacets(), 0);
+}
+
+std::vector<std::string> MESHIO::MappedMesh::attributeNames() const
+{
+    std::vector<std::string> names;
+    for(uint32_t i = 0; header && i < header->nArrays; i++) {
+        std::string name(arrays[i].name, strnlen(arrays[i].name, sizeof(arrays[i].name)));
+        if(name != "V" && name != "T" && name != "M")
+            names.push_back(name);
+    }
+    return names;
+}
+
+Eigen::Map<const Eigen::MatrixXd> MESHIO::MappedMesh::attribute(const std::string &name, bool *onPoints) const
+{
+    const McbArray *a = name.size() < sizeof(McbArray::name) ? find(name.c_str(), McbFloat64) : nullptr;
+    if(!a)
+        return Eigen::Map<const Eigen::MatrixXd>(nullptr, 0, 0);
+    if(onPoints)
+        *onPoints = a->owner == McbPoints;
+    return Eigen::Map<const Eigen::MatrixXd>((const double *)((const char *)mapping + a->offset), a->rows, a->cols);
+}
+
+int MESHIO::MappedMesh::readAttributes(MeshAttributes &attributes) const
+{
+    attributes.clear();
+    for(uint32_t i = 0; header && i < header->nArrays; i++) {
+        const McbArray &array = arrays[i];
+        MeshAttribute a;
+        a.name = std::string(array.name, strnlen(array.name, sizeof(array.name)));
+        if(a.name == "V" || a.name == "T" || a.name == "M" || array.owner == McbMesh)
+            continue;
+        a.onPoints = array.owner == McbPoints;
+        if(array.kind > 0 && array.kind <= (uint8_t)AttributeKind::Field + 1)
+            a.kind = (AttributeKind)(array.kind - 1);
+        else
+            a.kind = array.cols == 3 ? AttributeKind::Vectors : array.cols <= 4 ? AttributeKind::Scalars : AttributeKind::Field;
+        if(array.type == McbFloat32)
+            a.type = AttributeType::Float32;
+        else if(array.type == McbInt32)
+            a.type = AttributeType::Int32;
+        else if(array.type == McbInt64)
+            a.type = AttributeType::Int64;
+        a.components = (int)array.cols;
+        a.resize((long)array.rows);
+        memcpy(a.data.data(), (const char *)mapping + array.offset, a.data.size());
+        attributes.push_back(std::move(a));
+    }
+    return (int)attributes.size();
+}
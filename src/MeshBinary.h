@@ -0,0 +1,129 @@
+#ifndef MESH_BINARY_H
+#define MESH_BINARY_H
+
+#include "MeshLayout.h"
+#include "MeshAttributes.h"
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace MESHIO {
+
+	/**
+	 * Native binary mesh (.mcb), made to be opened without parsing. Every array is stored
+	 * contiguous and column-major like Eigen's default matrices, 64-byte aligned, in the byte
+	 * order of the writer:
+	 *   McbHeader      64 bytes, magic "MCBMESH1", byte order mark, counts, number of arrays
+	 *   McbArray[n]    name, element type, rows, columns and offset of every array
+	 *   arrays         "V" points (float64 x 3, float32 x 3 from --float32), "T" facets (int32 x nCorner,
+	 *                  int64 past 2^31 - 1 points),
+	 *                  "M" markers (int32 x 1, optional), then the attributes (MeshAttributes.h)
+	 *                  in their own type, the types .mcb has no McbType for as float64, and their
+	 *                  kind (VECTORS, NORMALS, ..) since version 2
+	 */
+	struct McbHeader {
+		char magic[8];
+		uint32_t byteOrder;     // 0x01020304 as written
+		uint32_t version;
+		uint64_t nPoints;
+		uint64_t nFacets;
+		uint32_t nCorner;
+		uint32_t nArrays;
+		uint64_t fileBytes;
+		uint8_t reserved[16];
+	};
+
+	enum McbType : uint32_t { McbInt32 = 1, McbFloat64 = 2, McbFloat32 = 3, McbInt64 = 4 };
+	enum McbOwner : uint32_t { McbMesh = 0, McbPoints = 1, McbFacets = 2 };
+
+	struct McbArray {
+		char name[40];          // zero padded
+		uint32_t type;          // McbType
+		uint16_t owner;         // McbOwner, which elements the rows belong to
+		uint8_t kind;           // AttributeKind + 1 of an attribute, 0 when unknown (version 1 files)
+		uint8_t reserved;
+		uint64_t rows;
+		uint64_t cols;
+		uint64_t offset;        // from the start of the header
+	};
+
+	int writeMCB(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M,
+	             const std::vector<MeshAttribute> &attributes = {});
+	int writeMCB(std::ostream &out, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M,
+	             const std::vector<MeshAttribute> &attributes = {});
+	int writeMCB(std::string filename, const Eigen::MatrixXf &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M,
+	             const std::vector<MeshAttribute> &attributes = {});
+	int writeMCB(std::ostream &out, const Eigen::MatrixXf &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M,
+	             const std::vector<MeshAttribute> &attributes = {});
+	int writeMCB(std::string filename, const Eigen::MatrixXd &V, const MatrixXl &T, const Eigen::MatrixXi &M,
+	             const std::vector<MeshAttribute> &attributes = {});
+	int writeMCB(std::ostream &out, const Eigen::MatrixXd &V, const MatrixXl &T, const Eigen::MatrixXi &M,
+	             const std::vector<MeshAttribute> &attributes = {});
+	int writeMCB(std::string filename, const Eigen::MatrixXf &V, const MatrixXl &T, const Eigen::MatrixXi &M,
+	             const std::vector<MeshAttribute> &attributes = {});
+	int writeMCB(std::ostream &out, const Eigen::MatrixXf &V, const MatrixXl &T, const Eigen::MatrixXi &M,
+	             const std::vector<MeshAttribute> &attributes = {});
+	// Points stored in the other precision and indices in the other width are converted;
+	// int64 indices only go into int when there are fewer than 2^31 points.
+	int readMCB(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
+	int readMCB(std::string filename, Eigen::MatrixXf &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
+	int readMCB(std::string filename, Eigen::MatrixXd &V, MatrixXl &T, Eigen::MatrixXi &M);
+	int readMCB(std::string filename, Eigen::MatrixXf &V, MatrixXl &T, Eigen::MatrixXi &M);
+	int readMCB(std::istream &in, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
+	// With the attributes too, see MappedMesh::readAttributes.
+	int readMCB(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, MeshAttributes &attributes);
+
+	/**
+	 * A .mcb file mapped read-only. The views point into the mapping: nothing is copied,
+	 * pages are read on first touch, and the views are valid until close().
+	 */
+	class MappedMesh {
+	public:
+		MappedMesh() = default;
+		~MappedMesh();
+		MappedMesh(const MappedMesh &) = delete;
+		MappedMesh &operator=(const MappedMesh &) = delete;
+
+		int open(const std::string &filename);
+		void close();
+		bool isOpen() const { return header != nullptr; }
+
+		long nPoints() const { return header ? (long)header->nPoints : 0; }
+		long nFacets() const { return header ? (long)header->nFacets : 0; }
+		int nCorner() const { return header ? (int)header->nCorner : 0; }
+		// Points are either float64, V(), or float32, Vf(); the other view has no rows.
+		bool isFloat32() const { return find("V", McbFloat32) != nullptr; }
+		Eigen::Map<const Eigen::MatrixXd> V() const;
+		Eigen::Map<const Eigen::MatrixXf> Vf() const;
+		// Facets are either int32, T(), or int64, Tl(); the other view has no rows.
+		bool isIndex64() const { return find("T", McbInt64) != nullptr; }
+		Eigen::Map<const Eigen::MatrixXi> T() const;
+		Eigen::Map<const MatrixXl> Tl() const;
+		// No columns when the file has no markers.
+		Eigen::Map<const Eigen::MatrixXi> M() const;
+
+		std::vector<std::string> attributeNames() const;
+		// No rows when there is no float64 attribute of that name, e.g. one of another type.
+		Eigen::Map<const Eigen::MatrixXd> attribute(const std::string &name, bool *onPoints = nullptr) const;
+		/**
+		 * Copy every attribute out in its stored type and kind. Version 1 files do not keep the
+		 * kind: three components come back as VECTORS, up to four as SCALARS, more as FIELD arrays.
+		 * @return the number of attributes
+		 */
+		int readAttributes(MeshAttributes &attributes) const;
+
+	private:
+		const McbArray *find(const char *name, uint32_t type) const;
+
+		void *mapping = nullptr;
+		size_t mappedBytes = 0;
+		const McbHeader *header = nullptr;
+		const McbArray *arrays = nullptr;
+	};
+};
+
+#endif
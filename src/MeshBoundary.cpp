@@ -0,0 +1,356 @@
+#include "MeshBoundary.h"
+#include "MeshTrace.h"
+#include "meshIO.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+using namespace std;
+
+/**
+ * Extract the open boundary of a mesh and chain it into ordered loops.
+ *
+ * Every facet edge is bucketed by its smaller vertex with a counting sort, so pairing
+ * the edges is linear in the number of facets. An edge whose bucket holds no twin is a
+ * boundary edge. Boundary edges keep the direction of their facet, which makes
+ * next[e] the boundary edge leaving the end vertex of e.
+ * @param V
+ * @param F facets, any number of columns.
+ * @param loops result.
+ * @return number of loops.
+ */
+int MESHIO::extractBoundary(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, BoundaryLoops &loops)
+{
+    MESH_TRACE("extractBoundary");
+    const int nV = V.rows();
+    const int nCorner = F.cols();
+    const int nHalf = F.rows() * nCorner;
+
+    loops = BoundaryLoops();
+    loops.loopOffset.push_back(0);
+    if(nHalf == 0 || nCorner < 2) {
+        loops.E.resize(0, 2);
+        return 0;
+    }
+
+    // Bucket half edge h = f * nCorner + j, going F(f, j) -> F(f, j + 1), by its smaller vertex.
+    vector<int> bucketOffset(nV + 1, 0);
+    for(int f = 0; f < F.rows(); f++)
+        for(int j = 0; j < nCorner; j++)
+            bucketOffset[min(F(f, j), F(f, (j + 1) % nCorner)) + 1]++;
+    for(int v = 0; v < nV; v++)
+        bucketOffset[v + 1] += bucketOffset[v];
+
+    vector<int> bucket(nHalf);
+    vector<int> fill(bucketOffset.begin(), bucketOffset.end() - 1);
+    for(int f = 0; f < F.rows(); f++)
+        for(int j = 0; j < nCorner; j++)
+            bucket[fill[min(F(f, j), F(f, (j + 1) % nCorner))]++] = f * nCorner + j;
+
+    auto edgeFrom = [&](int h) { return F(h / nCorner, h % nCorner); };
+    auto edgeTo = [&](int h) { return F(h / nCorner, (h % nCorner + 1) % nCorner); };
+    auto edgeMax = [&](int h) { return max(edgeFrom(h), edgeTo(h)); };
+
+    // Count the edges of a bucket per far vertex; the counters are cleared again after each bucket.
+    vector<int> boundary;
+    vector<int> multiplicity(nV, 0);
+    for(int v = 0; v < nV; v++) {
+        for(int a = bucketOffset[v]; a < bucketOffset[v + 1]; a++)
+            multiplicity[edgeMax(bucket[a])]++;
+        for(int a = bucketOffset[v]; a < bucketOffset[v + 1]; a++)
+            if(multiplicity[edgeMax(bucket[a])] == 1)
+                boundary.push_back(bucket[a]);
+        for(int a = bucketOffset[v]; a < bucketOffset[v + 1]; a++)
+            multiplicity[edgeMax(bucket[a])] = 0;
+    }
+
+    // Outgoing boundary edges per vertex, again as a counting sort.
+    const int nB = boundary.size();
+    vector<int> outOffset(nV + 1, 0);
+    for(int e = 0; e < nB; e++)
+        outOffset[edgeFrom(boundary[e]) + 1]++;
+    for(int v = 0; v < nV; v++)
+        outOffset[v + 1] += outOffset[v];
+    vector<int> outEdge(nB);
+    fill.assign(outOffset.begin(), outOffset.end() - 1);
+    for(int e = 0; e < nB; e++)
+        outEdge[fill[edgeFrom(boundary[e])]++] = e;
+
+    // Flat next-edge array. At a pinched vertex the outgoing edges are handed out in turn.
+    vector<int> next(nB, -1);
+    vector<int> prev(nB, -1);
+    for(int e = 0; e < nB; e++) {
+        int v = edgeTo(boundary[e]);
+        for(int k = outOffset[v]; k < outOffset[v + 1]; k++) {
+            if(prev[outEdge[k]] == -1) {
+                next[e] = outEdge[k];
+                prev[outEdge[k]] = e;
+                break;
+            }
+        }
+    }
+
+    // Walk the chains. Open chains are started from their head so they come out whole.
+    vector<int> order;
+    order.reserve(nB);
+    vector<bool> visited(nB, false);
+    auto walk = [&](int start) {
+        double perimeter = 0.0;
+        int e = start;
+        do {
+            visited[e] = true;
+            order.push_back(e);
+            perimeter += (V.row(edgeTo(boundary[e])) - V.row(edgeFrom(boundary[e]))).norm();
+            e = next[e];
+        } while(e != -1 && e != start);
+        loops.loopClosed.push_back(e == start);
+        loops.perimeter.push_back(perimeter);
+        loops.loopOffset.push_back(order.size());
+    };
+    for(int e = 0; e < nB; e++)
+        if(!visited[e] && prev[e] == -1)
+            walk(e);
+    for(int e = 0; e < nB; e++)
+        if(!visited[e])
+            walk(e);
+
+    loops.E.resize(nB, 2);
+    loops.next.assign(nB, -1);
+    for(int i = 0; i < nB; i++) {
+        loops.E(i, 0) = edgeFrom(boundary[order[i]]);
+        loops.E(i, 1) = edgeTo(boundary[order[i]]);
+    }
+    for(int k = 0; k < loops.nLoops(); k++) {
+        for(int i = loops.loopOffset[k]; i + 1 < loops.loopOffset[k + 1]; i++)
+            loops.next[i] = i + 1;
+        if(loops.loopClosed[k])
+            loops.next[loops.loopOffset[k + 1] - 1] = loops.loopOffset[k];
+    }
+    return loops.nLoops();
+}
+
+void MESHIO::printBoundary(const BoundaryLoops &loops)
+{
+    const int maxListed = 32;
+    int nClosed = count(loops.loopClosed.begin(), loops.loopClosed.end(), true);
+    std::cout << "Boundary edges : " << loops.E.rows() << std::endl;
+    std::cout << "Boundary loops : " << loops.nLoops() << " (" << nClosed << " closed, " << loops.nLoops() - nClosed << " open)" << std::endl;
+    if(loops.nLoops() == 0) {
+        std::cout << "The mesh is watertight." << std::endl;
+        return;
+    }
+    for(int k = 0; k < loops.nLoops() && k < maxListed; k++) {
+        std::cout << "  loop " << k << " : " << loops.loopOffset[k + 1] - loops.loopOffset[k] << " edges, perimeter "
+                  << loops.perimeter[k] << (loops.loopClosed[k] ? "" : ", open") << std::endl;
+    }
+    if(loops.nLoops() > maxListed)
+        std::cout << "  ... " << loops.nLoops() - maxListed << " more loops" << std::endl;
+}
+
+/**
+ * Write the boundary loops as VTK line cells, with the loop id as cell data.
+ */
+int MESHIO::writeBoundaryVTK(std::string filename, const Eigen::MatrixXd &V, const BoundaryLoops &loops)
+{
+    MESH_TRACE("writeBoundaryVTK", filename);
+    Eigen::MatrixXi loopId(loops.E.rows(), 1);
+    for(int k = 0; k < loops.nLoops(); k++)
+        for(int i = loops.loopOffset[k]; i < loops.loopOffset[k + 1]; i++)
+            loopId(i, 0) = k;
+    return MESHIO::writeVTK(filename, V, loops.E, loopId, "loop_id");
+}
+
+namespace {
+
+// Corners of face k of a tetrahedron (a, b, c, d), outward when det(b - a, c - a, d - a) > 0.
+// Face k is opposite corner 3 - k.
+const int tetFace[4][3] = { {0, 2, 1}, {0, 1, 3}, {0, 3, 2}, {1, 2, 3} };
+
+template<class Index, class Id>
+long surfaceKernel(const Eigen::MatrixXd &V, const Eigen::Matrix<Index, Eigen::Dynamic, Eigen::Dynamic> &T, const Eigen::MatrixXi &TM,
+                   Eigen::Matrix<Index, Eigen::Dynamic, Eigen::Dynamic> &F, Eigen::MatrixXi &M)
+{
+    const long nV = V.rows();
+    const long nT = T.rows();
+    const long nFaces = nT * 4;
+    auto minCorner = [&](long t, int k) {
+        return min(T(t, tetFace[k][0]), min(T(t, tetFace[k][1]), T(t, tetFace[k][2])));
+    };
+
+    // Bucket face id = t * 4 + k by its smallest vertex, a counting sort filled in parallel.
+    vector<int64_t> bucketOffset(nV + 1, 0);
+#pragma omp parallel for schedule(static)
+    for(long t = 0; t < nT; t++)
+        for(int k = 0; k < 4; k++) {
+#pragma omp atomic
+            bucketOffset[minCorner(t, k) + 1]++;
+        }
+    for(long v = 0; v < nV; v++)
+        bucketOffset[v + 1] += bucketOffset[v];
+    vector<Id> bucket(nFaces);
+    vector<int64_t> fill(bucketOffset.begin(), bucketOffset.end() - 1);
+#pragma omp parallel for schedule(static)
+    for(long t = 0; t < nT; t++)
+        for(int k = 0; k < 4; k++) {
+            int64_t slot;
+#pragma omp atomic capture
+            slot = fill[minCorner(t, k)]++;
+            bucket[slot] = (Id)(t * 4 + k);
+        }
+    vector<int64_t>().swap(fill);
+
+    // In each bucket, sort the faces by their two other vertices: a face met once is on the boundary.
+    vector<uint8_t> keep(nFaces, 0);
+#pragma omp parallel
+    {
+        vector<pair<pair<Index, Index>, Id>> keys;
+#pragma omp for schedule(dynamic, 4096)
+        for(long v = 0; v < nV; v++) {
+            keys.clear();
+            for(int64_t a = bucketOffset[v]; a < bucketOffset[v + 1]; a++) {
+                const long t = bucket[a] / 4;
+                const int k = bucket[a] % 4;
+                Index c[3] = { T(t, tetFace[k][0]), T(t, tetFace[k][1]), T(t, tetFace[k][2]) };
+                sort(c, c + 3);
+                keys.push_back(make_pair(make_pair(c[1], c[2]), bucket[a]));
+            }
+            sort(keys.begin(), keys.end());
+            for(size_t i = 0; i < keys.size(); ) {
+                size_t j = i + 1;
+                while(j < keys.size() && keys[j].first == keys[i].first)
+                    j++;
+                if(j == i + 1)
+                    keep[keys[i].second] = 1;
+                i = j;
+            }
+        }
+    }
+    vector<Id>().swap(bucket);
+
+    // Compact in tetrahedron order, block by block, so the result does not depend on the threads.
+    const long nBlocks = 256;
+    const long blockSize = (nT + nBlocks - 1) / nBlocks;
+    vector<long> blockOffset(nBlocks + 1, 0);
+#pragma omp parallel for schedule(static)
+    for(long b = 0; b < nBlocks; b++)
+        for(long f = b * blockSize * 4; f < min(nT, (b + 1) * blockSize) * 4; f++)
+            blockOffset[b + 1] += keep[f];
+    for(long b = 0; b < nBlocks; b++)
+        blockOffset[b + 1] += blockOffset[b];
+
+    const bool marked = TM.rows() == nT;
+    F.resize(blockOffset[nBlocks], 3);
+    M.resize(marked ? blockOffset[nBlocks] : 0, 1);
+#pragma omp parallel for schedule(static)
+    for(long b = 0; b < nBlocks; b++) {
+        long out = blockOffset[b];
+        for(long t = b * blockSize; t < min(nT, (b + 1) * blockSize); t++) {
+            bool flipped = false, oriented = false;
+            for(int k = 0; k < 4; k++) {
+                if(!keep[t * 4 + k])
+                    continue;
+                if(!oriented) {
+                    Eigen::Vector3d a = V.row(T(t, 0)).transpose();
+                    Eigen::Matrix3d edges;
+                    edges << V.row(T(t, 1)) - a.transpose(), V.row(T(t, 2)) - a.transpose(), V.row(T(t, 3)) - a.transpose();
+                    flipped = edges.determinant() < 0;
+                    oriented = true;
+                }
+                F(out, 0) = T(t, tetFace[k][0]);
+                F(out, 1) = T(t, tetFace[k][flipped ? 2 : 1]);
+                F(out, 2) = T(t, tetFace[k][flipped ? 1 : 2]);
+                if(marked)
+                    M(out, 0) = TM(t, 0);
+                out++;
+            }
+        }
+    }
+    return F.rows();
+}
+
+template<class Index>
+long surface(const Eigen::MatrixXd &V, const Eigen::Matrix<Index, Eigen::Dynamic, Eigen::Dynamic> &T, const Eigen::MatrixXi &TM,
+             Eigen::Matrix<Index, Eigen::Dynamic, Eigen::Dynamic> &F, Eigen::MatrixXi &M)
+{
+    MESH_TRACE("extractSurface");
+    if(T.cols() != 4) {
+        std::cout << "Surface extraction needs tetrahedra, the mesh has " << T.cols() << " corners per cell." << std::endl;
+        return -1;
+    }
+    long nFaces;
+    // 32-bit face ids halve the bucket up to 2^30 tetrahedra.
+    if(T.rows() * 4 <= (long)UINT32_MAX)
+        nFaces = surfaceKernel<Index, uint32_t>(V, T, TM, F, M);
+    else
+        nFaces = surfaceKernel<Index, int64_t>(V, T, TM, F, M);
+    std::cout << "Boundary surface : " << nFaces << " triangles of " << T.rows() << " tetrahedra." << std::endl;
+    return nFaces;
+}
+
+template<class Index>
+long compact(Eigen::MatrixXd &V, Eigen::Matrix<Index, Eigen::Dynamic, Eigen::Dynamic> &F)
+{
+    vector<Index> newIndex(V.rows(), 0);
+    for(long i = 0; i < F.size(); i++)
+        newIndex[F(i)] = 1;
+    long n = 0;
+    for(long v = 0; v < V.rows(); v++) {
+        if(newIndex[v]) {
+            newIndex[v] = (Index)n;
+            if(n != v)
+                V.row(n) = V.row(v);
+            n++;
+        } else {
+            newIndex[v] = -1;
+        }
+    }
+    const long removed = V.rows() - n;
+    V.conservativeResize(n, V.cols());
+#pragma omp parallel for schedule(static)
+    for(long i = 0; i < F.size(); i++)
+        F(i) = newIndex[F(i)];
+    return removed;
+}
+
+}
+
+/**
+ * Boundary surface of a tetrahedral mesh: the faces that belong to one tetrahedron only.
+ *
+ * The 4 faces of every tetrahedron are bucketed by their smallest vertex with a counting
+ * sort, then each bucket is sorted by the two other vertices, both in parallel. Faces
+ * come out in tetrahedron order, turned outwards whatever the orientation of their
+ * tetrahedron, with its marker.
+ * @param V
+ * @param T tetrahedra.
+ * @param TM one marker per tetrahedron, or no rows.
+ * @param F boundary triangles.
+ * @param M their markers, or no rows.
+ * @return number of boundary triangles, -1 if T are not tetrahedra.
+ */
+long MESHIO::extractSurface(const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &TM, Eigen::MatrixXi &F, Eigen::MatrixXi &M)
+{
+    return surface(V, T, TM, F, M);
+}
+
+long MESHIO::extractSurface(const Eigen::MatrixXd &V, const MatrixXl &T, const Eigen::MatrixXi &TM, MatrixXl &F, Eigen::MatrixXi &M)
+{
+    return surface(V, T, TM, F, M);
+}
+
+/**
+ * Drop the points no facet uses, e.g. the interior points of a volume mesh after
+ * extractSurface, and renumber the facets.
+ * @return number of points removed.
+ */
+long MESHIO::removeUnreferencedPoints(Eigen::MatrixXd &V, Eigen::MatrixXi &F)
+{
+    return compact(V, F);
+}
+
+long MESHIO::removeUnreferencedPoints(Eigen::MatrixXd &V, MatrixXl &F)
+{
+    return compact(V, F);
+}
@@ -0,0 +1,38 @@
+#ifndef MESH_BOUNDARY_H
+#define MESH_BOUNDARY_H
+
+#include "MeshLayout.h"
+
+#include <Eigen/Dense>
+#include <string>
+#include <vector>
+
+namespace MESHIO {
+
+	/**
+	 * Open boundary of a surface mesh, as chains of boundary edges.
+	 * E holds the boundary edges (v0, v1) in facet orientation, grouped loop by loop
+	 * and ordered along each loop. Loop k owns rows [loopOffset[k], loopOffset[k + 1]) of E.
+	 */
+	struct BoundaryLoops {
+		Eigen::MatrixXi E;
+		std::vector<int> next;          // next[e] is the boundary edge following e, -1 at the end of an open chain
+		std::vector<int> loopOffset;    // nLoops + 1 entries
+		std::vector<bool> loopClosed;
+		std::vector<double> perimeter;
+
+		int nLoops() const { return (int)perimeter.size(); }
+	};
+
+	int extractBoundary(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, BoundaryLoops &loops);
+	void printBoundary(const BoundaryLoops &loops);
+	int writeBoundaryVTK(std::string filename, const Eigen::MatrixXd &V, const BoundaryLoops &loops);
+
+	// Outward boundary triangles F of the tetrahedra T, with the markers TM of their tetrahedra.
+	long extractSurface(const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &TM, Eigen::MatrixXi &F, Eigen::MatrixXi &M);
+	long extractSurface(const Eigen::MatrixXd &V, const MatrixXl &T, const Eigen::MatrixXi &TM, MatrixXl &F, Eigen::MatrixXi &M);
+	long removeUnreferencedPoints(Eigen::MatrixXd &V, Eigen::MatrixXi &F);
+	long removeUnreferencedPoints(Eigen::MatrixXd &V, MatrixXl &F);
+};
+
+#endif
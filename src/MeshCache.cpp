@@ -0,0 +1,327 @@
+#include "MeshCache.h"
+#include "MeshTrace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+#include <unistd.h>
+
+// Bumped whenever a writer changes its output, so older entries stop matching.
+#define CACHE_VERSION 3
+#define HASH_CHUNK (4 << 20)
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+const uint64_t P1 = 11400714785074694791ULL;
+const uint64_t P2 = 14029467366897019727ULL;
+const uint64_t P3 = 1609587929392839161ULL;
+const uint64_t P4 = 9650029242287828579ULL;
+const uint64_t P5 = 2870177450012600261ULL;
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+inline uint64_t read64(const unsigned char *p) { uint64_t v; memcpy(&v, p, 8); return v; }
+inline uint32_t read32(const unsigned char *p) { uint32_t v; memcpy(&v, p, 4); return v; }
+inline uint64_t round64(uint64_t acc, uint64_t input) { return rotl(acc + input * P2, 31) * P1; }
+inline uint64_t merge64(uint64_t acc, uint64_t value) { return (acc ^ round64(0, value)) * P1 + P4; }
+
+std::string hex64(uint64_t value)
+{
+    char text[17];
+    snprintf(text, sizeof(text), "%016llx", (unsigned long long)value);
+    return text;
+}
+
+// Clone the file where the file system shares extents (btrfs, XFS), copy it otherwise.
+bool cloneFile(const std::string &from, const std::string &to)
+{
+    std::error_code ec;
+    fs::remove(to, ec);
+#if defined(__linux__) && defined(FICLONE)
+    int src = open(from.c_str(), O_RDONLY);
+    if(src >= 0) {
+        int dst = open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bool cloned = dst >= 0 && ioctl(dst, FICLONE, src) == 0;
+        if(dst >= 0)
+            close(dst);
+        close(src);
+        if(cloned)
+            return true;
+    }
+#endif
+    return fs::copy_file(from, to, fs::copy_options::overwrite_existing, ec) && !ec;
+}
+
+uintmax_t directoryBytes(const fs::path &path)
+{
+    uintmax_t bytes = 0;
+    std::error_code ec;
+    for(const auto &entry : fs::directory_iterator(path, ec)) {
+        uintmax_t size = entry.file_size(ec);
+        if(!ec)
+            bytes += size;
+    }
+    return bytes;
+}
+
+}
+
+MESHIO::Hash64::Hash64(uint64_t seed) : seed(seed)
+{
+    acc[0] = seed + P1 + P2;
+    acc[1] = seed + P2;
+    acc[2] = seed;
+    acc[3] = seed - P1;
+}
+
+void MESHIO::Hash64::update(const void *data, size_t size)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    total += size;
+    if(buffered + size < 32) {
+        memcpy(buffer + buffered, p, size);
+        buffered += size;
+        return;
+    }
+    if(buffered) {
+        const size_t fill = 32 - buffered;
+        memcpy(buffer + buffered, p, fill);
+        for(int k = 0; k < 4; k++)
+            acc[k] = round64(acc[k], read64(buffer + 8 * k));
+        p += fill;
+        size -= fill;
+        buffered = 0;
+    }
+    for(; size >= 32; p += 32, size -= 32)
+        for(int k = 0; k < 4; k++)
+            acc[k] = round64(acc[k], read64(p + 8 * k));
+    memcpy(buffer, p, size);
+    buffered = size;
+}
+
+uint64_t MESHIO::Hash64::digest() const
+{
+    uint64_t h;
+    if(total >= 32) {
+        h = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18);
+        for(int k = 0; k < 4; k++)
+            h = merge64(h, acc[k]);
+    } else {
+        h = seed + P5;
+    }
+    h += total;
+    const unsigned char *p = buffer;
+    size_t size = buffered;
+    for(; size >= 8; p += 8, size -= 8)
+        h = rotl(h ^ round64(0, read64(p)), 27) * P1 + P4;
+    if(size >= 4) {
+        h = rotl(h ^ (read32(p) * P1), 23) * P2 + P3;
+        p += 4;
+        size -= 4;
+    }
+    for(; size > 0; p++, size--)
+        h = rotl(h ^ (*p * P5), 11) * P1;
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+bool MESHIO::hashFile(const std::string &filename, uint64_t &hash)
+{
+    MESH_TRACE("hashFile", filename);
+    FILE *f = fopen(filename.c_str(), "rb");
+    if(!f)
+        return false;
+    Hash64 hasher;
+    std::vector<char> chunk(HASH_CHUNK);
+    size_t n;
+    while((n = fread(chunk.data(), 1, chunk.size(), f)) > 0)
+        hasher.update(chunk.data(), n);
+    bool ok = !ferror(f);
+    fclose(f);
+    hash = hasher.digest();
+    return ok;
+}
+
+bool MESHIO::cacheable(const ConvertOptions &opt)
+{
+    if(opt.reportInfo || opt.reportBoundary || opt.exportBoundary || opt.reportQuality || !opt.qualityJson.empty())
+        return false;
+    for(const std::string &op : opt.pipelineOps)
+        if(op == "info" || op == "boundary" || op == "quality")
+            return false;
+    return true;
+}
+
+MESHIO::ConvertCache::ConvertCache(const std::string &directory, double maxMB)
+    : directory(directory), maxBytes(maxMB * 1024.0 * 1024.0)
+{
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+}
+
+/**
+ * The input bytes, the eps file of -e, and every option in a fixed order: the same
+ * conversion of a renamed or copied input has the same key.
+ */
+std::string MESHIO::ConvertCache::key(const ConvertOptions &opt) const
+{
+    if(!cacheable(opt))
+        return "";
+    uint64_t inputHash = 0, epsHash = 0;
+    if(!hashFile(opt.input, inputHash))
+        return "";
+    if(opt.exportEpsVTK && !hashFile(opt.inputEx, epsHash))
+        return "";
+
+    std::stringstream flags;
+    flags.precision(17);
+    flags << "version " << CACHE_VERSION << "\ninput " << opt.input.substr(opt.input.find_last_of('.') + 1) << "\n";
+    if(opt.exportEpsVTK) flags << "eps " << hex64(epsHash) << "\n";
+    const pair<const char *, bool> switches[] = {
+        {"vtk", opt.exportVTK}, {"mesh", opt.exportMESH}, {"ply", opt.exportPLY}, {"pls", opt.exportPLS},
+        {"facet", opt.exportFacet}, {"obj", opt.exportOBJ}, {"mcb", opt.exportMCB}, {"surface", opt.surface}, {"reset-orient", opt.resetOrientation},
+        {"reverse-orient", opt.reverseOrient}, {"repair", opt.repair}, {"stream", opt.stream},
+        {"float32", opt.float32}, {"index64", opt.index64}, {"cells", opt.cells},
+        {"quality-cells", opt.qualityCells}, {"decimate-parallel", opt.decimateParallel}};
+    for(const auto &s : switches)
+        if(s.second)
+            flags << s.first << "\n";
+    auto numbers = [&](const char *name, const std::vector<double> &values) {
+        if(values.empty())
+            return;
+        flags << name;
+        for(double v : values)
+            flags << " " << v;
+        flags << "\n";
+    };
+    numbers("rotate", opt.rotateVec);
+    numbers("box", opt.boxVec);
+    for(const std::string &op : opt.transformOps)
+        flags << "transform " << op << "\n";
+    for(const std::string &op : opt.pipelineOps)
+        flags << "op " << op << "\n";
+    if(!opt.normals.empty())
+        flags << "normals " << opt.normals << "\n";
+    if(!opt.decimate.empty())
+        flags << "decimate " << opt.decimate << "\n";
+
+    const std::string text = flags.str();
+    Hash64 hasher;
+    hasher.update(text.data(), text.size());
+    return hex64(inputHash) + hex64(hasher.digest());
+}
+
+/**
+ * Materialize the outputs of a cached conversion next to the input.
+ * @return true on a hit.
+ */
+bool MESHIO::ConvertCache::fetch(const std::string &key, const std::string &outputBase, ConvertReport &report) const
+{
+    MESH_TRACE("cacheFetch", key);
+    const fs::path entry = fs::path(directory) / key;
+    std::ifstream manifest(entry / "entry");
+    if(!manifest.is_open())
+        return false;
+    ConvertReport hit;
+    std::string word, suffix;
+    std::vector<std::string> suffixes;
+    while(manifest >> word) {
+        if(word == "points") manifest >> hit.nPoints;
+        else if(word == "facets") manifest >> hit.nFacets;
+        else if(word == "output" && manifest >> suffix) suffixes.push_back(suffix);
+    }
+    for(size_t i = 0; i < suffixes.size(); i++) {
+        hit.outputs.push_back(outputBase + suffixes[i]);
+        if(!cloneFile((entry / ("out." + std::to_string(i))).string(), hit.outputs.back()))
+            return false;
+    }
+    // The modification time of the entry orders the eviction.
+    std::error_code ec;
+    fs::last_write_time(entry, fs::file_time_type::clock::now(), ec);
+    hit.stages = report.stages;
+    report = hit;
+    return true;
+}
+
+/**
+ * Copy the outputs of a finished conversion into a new entry, then evict.
+ * @return true when the entry was added.
+ */
+bool MESHIO::ConvertCache::store(const std::string &key, const std::string &outputBase, const ConvertReport &report) const
+{
+    MESH_TRACE("cacheStore", key);
+    std::stringstream unique;
+    unique << "tmp." << key << "." << getpid() << "." << std::this_thread::get_id();
+    const fs::path staging = fs::path(directory) / unique.str();
+    std::error_code ec;
+    fs::create_directories(staging, ec);
+    if(ec)
+        return false;
+
+    std::ofstream manifest(staging / "entry");
+    manifest << "points " << report.nPoints << "\nfacets " << report.nFacets << "\n";
+    bool ok = manifest.good();
+    for(size_t i = 0; ok && i < report.outputs.size(); i++) {
+        const std::string &output = report.outputs[i];
+        ok = output.compare(0, outputBase.size(), outputBase) == 0
+          && cloneFile(output, (staging / ("out." + std::to_string(i))).string());
+        manifest << "output " << output.substr(outputBase.size()) << "\n";
+    }
+    manifest.close();
+    // Another worker may have published the same key meanwhile; either copy is good.
+    if(ok) {
+        fs::rename(staging, fs::path(directory) / key, ec);
+        ok = !ec;
+    }
+    if(!ok)
+        fs::remove_all(staging, ec);
+    if(ok)
+        evict(key);
+    return ok;
+}
+
+// Remove the least recently used entries until the cache fits in its size.
+void MESHIO::ConvertCache::evict(const std::string &keep) const
+{
+    MESH_TRACE("cacheEvict");
+    struct Entry {
+        fs::path path;
+        fs::file_time_type used;
+        uintmax_t bytes;
+    };
+    std::vector<Entry> entries;
+    double total = 0.0;
+    std::error_code ec;
+    for(const auto &item : fs::directory_iterator(directory, ec)) {
+        const std::string name = item.path().filename().string();
+        if(!item.is_directory(ec) || name.compare(0, 4, "tmp.") == 0)
+            continue;
+        Entry e{item.path(), fs::last_write_time(item.path(), ec), directoryBytes(item.path())};
+        total += (double)e.bytes;
+        if(name != keep)
+            entries.push_back(e);
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.used < b.used; });
+    for(size_t i = 0; i < entries.size() && total > maxBytes; i++) {
+        fs::remove_all(entries[i].path, ec);
+        total -= (double)entries[i].bytes;
+    }
+}
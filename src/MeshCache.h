@@ -0,0 +1,55 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include "MeshConvert.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace MESHIO {
+
+	// XXH64, fed in pieces of any size. The same digest as the one-shot reference function.
+	class Hash64 {
+	public:
+		explicit Hash64(uint64_t seed = 0);
+		void update(const void *data, size_t size);
+		uint64_t digest() const;
+
+	private:
+		uint64_t acc[4];
+		unsigned char buffer[32];
+		size_t buffered = 0;
+		uint64_t total = 0;
+		uint64_t seed;
+	};
+
+	bool hashFile(const std::string &filename, uint64_t &hash);
+
+	/**
+	 * Results of earlier conversions, addressed by the hash of the input bytes and of the
+	 * options that change the outputs. Every entry is a directory <key>/ with the output
+	 * files and their names relative to the input; it is published by a rename, so batch
+	 * workers can share a cache. A hit clones (reflink) or copies the files in place of the
+	 * conversion. The least recently used entries go once the cache outgrows its size.
+	 */
+	class ConvertCache {
+	public:
+		ConvertCache(const std::string &directory, double maxMB);
+
+		// "" when the conversion can not be cached or the input can not be read.
+		std::string key(const ConvertOptions &opt) const;
+		bool fetch(const std::string &key, const std::string &outputBase, ConvertReport &report) const;
+		bool store(const std::string &key, const std::string &outputBase, const ConvertReport &report) const;
+		void evict(const std::string &keep) const;
+
+	private:
+		std::string directory;
+		double maxBytes;
+	};
+
+	// Report-only options print to the standard output, which a hit would not replay.
+	bool cacheable(const ConvertOptions &opt);
+};
+
+#endif
@@ -0,0 +1,492 @@
+#include "MeshCells.h"
+#include "MeshLayout.h"
+#include "MeshTrace.h"
+
+#include <algorithm>
+#include <climits>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+/**
+ * Read a cell block whose header line gave count and size. Version 2 files list every
+ * cell as "n i0 .. in-1"; version 5 files give count offsets then size corners in
+ * OFFSETS and CONNECTIVITY arrays. Cells get type 0 when polydata is false, CELL_TYPES
+ * follows then; polydata cells are typed from their keyword and size.
+ * @return number of cells read, -1 on a truncated block
+ */
+long readCellBlock(std::istream &in, long count, long size, const std::string &keyword, MESHIO::CellMesh &mesh, bool polydata)
+{
+    auto typeOf = [&](int n) -> uint8_t {
+        if(!polydata)
+            return 0;
+        if(keyword == "VERTICES")
+            return n == 1 ? MESHIO::CellVertex : MESHIO::CellPolyVertex;
+        if(keyword == "LINES")
+            return n == 2 ? MESHIO::CellLine : MESHIO::CellPolyLine;
+        if(keyword == "TRIANGLE_STRIPS")
+            return MESHIO::CellTriangleStrip;
+        return MESHIO::polygonType(n);
+    };
+    std::string word;
+    if(!(in >> word))
+        return -1;
+    if(word == "OFFSETS") {
+        std::string type;
+        getline(in, type);
+        const int64_t base = mesh.offsets.back();
+        std::vector<int64_t> offsets(std::max(count, 1L));
+        for(long i = 0; i < count; i++)
+            if(!(in >> offsets[i]))
+                return -1;
+        if(!(in >> word) || word != "CONNECTIVITY")
+            return -1;
+        getline(in, type);
+        const size_t first = mesh.connectivity.size();
+        mesh.connectivity.resize(first + size);
+        for(long j = 0; j < size; j++) {
+            int64_t v;
+            if(!(in >> v))
+                return -1;
+            mesh.connectivity[first + j] = (int)v;
+        }
+        for(long i = 1; i < count; i++) {
+            mesh.offsets.push_back(base + offsets[i]);
+            mesh.types.push_back(typeOf((int)(offsets[i] - offsets[i - 1])));
+        }
+        return std::max(count - 1, 0L);
+    }
+    mesh.connectivity.reserve(mesh.connectivity.size() + size - count);
+    for(long i = 0; i < count; i++) {
+        int n;
+        if(i == 0)
+            n = stoi(word);
+        else if(!(in >> n))
+            return -1;
+        for(int j = 0; j < n; j++) {
+            int v;
+            if(!(in >> v))
+                return -1;
+            mesh.connectivity.push_back(v);
+        }
+        mesh.offsets.push_back((int64_t)mesh.connectivity.size());
+        mesh.types.push_back(typeOf(n));
+    }
+    return count;
+}
+
+// Triangles a cell splits into.
+long triangleCount(uint8_t type, int n)
+{
+    return MESHIO::isSurfaceCell(type) && n >= 3 ? n - 2 : 0;
+}
+
+/**
+ * Call face(corners, n) for every polygon of a surface cell: itself, the triangles of a
+ * strip, a pixel in polygon order.
+ */
+template<class Face>
+void cellFaces(const MESHIO::CellMesh &mesh, long i, Face face)
+{
+    const int *c = mesh.cell(i);
+    const int n = mesh.cellSize(i);
+    if(mesh.types[i] == MESHIO::CellTriangleStrip) {
+        for(int k = 0; k + 2 < n; k++) {
+            const int tri[3] = {c[k + (k & 1)], c[k + 1 - (k & 1)], c[k + 2]};
+            face(tri, 3);
+        }
+    }
+    else if(mesh.types[i] == MESHIO::CellPixel && n == 4) {
+        const int quad[4] = {c[0], c[1], c[3], c[2]};
+        face(quad, 4);
+    }
+    else if(MESHIO::isSurfaceCell(mesh.types[i])) {
+        face(c, n);
+    }
+}
+
+long faceCount(const MESHIO::CellMesh &mesh)
+{
+    long count = 0;
+    for(long i = 0; i < mesh.nCells(); i++)
+        if(MESHIO::isSurfaceCell(mesh.types[i]))
+            count += mesh.types[i] == MESHIO::CellTriangleStrip ? std::max(mesh.cellSize(i) - 2, 0) : 1;
+    return count;
+}
+
+}
+
+uint8_t MESHIO::polygonType(int n)
+{
+    if(n == 1)
+        return CellVertex;
+    if(n == 2)
+        return CellLine;
+    if(n == 3)
+        return CellTriangle;
+    if(n == 4)
+        return CellQuad;
+    return CellPolygon;
+}
+
+bool MESHIO::isSurfaceCell(uint8_t type)
+{
+    return type == CellTriangle || type == CellTriangleStrip || type == CellPolygon || type == CellPixel || type == CellQuad;
+}
+
+void MESHIO::CellMesh::addCell(uint8_t type, const int *corners, int n)
+{
+    connectivity.insert(connectivity.end(), corners, corners + n);
+    offsets.push_back((int64_t)connectivity.size());
+    types.push_back(type);
+}
+
+int MESHIO::CellMesh::uniformSize() const
+{
+    if(nCells() == 0)
+        return 0;
+    const int n = cellSize(0);
+    for(long i = 1; i < nCells(); i++)
+        if(cellSize(i) != n)
+            return 0;
+    return n;
+}
+
+/**
+ * Read a legacy VTK file, POLYDATA or UNSTRUCTURED_GRID, version 2 or 5, keeping every
+ * cell with its own number of corners and type.
+ * @param filename
+ * @param mesh
+ * @param mark_pattern name of the CELL_DATA scalars holding the markers, every other
+ *        CELL_DATA and POINT_DATA array goes to mesh.attributes.
+ * @return 1/-1
+ */
+int MESHIO::readVTK(const std::string &filename, CellMesh &mesh, const std::string &mark_pattern)
+{
+    std::ifstream vtk_file(filename);
+    if(!vtk_file.is_open()) {
+        std::cout << "No such file. - " << filename << std::endl;
+        return -1;
+    }
+    return MESHIO::readVTK(vtk_file, mesh, mark_pattern, filename);
+}
+
+int MESHIO::readVTK(std::istream &in, CellMesh &mesh, const std::string &mark_pattern, const std::string &filename)
+{
+    MESH_TRACE("readVTKCells");
+    mesh = CellMesh();
+    bool polydata = false;
+    bool onPoints = false;
+    long dataRows = -1;  // rows of the arrays of the current CELL_DATA or POINT_DATA
+    std::string line;
+    while(getline(in, line)) {
+        if(line.length() < 2 || line[0] == '#')
+            continue;
+        std::stringstream words(line);
+        std::string keyword;
+        words >> keyword;
+        if(keyword == "DATASET") {
+            std::string type;
+            words >> type;
+            polydata = (type == "POLYDATA");
+            if(!polydata && type != "UNSTRUCTURED_GRID") {
+                std::cout << "The format of VTK file is illegal, No clear DATASET name. - " << filename << std::endl;
+                return -1;
+            }
+        }
+        else if(keyword == "POINTS") {
+            long nPoints = 0;
+            words >> nPoints;
+            if(nPoints > INT_MAX) {
+                std::cout << "Too many points for 32-bit indices (" << nPoints << "). - " << filename << std::endl;
+                return -1;
+            }
+            mesh.V.resize(nPoints, 3);
+            for(long i = 0; i < nPoints; i++)
+                in >> mesh.V(i, 0) >> mesh.V(i, 1) >> mesh.V(i, 2);
+        }
+        else if((!polydata && keyword == "CELLS") || (polydata && (keyword == "VERTICES" || keyword == "LINES"
+                || keyword == "POLYGONS" || keyword == "TRIANGLE_STRIPS"))) {
+            long count = 0, size = 0;
+            words >> count >> size;
+            if(readCellBlock(in, count, size, keyword, mesh, polydata) < 0) {
+                std::cout << "The format of VTK file is illegal, truncated " << keyword << ". - " << filename << std::endl;
+                return -1;
+            }
+        }
+        else if(keyword == "CELL_TYPES") {
+            long count = 0;
+            words >> count;
+            if(count != mesh.nCells()) {
+                std::cout << "The number of CELL_TYPES is not equal to number of cells. - " << filename << std::endl;
+                return -1;
+            }
+            for(long i = 0; i < count; i++) {
+                int type;
+                in >> type;
+                mesh.types[i] = (uint8_t)type;
+            }
+        }
+        else if(keyword == "CELL_DATA" || keyword == "POINT_DATA") {
+            words >> dataRows;
+            onPoints = (keyword == "POINT_DATA");
+            if(dataRows != (onPoints ? mesh.V.rows() : mesh.nCells())) {
+                std::cout << "The number of " << keyword << " is not equal to number of " << (onPoints ? "points" : "cells") << ". - " << filename;
+                std::cout << " Ignore " << keyword << std::endl;
+                dataRows = -1;
+            }
+        }
+        else if(dataRows >= 0) {
+            std::string name;
+            words >> name;
+            if(keyword == "SCALARS" && !onPoints && !mark_pattern.empty() && name == mark_pattern) {
+                getline(in, line);  // LOOKUP_TABLE
+                mesh.M.resize(mesh.nCells(), 1);
+                for(long i = 0; i < mesh.nCells(); i++)
+                    in >> mesh.M(i, 0);
+            }
+            else if(readVTKArray(in, line, onPoints, dataRows, mesh.attributes) < 0) {
+                std::cout << "The format of VTK file is illegal, truncated " << keyword << ". - " << filename << std::endl;
+                return -1;
+            }
+        }
+    }
+    if(std::find(mesh.types.begin(), mesh.types.end(), 0) != mesh.types.end()) {
+        std::cout << "The format of VTK file is illegal, No CELL_TYPES. - " << filename << std::endl;
+        return -1;
+    }
+    return 1;
+}
+
+/**
+ * Write an UNSTRUCTURED_GRID with every cell as it is, markers and cell attributes as
+ * CELL_DATA, point attributes as POINT_DATA.
+ * @return 1/-1
+ */
+int MESHIO::writeVTK(const std::string &filename, const CellMesh &mesh, const std::string &mark_pattern)
+{
+    std::ofstream f(filename);
+    if(!f.is_open()) {
+        std::cout << "Can not open " << filename << std::endl;
+        return -1;
+    }
+    return MESHIO::writeVTK(f, mesh, mark_pattern);
+}
+
+int MESHIO::writeVTK(std::ostream &f, const CellMesh &mesh, const std::string &mark_pattern)
+{
+    MESH_TRACE("writeVTKCells");
+    f.precision(Kernels::outputPrecision<double>());
+    f << "# vtk DataFile Version 2.0" << std::endl;
+    f << "TetWild Mesh" << std::endl;
+    f << "ASCII" << std::endl;
+    f << "DATASET UNSTRUCTURED_GRID" << std::endl;
+    f << "POINTS " << mesh.V.rows() << " double" << std::endl;
+    for(long i = 0; i < mesh.V.rows(); i++)
+        f << mesh.V(i, 0) << " " << mesh.V(i, 1) << " " << mesh.V(i, 2) << std::endl;
+    f << "CELLS " << mesh.nCells() << " " << mesh.nCells() + mesh.offsets.back() << std::endl;
+    for(long i = 0; i < mesh.nCells(); i++) {
+        f << mesh.cellSize(i) << " ";
+        for(int64_t j = mesh.offsets[i]; j < mesh.offsets[i + 1]; j++)
+            f << mesh.connectivity[j] << " ";
+        f << std::endl;
+    }
+    f << "CELL_TYPES " << mesh.nCells() << std::endl;
+    for(long i = 0; i < mesh.nCells(); i++)
+        f << (int)mesh.types[i] << std::endl;
+    if(mesh.M.rows() == mesh.nCells() && mesh.nCells() > 0) {
+        f << "CELL_DATA " << mesh.M.rows() << std::endl;
+        f << "SCALARS " << mark_pattern << " int " << mesh.M.cols() << std::endl;
+        f << "LOOKUP_TABLE default" << std::endl;
+        for(long i = 0; i < mesh.M.rows(); i++) {
+            for(long j = 0; j < mesh.M.cols(); j++)
+                f << mesh.M(i, j);
+            f << std::endl;
+        }
+        f << std::endl;
+    }
+    MESHIO::writeVTKArrays(f, mesh.attributes, mesh.V.rows(), mesh.nCells(), mesh.M.rows() == mesh.nCells() && mesh.nCells() > 0);
+    return f ? 1 : -1;
+}
+
+int MESHIO::writePLY(const std::string &filename, const CellMesh &mesh)
+{
+    std::ofstream f(filename);
+    if(!f.is_open()) {
+        std::cout << "Can not open " << filename << std::endl;
+        return -1;
+    }
+    return MESHIO::writePLY(f, mesh);
+}
+
+int MESHIO::writePLY(std::ostream &plyfile, const CellMesh &mesh)
+{
+    MESH_TRACE("writePLYCells");
+    plyfile.precision(Kernels::outputPrecision<double>());
+    plyfile << "ply" << std::endl;
+    plyfile << "format ascii 1.0" << std::endl;
+    plyfile << "comment VTK generated PLY File" << std::endl;
+    plyfile << "obj_info vtkPolyData points and polygons: vtk4.0" << std::endl;
+    plyfile << "element vertex " << mesh.V.rows() << std::endl;
+    plyfile << "property float x" << std::endl;
+    plyfile << "property float y" << std::endl;
+    plyfile << "property float z" << std::endl;
+    plyfile << "element face " << faceCount(mesh) << std::endl;
+    plyfile << "property list uchar int vertex_indices" << std::endl;
+    plyfile << "end_header" << std::endl;
+    for(long i = 0; i < mesh.V.rows(); i++)
+        plyfile << mesh.V(i, 0) << " " << mesh.V(i, 1) << " " << mesh.V(i, 2) << std::endl;
+    for(long i = 0; i < mesh.nCells(); i++) {
+        cellFaces(mesh, i, [&](const int *c, int n) {
+            plyfile << n;
+            for(int j = 0; j < n; j++)
+                plyfile << " " << c[j];
+            plyfile << std::endl;
+        });
+    }
+    return plyfile ? 1 : -1;
+}
+
+int MESHIO::writeOBJ(const std::string &filename, const CellMesh &mesh)
+{
+    std::ofstream f(filename);
+    if(!f.is_open()) {
+        std::cout << "Can not open " << filename << std::endl;
+        return -1;
+    }
+    return MESHIO::writeOBJ(f, mesh);
+}
+
+/**
+ * Write the surface cells as OBJ faces of any size, grouped by marker like the facet
+ * writer does.
+ * @return 1/-1
+ */
+int MESHIO::writeOBJ(std::ostream &objFile, const CellMesh &mesh)
+{
+    MESH_TRACE("writeOBJCells");
+    const bool doGroup = (mesh.M.rows() == mesh.nCells() && mesh.nCells() > 0);
+    std::vector<long> order(mesh.nCells());
+    for(long i = 0; i < mesh.nCells(); i++)
+        order[i] = i;
+    if(doGroup)
+        std::stable_sort(order.begin(), order.end(), [&](long a, long b) { return mesh.M(a, 0) < mesh.M(b, 0); });
+
+    objFile.precision(Kernels::outputPrecision<double>());
+    char stime[256] = {0};
+    time_t now_time;
+    time(&now_time);
+    strftime(stime, sizeof(stime), "%H:%M:%S", localtime(&now_time));
+    objFile << "# TIGER Mesh converter. (c) 2021." << std::endl;
+    objFile << "# Created File: " << stime << std::endl;
+    objFile << "# " << std::endl;
+    objFile << "# object default" << std::endl;
+    objFile << "# " << std::endl;
+    objFile << std::endl;
+    for(long i = 0; i < mesh.V.rows(); i++)
+        objFile << "v " << mesh.V(i, 0) << " " << mesh.V(i, 1) << " " << mesh.V(i, 2) << std::endl;
+    objFile << "# " << mesh.V.rows() << " vertices" << std::endl << std::endl;
+
+    int curGroup = INT_MIN;
+    for(long i : order) {
+        if(doGroup && mesh.M(i, 0) != curGroup) {
+            curGroup = mesh.M(i, 0);
+            objFile << "g " << curGroup << std::endl;
+        }
+        cellFaces(mesh, i, [&](const int *c, int n) {
+            objFile << "f";
+            for(int j = 0; j < n; j++)
+                objFile << " " << c[j] + 1;
+            objFile << std::endl;
+        });
+    }
+    objFile << "# " << faceCount(mesh) << " faces" << std::endl << std::endl;
+    return objFile ? 1 : -1;
+}
+
+/**
+ * Split the surface cells into triangles: polygons, quads and pixels as fans from their
+ * first corner, strips into their triangles. Every cell writes to its own range of T,
+ * found by a prefix sum of the triangle counts, so the cells split in parallel. Volume,
+ * line and vertex cells are left out.
+ * @param mesh
+ * @param T triangles, in cell order.
+ * @param M marker of the cell of every triangle, no rows when the cells have none.
+ * @param cellOfTriangle optional, the cell every triangle comes from, to carry the cell
+ *        attributes over with gatherCells.
+ * @return number of triangles
+ */
+long MESHIO::triangulate(const CellMesh &mesh, Eigen::MatrixXi &T, Eigen::MatrixXi &M, std::vector<long> *cellOfTriangle)
+{
+    MESH_TRACE("triangulate");
+    const long nCells = mesh.nCells();
+    std::vector<long> first(nCells + 1, 0);
+    for(long i = 0; i < nCells; i++)
+        first[i + 1] = first[i] + triangleCount(mesh.types[i], mesh.cellSize(i));
+    const long nTriangles = first[nCells];
+    const bool marked = (mesh.M.rows() == nCells && nCells > 0);
+    T.resize(nTriangles, 3);
+    M.resize(marked ? nTriangles : 0, marked ? mesh.M.cols() : 1);
+    if(cellOfTriangle)
+        cellOfTriangle->resize(nTriangles);
+
+#pragma omp parallel for schedule(static)
+    for(long i = 0; i < nCells; i++) {
+        long t = first[i];
+        const int *c = mesh.cell(i);
+        const int n = mesh.cellSize(i);
+        if(mesh.types[i] == CellTriangleStrip) {
+            for(int k = 0; k + 2 < n; k++, t++) {
+                T(t, 0) = c[k + (k & 1)];
+                T(t, 1) = c[k + 1 - (k & 1)];
+                T(t, 2) = c[k + 2];
+            }
+        }
+        else if(mesh.types[i] == CellPixel && n == 4) {
+            T(t, 0) = c[0]; T(t, 1) = c[1]; T(t, 2) = c[3];
+            T(t + 1, 0) = c[0]; T(t + 1, 1) = c[3]; T(t + 1, 2) = c[2];
+        }
+        else if(first[i + 1] > t) {
+            for(int k = 1; k + 1 < n; k++, t++) {
+                T(t, 0) = c[0];
+                T(t, 1) = c[k];
+                T(t, 2) = c[k + 1];
+            }
+        }
+        if(marked)
+            for(long r = first[i]; r < first[i + 1]; r++)
+                M.row(r) = mesh.M.row(i);
+        if(cellOfTriangle)
+            std::fill(cellOfTriangle->begin() + first[i], cellOfTriangle->begin() + first[i + 1], i);
+    }
+
+    long dropped = 0;
+    for(long i = 0; i < nCells; i++)
+        dropped += !isSurfaceCell(mesh.types[i]);
+    if(dropped > 0)
+        std::cout << "Left out " << dropped << " cells that are not polygons." << std::endl;
+    return nTriangles;
+}
+
+void MESHIO::toCells(const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M, CellMesh &mesh)
+{
+    mesh = CellMesh();
+    mesh.V = V;
+    const int n = (int)T.cols();
+    const uint8_t type = (n == 4) ? (uint8_t)CellTetra : polygonType(n);
+    mesh.connectivity.resize(T.size());
+    mesh.offsets.resize(T.rows() + 1);
+    mesh.types.assign(T.rows(), type);
+    for(long i = 0; i < T.rows(); i++) {
+        for(int j = 0; j < n; j++)
+            mesh.connectivity[i * n + j] = T(i, j);
+        mesh.offsets[i + 1] = (int64_t)(i + 1) * n;
+    }
+    if(M.rows() == T.rows())
+        mesh.M = M;
+}
@@ -0,0 +1,63 @@
+#ifndef MESH_CELLS_H
+#define MESH_CELLS_H
+
+#include "MeshAttributes.h"
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace MESHIO {
+
+	// VTK cell type numbers, as in CELL_TYPES.
+	enum CellType : uint8_t {
+		CellVertex = 1, CellPolyVertex = 2, CellLine = 3, CellPolyLine = 4, CellTriangle = 5,
+		CellTriangleStrip = 6, CellPolygon = 7, CellPixel = 8, CellQuad = 9, CellTetra = 10,
+		CellVoxel = 11, CellHexahedron = 12, CellWedge = 13, CellPyramid = 14
+	};
+
+	// Type of a POLYDATA cell of n corners, which the file does not state.
+	uint8_t polygonType(int n);
+	// Triangles, strips, polygons, pixels and quads: the cells triangulate() splits.
+	bool isSurfaceCell(uint8_t type);
+
+	/**
+	 * A mesh whose cells may have any number of corners, stored like VTK does: cell i is
+	 * connectivity[offsets[i]] .. connectivity[offsets[i + 1] - 1], of VTK type types[i].
+	 * The Eigen::MatrixXi facets of the rest of MESHIO hold one cell size only; this keeps
+	 * triangles, quads, polygons and volume cells side by side.
+	 */
+	struct CellMesh {
+		Eigen::MatrixXd V;
+		std::vector<int64_t> offsets{0};   // nCells() + 1 entries
+		std::vector<int> connectivity;
+		std::vector<uint8_t> types;
+		Eigen::MatrixXi M;                 // one marker per cell, or no rows
+		MeshAttributes attributes;         // the other CELL_DATA and POINT_DATA arrays
+
+		long nCells() const { return (long)types.size(); }
+		int cellSize(long i) const { return (int)(offsets[i + 1] - offsets[i]); }
+		const int *cell(long i) const { return connectivity.data() + offsets[i]; }
+		void addCell(uint8_t type, const int *corners, int n);
+		// Corners of every cell when they all have the same number, 0 for mixed cells.
+		int uniformSize() const;
+	};
+
+	int readVTK(const std::string &filename, CellMesh &mesh, const std::string &mark_pattern = "");
+	int readVTK(std::istream &in, CellMesh &mesh, const std::string &mark_pattern = "", const std::string &filename = "");
+	int writeVTK(const std::string &filename, const CellMesh &mesh, const std::string &mark_pattern = "");
+	int writeVTK(std::ostream &out, const CellMesh &mesh, const std::string &mark_pattern = "");
+	// Surface cells as polygon faces, other cells are left out.
+	int writePLY(const std::string &filename, const CellMesh &mesh);
+	int writePLY(std::ostream &out, const CellMesh &mesh);
+	int writeOBJ(const std::string &filename, const CellMesh &mesh);
+	int writeOBJ(std::ostream &out, const CellMesh &mesh);
+
+	long triangulate(const CellMesh &mesh, Eigen::MatrixXi &T, Eigen::MatrixXi &M, std::vector<long> *cellOfTriangle = nullptr);
+	// Cells of the uniform facets T, typed by their number of corners like writeVTK does.
+	void toCells(const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M, CellMesh &mesh);
+};
+
+#endif
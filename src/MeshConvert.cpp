@@ -0,0 +1,554 @@
+#include "MeshConvert.h"
+#include "meshIO.h"
+#include "MeshStream.h"
+#include "MeshPipeline.h"
+#include "MeshTrace.h"
+#include "MeshCache.h"
+#include "MeshBinary.h"
+#include "MeshLayout.h"
+#include "MeshInspect.h"
+#include "MeshCells.h"
+#include "MeshNormals.h"
+#include "MeshQuality.h"
+
+#include <chrono>
+#include <climits>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+
+std::string fileExtension(const std::string &filename)
+{
+    size_t dotpos = filename.find_last_of('.');
+    return dotpos == std::string::npos ? "" : filename.substr(dotpos + 1);
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Make room for row i, doubling when the format did not state the count.
+template<class Matrix>
+void reserveRow(Matrix &A, long i, long cols)
+{
+    if(i >= A.rows())
+        A.conservativeResize(std::max(2 * A.rows(), 1024L), cols);
+}
+
+// readMesh into any point precision and index width, through the stream readers.
+// attributes, when given, receive the point and cell arrays of the file.
+template<class MV, class MT>
+int readChunked(const std::string &filename, MV &V, MT &T, Eigen::MatrixXi &M, MESHIO::MeshAttributes *attributes = nullptr)
+{
+    typedef typename MV::Scalar Scalar;
+    typedef typename MT::Scalar Index;
+    MESH_TRACE("readChunked", filename);
+    const long chunkSize = 1 << 16;
+    const string format = fileExtension(filename);
+    if(format == "mcb") {
+        if(MESHIO::readMCB(filename, V, T, M) < 0)
+            return -1;
+        MESHIO::MappedMesh mesh;
+        if(attributes && mesh.open(filename) > 0)
+            mesh.readAttributes(*attributes);
+        return 1;
+    }
+    std::unique_ptr<MESHIO::MeshStreamReader> reader = MESHIO::makeStreamReader(format);
+    if(!reader) {
+        cout << "Unsupported input format - " << format << endl;
+        return -1;
+    }
+    if(!reader->open(filename))
+        return -1;
+
+    std::vector<double> points;
+    long nPoints = 0;
+    V.resize(std::max(reader->nPoints, 0L), 3);
+    for(long n; (n = reader->readPoints(points, chunkSize)) > 0;) {
+        for(long k = 0; k < n; k++, nPoints++) {
+            reserveRow(V, nPoints, 3);
+            V.row(nPoints) << (Scalar)points[3 * k], (Scalar)points[3 * k + 1], (Scalar)points[3 * k + 2];
+        }
+    }
+
+    if(sizeof(Index) < 8 && nPoints > INT_MAX) {
+        cout << "More points than int indices address, read into MatrixXl. - " << filename << endl;
+        return -1;
+    }
+
+    if(!reader->beginFacets())
+        return -1;
+    std::vector<int64_t> facets;
+    std::vector<int> marks;
+    const int nCorner = reader->nCorner;
+    long nFacets = 0;
+    T.resize(std::max(reader->nFacets, 0L), nCorner);
+    M.resize(reader->hasMarks ? T.rows() : 0, 1);
+    for(long n; (n = reader->readFacets(facets, marks, chunkSize)) > 0;) {
+        for(long k = 0; k < n; k++, nFacets++) {
+            reserveRow(T, nFacets, nCorner);
+            for(int j = 0; j < nCorner; j++)
+                T(nFacets, j) = (Index)facets[k * nCorner + j];
+            if(reader->hasMarks) {
+                reserveRow(M, nFacets, 1);
+                M(nFacets, 0) = marks[k];
+            }
+        }
+    }
+    if((reader->nPoints >= 0 && nPoints != reader->nPoints) || (reader->nFacets >= 0 && nFacets != reader->nFacets)) {
+        cout << "The mesh file is truncated. - " << filename << endl;
+        return -1;
+    }
+    if(attributes && reader->readAttributes(*attributes) < 0)
+        return -1;
+    V.conservativeResize(nPoints, 3);
+    T.conservativeResize(nFacets, nCorner);
+    // Without markers, like readVTK when no marker name is given.
+    if(reader->hasMarks)
+        M.conservativeResize(nFacets, 1);
+    else
+        M = Eigen::MatrixXi::Zero(1, 1);
+    return 1;
+}
+
+/**
+ * Write one format through the layout-generic writers.
+ * @return 1/-1
+ */
+template<class Write>
+int writeStream(const std::string &filename, Write write)
+{
+    std::ofstream f(filename);
+    if(!f.is_open()) {
+        cout << "Write file failed. - " << filename << endl;
+        return -1;
+    }
+    cout << "Writing mesh to - " << filename << endl;
+    return write(f);
+}
+
+// processMesh for any point precision and index width but the default double and int.
+template<class MV, class MT>
+int processGeneric(const MESHIO::ConvertOptions &opt, MV &V, MT &F, Eigen::MatrixXi &M, MESHIO::ConvertReport &rep,
+                   const MESHIO::MeshAttributes &attributes = {})
+{
+    using namespace MESHIO;
+    const string output_base = opt.outputBase();
+    if(opt.exportEpsVTK || !opt.normals.empty() || opt.qualityCells) {
+        cout << (opt.exportEpsVTK ? "-e" : !opt.normals.empty() ? "--normals" : "--quality-cells") << " is not supported with --float32 or 64-bit indices." << endl;
+        return -1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<MESHIO::PipelineStage> stages;
+    if(!MESHIO::buildPipeline(opt, stages, &rep.outputs))
+        return -1;
+    if(MESHIO::runPipeline(MESHIO::fusePipeline(stages), V, F, M, &rep.stages) < 0)
+        return -1;
+    rep.operationSeconds = secondsSince(start);
+    rep.nPoints = V.rows();
+    rep.nFacets = F.rows();
+
+    start = std::chrono::steady_clock::now();
+    int result = 1;
+    MESHIO::StageTimer timer;
+    auto write = [&](bool enabled, const char *format, std::function<int(std::ostream &)> writer) {
+        if(!enabled)
+            return;
+        rep.outputs.push_back(output_base + ".o." + format);
+        result = min(result, writeStream(rep.outputs.back(), writer));
+        rep.stages.push_back(timer.finish(string("write:") + format, V.rows() + F.rows(), 0, MESHIO::fileBytes(rep.outputs.back())));
+        timer = MESHIO::StageTimer();
+    };
+    write(opt.exportVTK, "vtk", [&](std::ostream &f) {
+        Kernels::writeVTK(f, V, F, M);
+        return MESHIO::writeVTKArrays(f, attributes, V.rows(), F.rows(), M.rows() == F.rows());
+    });
+    write(opt.exportMESH, "mesh", [&](std::ostream &f) { return Kernels::writeMESH(f, V, F); });
+    write(opt.exportPLY, "ply", [&](std::ostream &f) { return Kernels::writePLY(f, V, F); });
+    write(opt.exportPLS, "pls", [&](std::ostream &f) { return Kernels::writePLS(f, V, F, M); });
+    write(opt.exportFacet, "facet", [&](std::ostream &f) { return Kernels::writeFacet(f, V, F, M); });
+    write(opt.exportOBJ, "obj", [&](std::ostream &f) { return Kernels::writeOBJ(f, V, F, M); });
+    if(opt.exportMCB) {
+        rep.outputs.push_back(output_base + ".o.mcb");
+        result = min(result, MESHIO::writeMCB(rep.outputs.back(), V, F, M, attributes));
+        rep.stages.push_back(timer.finish("write:mcb", V.rows() + F.rows(), 0, MESHIO::fileBytes(rep.outputs.back())));
+    }
+    rep.writeSeconds = secondsSince(start);
+    return result;
+}
+
+// Read, then processGeneric: the conversion of --float32 and of meshes past 2^31 points.
+template<class Scalar, class Index>
+int convertGeneric(const MESHIO::ConvertOptions &opt, MESHIO::ConvertReport &rep)
+{
+    typename MESHIO::LayoutTypes<MESHIO::MeshLayout::SoA, Scalar, Index>::Points V;
+    typename MESHIO::LayoutTypes<MESHIO::MeshLayout::SoA, Scalar, Index>::Facets F;
+    Eigen::MatrixXi M;
+    MESHIO::MeshAttributes attributes;
+    auto start = std::chrono::steady_clock::now();
+    MESHIO::StageTimer timer;
+    if(readChunked(opt.input, V, F, M, &attributes) < 0)
+        return -1;
+    rep.readSeconds = secondsSince(start);
+    const string suffix = string(sizeof(Scalar) < 8 ? ":f32" : "") + (sizeof(Index) == 8 ? ":i64" : "");
+    rep.stages.push_back(timer.finish("parse:" + fileExtension(opt.input) + suffix, V.rows() + F.rows(), MESHIO::fileBytes(opt.input)));
+    return processGeneric(opt, V, F, M, rep, attributes);
+}
+
+/**
+ * --cells: read VTK cells of any size and write them as they are to VTK, PLY and OBJ. The
+ * formats that only hold one facet size get the cells split into triangles.
+ */
+int convertCells(const MESHIO::ConvertOptions &opt, MESHIO::ConvertReport &rep)
+{
+    const string output_base = opt.outputBase();
+    if(fileExtension(opt.input) != "vtk") {
+        cout << "--cells reads VTK files only. - " << opt.input << endl;
+        return -1;
+    }
+    MESHIO::CellMesh cells;
+    auto start = std::chrono::steady_clock::now();
+    MESHIO::StageTimer timer;
+    if(MESHIO::readVTK(opt.input, cells) < 0)
+        return -1;
+    rep.readSeconds = secondsSince(start);
+    rep.nPoints = cells.V.rows();
+    rep.nFacets = cells.nCells();
+    rep.stages.push_back(timer.finish("parse:vtk:cells", rep.nPoints + rep.nFacets, MESHIO::fileBytes(opt.input)));
+
+    start = std::chrono::steady_clock::now();
+    int result = 1;
+    timer = MESHIO::StageTimer();
+    auto write = [&](bool enabled, const char *format, std::function<int(const string &)> writer) {
+        if(!enabled)
+            return;
+        rep.outputs.push_back(output_base + ".o." + format);
+        result = min(result, writer(rep.outputs.back()));
+        rep.stages.push_back(timer.finish(string("write:") + format, rep.nPoints + rep.nFacets, 0, MESHIO::fileBytes(rep.outputs.back())));
+        timer = MESHIO::StageTimer();
+    };
+    write(opt.exportVTK, "vtk", [&](const string &file) { return MESHIO::writeVTK(file, cells); });
+    write(opt.exportPLY, "ply", [&](const string &file) { return MESHIO::writePLY(file, cells); });
+    write(opt.exportOBJ, "obj", [&](const string &file) { return MESHIO::writeOBJ(file, cells); });
+    if(opt.exportMESH || opt.exportPLS || opt.exportFacet || opt.exportMCB) {
+        Eigen::MatrixXi T, M;
+        std::vector<long> cellOfTriangle;
+        MESHIO::triangulate(cells, T, M, &cellOfTriangle);
+        MESHIO::gatherCells(cells.attributes, cellOfTriangle);
+        rep.stages.push_back(timer.finish("triangulate", T.rows()));
+        timer = MESHIO::StageTimer();
+        write(opt.exportMESH, "mesh", [&](const string &file) { return MESHIO::writeMESH(file, cells.V, T); });
+        write(opt.exportPLS, "pls", [&](const string &file) { return MESHIO::writePLS(file, cells.V, T, M); });
+        write(opt.exportFacet, "facet", [&](const string &file) { return MESHIO::writeFacet(file, cells.V, T, M); });
+        write(opt.exportMCB, "mcb", [&](const string &file) { return MESHIO::writeMCB(file, cells.V, T, M, cells.attributes); });
+    }
+    rep.writeSeconds = secondsSince(start);
+    return result;
+}
+
+}
+
+bool MESHIO::ConvertOptions::hasOperation() const
+{
+    return !rotateVec.empty() || !boxVec.empty() || !transformOps.empty() || !pipelineOps.empty() || surface || resetOrientation || reverseOrient || repair
+        || !decimate.empty()
+        || reportInfo || reportBoundary || exportBoundary || exportEpsVTK || !normals.empty() || reportQuality || !qualityJson.empty()
+        || qualityCells;
+}
+
+std::string MESHIO::ConvertOptions::outputBase() const
+{
+    return input.substr(0, input.find_last_of('.'));
+}
+
+/**
+ * Read a mesh, the format is given by the file extension.
+ * @return 1 on success, -1 on failure or unsupported format.
+ */
+int MESHIO::readMesh(const std::string &filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M)
+{
+    size_t input_dotpos = filename.find_last_of('.');
+    string input_postfix = input_dotpos == string::npos ? "" : filename.substr(input_dotpos + 1);
+
+    if(input_postfix == "vtk")
+        return MESHIO::readVTK(filename, V, T, M);
+    else if(input_postfix == "mesh")
+        return MESHIO::readMESH(filename, V, T, M);
+    else if(input_postfix == "pls")
+        return MESHIO::readPLS(filename, V, T, M);
+    else if(input_postfix == "obj")
+        return MESHIO::readOBJ(filename, V, T, M);
+    else if(input_postfix == "mcb")
+        return MESHIO::readMCB(filename, V, T, M);
+    cout << "Unsupported input format - " << input_postfix << endl;
+    return -1;
+}
+
+/**
+ * readMesh that also keeps the point and cell arrays of the file (VTK CELL_DATA and
+ * POINT_DATA, .mcb attributes); formats without any leave attributes empty.
+ * @return 1/-1
+ */
+int MESHIO::readMesh(const std::string &filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, MeshAttributes &attributes)
+{
+    attributes.clear();
+    if(fileExtension(filename) == "vtk")
+        return MESHIO::readVTK(filename, V, T, M, attributes);
+    if(fileExtension(filename) == "mcb")
+        return MESHIO::readMCB(filename, V, T, M, attributes);
+    return MESHIO::readMesh(filename, V, T, M);
+}
+
+/**
+ * Read a mesh with single precision points (--float32) or 64-bit indices. The text formats
+ * are parsed a chunk at a time straight into V and T, so no double or int copy is ever held.
+ * @return 1 on success, -1 on failure or unsupported format.
+ */
+int MESHIO::readMesh(const std::string &filename, Eigen::MatrixXf &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M)
+{
+    return readChunked(filename, V, T, M);
+}
+
+int MESHIO::readMesh(const std::string &filename, Eigen::MatrixXd &V, MatrixXl &T, Eigen::MatrixXi &M)
+{
+    return readChunked(filename, V, T, M);
+}
+
+int MESHIO::readMesh(const std::string &filename, Eigen::MatrixXf &V, MatrixXl &T, Eigen::MatrixXi &M)
+{
+    return readChunked(filename, V, T, M);
+}
+
+/**
+ * Whether the points of a file are too many for int indices. Only a file of at least 6
+ * bytes a point can be, so the headers are only inspected past 12 GB.
+ */
+bool MESHIO::needsIndex64(const std::string &filename)
+{
+    if(MESHIO::fileBytes(filename) < 6L * INT_MAX)
+        return false;
+    MeshHeader header;
+    return MESHIO::inspectMesh(filename, header) > 0 && header.nPoints > INT_MAX;
+}
+
+/**
+ * Read, apply the operations, and write every requested format.
+ * @param opt
+ * @param report optional, filled with counts, stage timings and output filenames.
+ * @return 1/-1
+ */
+int MESHIO::convertMesh(const ConvertOptions &opt, ConvertReport *report)
+{
+    MESH_TRACE("convertMesh", opt.input);
+    ConvertReport localReport;
+    ConvertReport &rep = report ? *report : localReport;
+    rep = ConvertReport();
+    const string output_base = opt.outputBase();
+
+    //********* Result cache *********
+    if(!opt.cacheDir.empty() && MESHIO::cacheable(opt)) {
+        MESHIO::ConvertCache cache(opt.cacheDir, opt.cacheMaxMB);
+        MESHIO::StageTimer timer;
+        const string key = cache.key(opt);
+        if(!key.empty() && cache.fetch(key, output_base, rep)) {
+            long written = 0;
+            for(const string &output : rep.outputs)
+                written += MESHIO::fileBytes(output);
+            rep.stages.push_back(timer.finish("cache:hit", rep.nPoints + rep.nFacets, MESHIO::fileBytes(opt.input), written));
+            rep.cache = "hit";
+            return 1;
+        }
+        MESHIO::StageProfile miss = timer.finish("cache:miss", 0, MESHIO::fileBytes(opt.input));
+        ConvertOptions uncached = opt;
+        uncached.cacheDir.clear();
+        int result = MESHIO::convertMesh(uncached, &rep);
+        rep.stages.insert(rep.stages.begin(), miss);
+        rep.cache = "miss";
+        if(result == 1 && !key.empty()) {
+            MESHIO::StageTimer storeTimer;
+            cache.store(key, output_base, rep);
+            rep.stages.push_back(storeTimer.finish("cache:store", 0));
+        }
+        return result;
+    }
+
+    //********* Streaming conversion *********
+    if(opt.stream) {
+        if(opt.hasOperation()) {
+            cout << "--stream only converts the format, it can not be combined with an operation." << endl;
+            return -1;
+        }
+        if(opt.exportMCB || opt.float32 || opt.index64 || opt.cells) {
+            cout << (opt.exportMCB ? "--mcb" : opt.float32 ? "--float32" : opt.index64 ? "--index64" : "--cells") << " is not supported with --stream." << endl;
+            return -1;
+        }
+        if(opt.exportVTK) rep.outputs.push_back(output_base + ".o.vtk");
+        if(opt.exportMESH) rep.outputs.push_back(output_base + ".o.mesh");
+        if(opt.exportPLY) rep.outputs.push_back(output_base + ".o.ply");
+        if(opt.exportPLS) rep.outputs.push_back(output_base + ".o.pls");
+        if(opt.exportFacet) rep.outputs.push_back(output_base + ".o.facet");
+        if(opt.exportOBJ) rep.outputs.push_back(output_base + ".o.obj");
+        auto start = std::chrono::steady_clock::now();
+        MESHIO::StageTimer timer;
+        int result = MESHIO::streamConvert(opt.input, rep.outputs);
+        rep.writeSeconds = secondsSince(start);
+        long written = 0;
+        for(const string &output : rep.outputs)
+            written += MESHIO::fileBytes(output);
+        rep.stages.push_back(timer.finish("stream:" + fileExtension(opt.input), 0, MESHIO::fileBytes(opt.input), written));
+        return result;
+    }
+
+    //********* Cells of any size *********
+    if(opt.cells) {
+        if(opt.hasOperation() || opt.float32 || opt.index64) {
+            cout << "--cells only converts the format, it can not be combined with an operation." << endl;
+            return -1;
+        }
+        return convertCells(opt, rep);
+    }
+
+    //********* Single precision points, 64-bit indices *********
+    if(opt.index64 || MESHIO::needsIndex64(opt.input))
+        return opt.float32 ? convertGeneric<float, int64_t>(opt, rep) : convertGeneric<double, int64_t>(opt, rep);
+    if(opt.float32)
+        return convertGeneric<float, int>(opt, rep);
+
+    Eigen::MatrixXd V;
+    Eigen::MatrixXi F;
+    Eigen::MatrixXi M;
+    MESHIO::MeshAttributes attributes;
+    auto start = std::chrono::steady_clock::now();
+    MESHIO::StageTimer timer;
+    if(MESHIO::readMesh(opt.input, V, F, M, attributes) < 0)
+        return -1;
+    rep.readSeconds = secondsSince(start);
+    rep.stages.push_back(timer.finish("parse:" + fileExtension(opt.input), V.rows() + F.rows(), MESHIO::fileBytes(opt.input)));
+    return MESHIO::processMesh(opt, V, F, M, &rep, &attributes);
+}
+
+/**
+ * Apply the operations (see buildPipeline) to a mesh already in memory, and write every
+ * requested format. Reading the eps file of -e counts as reading.
+ * @param opt
+ * @param V, F, M mesh, modified by the operations.
+ * @param report optional, the stage timings are added to it.
+ * @return 1/-1
+ */
+int MESHIO::processMesh(const ConvertOptions &opt, Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M, ConvertReport *report,
+                        const MeshAttributes *attributes)
+{
+    const MeshAttributes none;
+    const MeshAttributes *arrays = attributes ? attributes : &none;
+    MeshAttributes withNormals;
+    ConvertReport localReport;
+    ConvertReport &rep = report ? *report : localReport;
+    const string output_base = opt.outputBase();
+    int cou = 0;
+    std::map<int, double> mpd;
+    std::map<int, vector<int>> mpi;
+
+    auto start = std::chrono::steady_clock::now();
+    if(opt.exportEpsVTK) {
+        MESHIO::StageTimer timer;
+        MESHIO::readEPS(opt.inputEx, cou, mpd, mpi);
+        rep.readSeconds += secondsSince(start);
+        rep.stages.push_back(timer.finish("parse:eps", cou, MESHIO::fileBytes(opt.inputEx)));
+    }
+
+    start = std::chrono::steady_clock::now();
+
+    //********* Operations, consecutive point and facet maps fused *********
+    std::vector<MESHIO::PipelineStage> stages;
+    if(!MESHIO::buildPipeline(opt, stages, &rep.outputs))
+        return -1;
+    if(MESHIO::runPipeline(MESHIO::fusePipeline(stages), V, F, M, &rep.stages) < 0)
+        return -1;
+    if(!opt.normals.empty()) {
+        MESHIO::StageTimer normalTimer;
+        NormalWeighting weighting;
+        withNormals = *arrays;
+        if(!normalWeightingFromName(opt.normals, weighting) || addNormals(V, F, weighting, withNormals) < 0)
+            return -1;
+        arrays = &withNormals;
+        rep.stages.push_back(normalTimer.finish("op:normals", V.rows() + F.rows()));
+    }
+    if(opt.qualityCells) {
+        MESHIO::StageTimer qualityTimer;
+        if(arrays != &withNormals)
+            withNormals = *arrays;
+        if(addQualityAttributes(V, F, withNormals) < 0)
+            return -1;
+        arrays = &withNormals;
+        rep.stages.push_back(qualityTimer.finish("op:quality-cells", F.rows()));
+    }
+    rep.operationSeconds = secondsSince(start);
+    rep.nPoints = V.rows();
+    rep.nFacets = F.rows();
+
+    start = std::chrono::steady_clock::now();
+    int result = 1;
+    MESHIO::StageTimer timer;
+    auto written = [&](const char *format) {
+        rep.stages.push_back(timer.finish(string("write:") + format, V.rows() + F.rows(), 0, MESHIO::fileBytes(rep.outputs.back())));
+        timer = MESHIO::StageTimer();
+    };
+    if(opt.exportVTK) {
+        rep.outputs.push_back(output_base + ".o.vtk");
+        result = min(result, MESHIO::writeVTK(rep.outputs.back(), V, F, M, *arrays));
+        written("vtk");
+    }
+    if(opt.exportMESH) {
+        rep.outputs.push_back(output_base + ".o.mesh");
+        result = min(result, MESHIO::writeMESH(rep.outputs.back(), V, F));
+        written("mesh");
+    }
+    if(opt.exportPLY) {
+        rep.outputs.push_back(output_base + ".o.ply");
+        result = min(result, MESHIO::writePLY(rep.outputs.back(), V, F, *arrays));
+        written("ply");
+    }
+    if(opt.exportPLS) {
+        rep.outputs.push_back(output_base + ".o.pls");
+        result = min(result, MESHIO::writePLS(rep.outputs.back(), V, F, M));
+        written("pls");
+    }
+    if(opt.exportFacet) {
+        rep.outputs.push_back(output_base + ".o.facet");
+        MESHIO::writeFacet(rep.outputs.back(), V, F, M);
+        written("facet");
+    }
+    if(opt.exportEpsVTK) { // This is to generate AutoGrid to control local eps.
+        rep.outputs.push_back(output_base + ".eps.vtk");
+        result = min(result, MESHIO::writeEpsVTK(rep.outputs.back(), V, F, cou, mpd, mpi));
+        written("eps");
+    }
+    if(opt.exportOBJ) {
+        rep.outputs.push_back(output_base + ".o.obj");
+        result = min(result, MESHIO::writeOBJ(rep.outputs.back(), V, F, M, *arrays));
+        written("obj");
+    }
+    if(opt.exportMCB) {
+        rep.outputs.push_back(output_base + ".o.mcb");
+        result = min(result, MESHIO::writeMCB(rep.outputs.back(), V, F, M, *arrays));
+        written("mcb");
+    }
+    rep.writeSeconds = secondsSince(start);
+    return result;
+}
+
+/**
+ * processMesh with single precision points. The operations run on float (see
+ * PipelineStage::runFloat) and the writers print the digits float has.
+ * @return 1/-1
+ */
+int MESHIO::processMesh(const ConvertOptions &opt, Eigen::MatrixXf &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M, ConvertReport *report)
+{
+    ConvertReport localReport;
+    return processGeneric(opt, V, F, M, report ? *report : localReport);
+}
@@ -0,0 +1,82 @@
+#ifndef MESH_CONVERT_H
+#define MESH_CONVERT_H
+
+#include "MeshProfile.h"
+#include "MeshLayout.h"
+#include "MeshAttributes.h"
+
+#include <Eigen/Dense>
+#include <string>
+#include <vector>
+
+namespace MESHIO {
+
+	/**
+	 * One conversion as given on the command line: an input file, the operations to apply
+	 * and the formats to write. Outputs are written next to the input as <name>.o.<format>.
+	 */
+	struct ConvertOptions {
+		std::string input;
+		std::string inputEx;            // eps file for -e
+		bool exportVTK = false;
+		bool exportEpsVTK = false;
+		bool exportMESH = false;
+		bool exportPLY = false;
+		bool exportPLS = false;
+		bool exportFacet = false;
+		bool exportOBJ = false;
+		bool exportMCB = false;
+		bool surface = false;           // boundary triangles of tetrahedra, before the other operations
+		bool resetOrientation = false;
+		bool reverseOrient = false;
+		bool repair = false;
+		std::string decimate;           // facet count, or fraction of the facets below 1, to decimate to; "" for none
+		bool decimateParallel = false;  // decimate spatial partitions in parallel first
+		bool reportInfo = false;
+		bool reportBoundary = false;
+		bool reportQuality = false;
+		std::string qualityJson;        // also write the quality report to this JSON file
+		bool qualityCells = false;      // per-facet quality as VTK cell arrays
+		bool exportBoundary = false;
+		bool stream = false;
+		bool float32 = false;           // points in single precision from parse to write
+		bool index64 = false;           // 64-bit indices even when the point count does not need them
+		bool cells = false;             // keep VTK cells of any size (MeshCells.h), no operation
+		std::string normals;            // area | angle: compute and write point and facet normals, "" for none
+		std::vector<double> rotateVec;
+		std::vector<double> boxVec;
+		std::vector<std::string> transformOps;
+		std::vector<std::string> pipelineOps;  // --op, applied in the given order after the flags above
+		std::string cacheDir;           // result cache, empty for none (see ConvertCache)
+		double cacheMaxMB = 4096.0;
+
+		bool hasOperation() const;
+		std::string outputBase() const;
+	};
+
+	// Where a conversion spent its time, and what it produced.
+	struct ConvertReport {
+		long nPoints = 0;
+		long nFacets = 0;
+		double readSeconds = 0.0;
+		double operationSeconds = 0.0;
+		double writeSeconds = 0.0;
+		std::vector<std::string> outputs;
+		std::vector<StageProfile> stages;  // parse, every operation and every writer, in order
+		std::string cache;                 // "hit" or "miss" with a result cache, "" without
+	};
+
+	int readMesh(const std::string &filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
+	int readMesh(const std::string &filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, MeshAttributes &attributes);
+	int readMesh(const std::string &filename, Eigen::MatrixXf &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
+	int readMesh(const std::string &filename, Eigen::MatrixXd &V, MatrixXl &T, Eigen::MatrixXi &M);
+	int readMesh(const std::string &filename, Eigen::MatrixXf &V, MatrixXl &T, Eigen::MatrixXi &M);
+	bool needsIndex64(const std::string &filename);
+	int convertMesh(const ConvertOptions &opt, ConvertReport *report = nullptr);
+	// attributes go to the VTK and .mcb outputs, those the operations left with the wrong row count are dropped.
+	int processMesh(const ConvertOptions &opt, Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M, ConvertReport *report = nullptr,
+	                const MeshAttributes *attributes = nullptr);
+	int processMesh(const ConvertOptions &opt, Eigen::MatrixXf &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M, ConvertReport *report = nullptr);
+};
+
+#endif
@@ -1,6 +1,12 @@
 #include "meshIO.h"
 #include "CLI11.hpp"
-#include "MeshOrient.h"
+#include "MeshConvert.h"
+#include "MeshBatch.h"
+#include "MeshServer.h"
+#include "MeshTrace.h"
+#include "MeshInspect.h"
+#include "MeshBVH.h"
+#include "MiniJson.h"
 #include "fstream"
 
 #define _DEBUG_ 1
@@ -9,119 +15,125 @@ using namespace std;
 
 int main(int argc, char** argv) {
     CLI::App app{"MeshConveter"};
-    string input_filename;
-	string input_filename_ex;
-	bool exportMESH = false;
-	bool exportVTK = false;
-	bool exportEpsVTK = false;
-	bool exportPLY = false;
-	bool exportPLS = false;
-	bool exportFacet = false;
-	bool exportOBJ = false;
-	bool resetOritation = false;
-	bool reverseFacetOrient = false;
-	bool meshRepair = false;
-
-	vector<double> rotateVec;
-	vector<double> boxVec;
-	app.add_option("-b", boxVec, "input bounding box. Format is (length, width, hight)");
-	app.add_option("-r", rotateVec, "input rotate param. Format is (start_x, start_y, start_z, end_x, end_y, end_z, angle) or (end_x, end_y, end_z, angle). angle value scale is (0, 2).");
-    app.add_option("-i", input_filename, "input filename. (string, required, supported format: vtk, mesh, pls, obj)")->required();
-	app.add_option("-p", input_filename_ex, "input filename. (string, required)");
-	app.add_flag("-k", exportVTK, "Write mesh in VTK format.");
-	app.add_flag("-e", exportEpsVTK, "Set eps in VTK format.");
-	app.add_flag("-m", exportMESH, "Write mesh in MESH/MEDIT format.");
-	app.add_flag("-y", exportPLY, "Write mesh in PLY format.");
-	app.add_flag("-s", exportPLS, "Write mesh in PLS format.");
-	app.add_flag("-f", exportFacet, "Write mesh in facet format.");
-	app.add_flag("-o", exportOBJ, "Write mesh in OBJ format.");
-	app.add_flag("--reverse-orient", reverseFacetOrient, "Reverse Facet Orient.");
-	app.add_flag("--reset-orient", resetOritation, "Regularize oritation");
-	app.add_flag("--repair", meshRepair, "Repair vtk file for the area is equal to zero.");
+	MESHIO::ConvertOptions opt;
+	MESHIO::BatchOptions batch;
+	MESHIO::ServerOptions server;
+	string clientSocket;
+	string traceFile;
+	bool profile = false;
+	bool inspect = false;
+	string profileJson;
+	string projectMesh, projectPoints, projectOutput;
+	bool projectCheck = false;
+
+	app.add_option("-b", opt.boxVec, "input bounding box. Format is (length, width, hight)");
+	app.add_option("-r", opt.rotateVec, "input rotate param. Format is (start_x, start_y, start_z, end_x, end_y, end_z, angle) or (end_x, end_y, end_z, angle). angle value scale is (0, 2).");
+	app.add_option("--transform", opt.transformOps, "Affine transform, repeatable and applied in order. rotate:[start_x,start_y,start_z,]end_x,end_y,end_z,angle | translate:x,y,z | scale:s | scale:sx,sy,sz | mirror:x|y|z | mirror:nx,ny,nz");
+    app.add_option("-i", opt.input, "input filename. (string, required unless --batch, supported format: vtk, mesh, pls, obj, mcb)");
+	app.add_option("-p", opt.inputEx, "input filename. (string, required)");
+	app.add_option("--op", opt.pipelineOps, "Operation, repeatable and applied in order after the other operations. rotate:.. | translate:.. | scale:.. | mirror:.. (as --transform) | reverse-orient | remap-marker:from=to[,from=to] | box:l,w,h | reset-orient | repair | info | boundary | surface | quality | decimate:target[,parallel]");
+	app.add_flag("-k", opt.exportVTK, "Write mesh in VTK format.");
+	app.add_flag("-e", opt.exportEpsVTK, "Set eps in VTK format.");
+	app.add_flag("-m", opt.exportMESH, "Write mesh in MESH/MEDIT format.");
+	app.add_flag("-y", opt.exportPLY, "Write mesh in PLY format.");
+	app.add_flag("-s", opt.exportPLS, "Write mesh in PLS format.");
+	app.add_flag("-f", opt.exportFacet, "Write mesh in facet format.");
+	app.add_flag("-o", opt.exportOBJ, "Write mesh in OBJ format.");
+	app.add_flag("--mcb", opt.exportMCB, "Write mesh in the native binary format, which opens without parsing.");
+	app.add_flag("--surface", opt.surface, "Replace tetrahedra by their boundary triangles, before the other operations.");
+	app.add_flag("--reverse-orient", opt.reverseOrient, "Reverse Facet Orient.");
+	app.add_flag("--reset-orient", opt.resetOrientation, "Regularize oritation");
+	app.add_flag("--repair", opt.repair, "Repair vtk file for the area is equal to zero.");
+	app.add_option("--decimate", opt.decimate, "Collapse edges by quadric error down to this facet count, or this fraction of the facets when below 1. Marker boundaries and open boundaries are kept.");
+	app.add_flag("--decimate-parallel", opt.decimateParallel, "Decimate spatial partitions in parallel first, then the edges between them. For very large meshes.");
+	app.add_flag("--stream", opt.stream, "Convert chunk by chunk in bounded memory. Only format conversion, no operation.");
+	app.add_flag("--float32", opt.float32, "Keep the points in single precision from reading to writing, half the memory of the points.");
+	app.add_flag("--index64", opt.index64, "Use 64-bit point indices. (default: only for meshes of more than 2^31 - 1 points)");
+	app.add_flag("--cells", opt.cells, "Keep VTK cells of any size (triangles, quads, polygons, volumes) as they are. Only format conversion, no operation.");
+	app.add_option("--normals", opt.normals, "Compute point and facet normals, weighted by facet area or corner angle, and write them to VTK, PLY, OBJ and mcb. area | angle")->check(CLI::IsMember({"area", "angle"}));
+	app.add_flag("--info", opt.reportInfo, "Report bounding box, centroid, medians, area, volume and area per marker.");
+	app.add_flag("--inspect", inspect, "Print the counts, element type and format variant from the file headers only, without converting. With --batch, one JSON line per file.");
+	app.add_flag("--boundary", opt.reportBoundary, "Report the boundary loops (holes) of the mesh.");
+	app.add_flag("--boundary-vtk", opt.exportBoundary, "Write the boundary loops as VTK line cells.");
+	app.add_flag("--quality", opt.reportQuality, "Report histograms of the min and max angles, aspect ratio, edge length and area of the triangles.");
+	app.add_option("--quality-json", opt.qualityJson, "Also write the quality report to this JSON file.");
+	app.add_flag("--quality-cells", opt.qualityCells, "Write the min and max angles, aspect ratio and area of every facet as VTK cell arrays.");
+	app.add_option("--cache", opt.cacheDir, "Reuse the outputs of identical earlier conversions kept in this directory.");
+	app.add_option("--cache-size", opt.cacheMaxMB, "Size of the result cache in MB, least recently used entries are removed. (default: 4096)");
+	app.add_option("--trace", traceFile, "Write the spans of readers, operations, writers and worker tasks as Chrome trace-event JSON.");
+	app.add_flag("--profile", profile, "Print wall time, CPU time, bytes, elements and peak RSS of every stage.");
+	app.add_option("--profile-json", profileJson, "Also write the stage profile to this JSON file.");
+	app.add_option("--batch", batch.source, "Convert every mesh of a directory, or every file listed in a manifest, with the same flags.");
+	app.add_option("--jobs", batch.jobs, "Number of batch worker threads. (default: one per core)");
+	app.add_option("--batch-memory", batch.memoryBudgetMB, "Memory budget of the running batch jobs in MB, estimated from the file sizes. (default: no limit)");
+	app.add_option("--batch-report", batch.report, "Write the JSON batch summary to this file instead of the standard output, where it is printed alone, the progress going to stderr.");
+	app.add_option("--serve", server.socketPath, "Run as a conversion server listening on this Unix domain socket.");
+	app.add_option("--server-cache", server.cacheMemoryMB, "Memory of the parsed meshes the server keeps, in MB. (default: 1024)");
+	app.add_option("--client", clientSocket, "Send the conversion given by the other flags to the server on this socket.");
+
+	CLI::App *project = app.add_subcommand("project", "Project a list of points onto the mesh through a BVH, writing the closest point, its facet and its distance.");
+	project->add_option("-i", projectMesh, "mesh filename.")->required();
+	project->add_option("--points", projectPoints, "points filename, x y z per line.")->required();
+	project->add_option("-o", projectOutput, "output filename. (default: <points>.projected.xyz)");
+	project->add_flag("--check", projectCheck, "Also check the BVH and the queries against a test of every facet.");
 
     try {
         app.parse(argc, argv);
+        if(opt.input.empty() && batch.source.empty() && server.socketPath.empty() && !*project)
+            throw CLI::RequiredError("-i");
     } catch (const CLI::ParseError &e) {
         return app.exit(e);
     }
 
-	size_t input_dotpos = input_filename.find_last_of('.');
-	string input_postfix = input_filename.substr(input_dotpos + 1, input_filename.length() - input_dotpos - 1);
-
-	Eigen::MatrixXd V;
-	Eigen::MatrixXi F;
-	Eigen::MatrixXi M;
-	int cou;
-	std::map<int, double> mpd;
-	std::map<int, vector<int>> mpi;
-
-    if(input_postfix == "vtk")
-        MESHIO::readVTK(input_filename, V, F, M);
-    else if(input_postfix == "mesh")
-        MESHIO::readMESH(input_filename, V, F, M);
-	else if (input_postfix == "pls")
-		MESHIO::readPLS(input_filename, V, F, M);
-	else if (input_postfix == "obj")
-		MESHIO::readOBJ(input_filename, V, F, M);
-    else {
-        cout << "Unsupported input format - " << input_postfix << endl;
-        return -1;
-    }
-
-    if(exportEpsVTK)
-    	MESHIO::readEPS(input_filename_ex, cou, mpd, mpi);
-
-	//********* Rotate *********
-	if(!rotateVec.empty())
-	MESHIO::rotatePoint(rotateVec, V, F);
-
-	//********* Add Box *********
-	if(!boxVec.empty())
-		MESHIO::addBox(boxVec, V, F, M);
-
-	//********* Regularize mesh oritation *********
-	if(resetOritation)
-	MESHIO::resetOrientation(V, F, M);
+	if(!traceFile.empty())
+		MESHIO::Trace::start();
+	int result = -1;
 
-	//********* modify facet orient ******
-	if(reverseFacetOrient){
-		MESHIO::reverseOrient(F);
+	//********* Point projection *********
+	if(*project) {
+		if(projectOutput.empty())
+			projectOutput = projectPoints.substr(0, projectPoints.rfind('.') == string::npos ? projectPoints.size() : projectPoints.rfind('.')) + ".projected.xyz";
+		result = MESHIO::projectPoints(projectMesh, projectPoints, projectOutput, projectCheck);
 	}
 
-	//********** repair ********
-	if(meshRepair){
-		MESHIO::repair(V, F, M);
+	//********* Server and client *********
+	else if(!server.socketPath.empty()) {
+		server.jobs = batch.jobs;
+		result = MESHIO::runServer(server);
 	}
-
-    if(exportVTK) {
-        string output_filename = input_filename.substr(0, input_dotpos) + ".o.vtk";
-        MESHIO::writeVTK(output_filename, V, F, M);
-    }
-    if(exportMESH) {
-        string output_filename = input_filename.substr(0, input_dotpos) + ".o.mesh";
-        MESHIO::writeMESH(output_filename, V, F);
-    }
-    if(exportPLY) { 
-        string output_filename = input_filename.substr(0, input_dotpos) + ".o.ply";
-        MESHIO::writePLY(output_filename, V, F);
-    }
-    if(exportPLS){
-        string output_filename = input_filename.substr(0, input_dotpos) + ".o.pls";
-        MESHIO::writePLS(output_filename, V, F, M);
-    }
-	if (exportFacet) {
-		string output_filename = input_filename.substr(0, input_dotpos) + ".o.facet";
-		MESHIO::writeFacet(output_filename, V, F, M);
+	else if(!clientSocket.empty())
+		result = MESHIO::runClient(clientSocket, opt);
+
+	//********* Inspection *********
+	else if(inspect) {
+		std::vector<std::string> inputs = batch.source.empty() ? std::vector<std::string>{opt.input} : MESHIO::listBatchInputs(batch.source);
+		result = 1;
+		for(const auto &input : inputs) {
+			MESHIO::MeshHeader header;
+			if(MESHIO::inspectMesh(input, header) < 0) {
+				result = -1;
+				continue;
+			}
+			if(batch.source.empty())
+				MESHIO::printHeader(header);
+			else
+				cout << "{\"input\": " << jsonString(input) << ", \"header\": " << MESHIO::headerToJson(header) << "}" << endl;
+		}
 	}
 
-	if(exportEpsVTK){// This is to generate AutoGrid to control local eps.
-		string output_filename = input_filename.substr(0, input_dotpos) + ".eps.vtk";
-		MESHIO::writeEpsVTK(output_filename, V, F, cou, mpd, mpi);
-	}
-	if(exportOBJ) {
-		string output_filename = input_filename.substr(0, input_dotpos) + ".o.obj";
-		MESHIO::writeOBJ(output_filename, V, F, M);
+	//********* Batch *********
+	else if(!batch.source.empty())
+		result = MESHIO::runBatch(batch, opt);
+
+	else {
+		MESHIO::ConvertReport report;
+		result = MESHIO::convertMesh(opt, &report);
+		if(profile || !profileJson.empty())
+			MESHIO::printProfile(report.stages);
+		if(!profileJson.empty())
+			MESHIO::writeProfileJson(profileJson, opt.input, report.stages);
 	}
-
-    return 0;
+	if(!traceFile.empty())
+		MESHIO::Trace::write(traceFile);
+	return result == 1 ? 0 : -1;
 }
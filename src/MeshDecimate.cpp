@@ -0,0 +1,625 @@
+#include "MeshDecimate.h"
+#include "MeshTrace.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const double CONSTRAINT_WEIGHT = 100.0;  // weight of a constraint plane, times the squared edge length
+const double MIN_FOLD_COS = 0.2;         // a facet may turn by up to ~78 degrees in a collapse
+const long PARTITION_FACETS = 1 << 16;
+const int MAX_PARTITIONS = 256;
+const int BLOCKS = 256;
+
+// Symmetric 4x4 error quadric, upper triangle: aa ab ac ad bb bc bd cc cd dd.
+struct Quadric {
+    double q[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+    // Squared distance to the plane n.p + d = 0, times w.
+    void addPlane(const Eigen::Vector3d &n, double d, double w) {
+        const double a = n[0], b = n[1], c = n[2];
+        q[0] += w * a * a; q[1] += w * a * b; q[2] += w * a * c; q[3] += w * a * d;
+        q[4] += w * b * b; q[5] += w * b * c; q[6] += w * b * d;
+        q[7] += w * c * c; q[8] += w * c * d;
+        q[9] += w * d * d;
+    }
+    Quadric &operator+=(const Quadric &o) {
+        for(int k = 0; k < 10; k++)
+            q[k] += o.q[k];
+        return *this;
+    }
+    double error(const Eigen::Vector3d &p) const {
+        const double x = p[0], y = p[1], z = p[2];
+        return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+             + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+             + q[7] * z * z + 2 * q[8] * z + q[9];
+    }
+    // Point of least error, false when the quadric is close to singular (flat or straight).
+    bool optimum(Eigen::Vector3d &p) const {
+        Eigen::Matrix3d A;
+        A << q[0], q[1], q[2], q[1], q[4], q[5], q[2], q[5], q[7];
+        const double scale = (q[0] + q[4] + q[7]) / 3.0;
+        const double det = A.determinant();
+        if(!(fabs(det) > 1e-9 * scale * scale * scale))
+            return false;
+        p = -A.inverse() * Eigen::Vector3d(q[3], q[6], q[8]);
+        return true;
+    }
+};
+
+struct Collapse {
+    int keep, remove;
+    Eigen::Vector3d position;
+    double cost;
+};
+
+// Heap entry of the edge a b, stale once a stamp no longer matches.
+struct Entry {
+    double cost;
+    int a, b;
+    uint32_t stampA, stampB;
+};
+
+// Greater, so the heap gives the cheapest edge first; ties by point index for a deterministic order.
+struct Costlier {
+    bool operator()(const Entry &x, const Entry &y) const {
+        if(x.cost != y.cost)
+            return x.cost > y.cost;
+        if(x.a != y.a)
+            return x.a > y.a;
+        return x.b > y.b;
+    }
+};
+
+// Per run scratch, one per partition in the parallel mode.
+struct Scratch {
+    std::vector<int> edgesU, edgesV, ringU, ringV;
+};
+
+inline int nextEdge(int h) { return h % 3 == 2 ? h - 2 : h + 1; }
+inline int prevEdge(int h) { return h % 3 == 0 ? h + 2 : h - 1; }
+
+/**
+ * Triangle mesh as a corner table: half-edge h = 3 f + k runs from corner[h] to
+ * corner[nextEdge(h)], so next and previous are implicit and the three half-edges of a
+ * facet are contiguous. opp links the two half-edges of an interior edge, -1 on open
+ * boundary and non-manifold edges; every point keeps one outgoing half-edge.
+ */
+class Decimator {
+public:
+    Decimator(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::MatrixXi &M);
+
+    long runPartitions(int partitions, long budget);
+    long run(const std::vector<int> &faces, int part, long budget);
+    void result(Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) const;
+
+private:
+    bool owns(int v, int part) const { return part < 0 || owner[v] == part; }
+    bool isConstraint(int h) const {
+        return opp[h] < 0 || (!mark.empty() && mark[h / 3] != mark[opp[h] / 3]);
+    }
+
+    // Calls fn with every outgoing half-edge of v, walking both ways round an open fan.
+    template<class Fn>
+    void circulate(int v, Fn &&fn) const {
+        const int start = vh[v];
+        if(start < 0)
+            return;
+        int h = start;
+        while(true) {
+            fn(h);
+            const int o = opp[prevEdge(h)];
+            if(o == start)
+                return;
+            if(o < 0)
+                break;
+            h = o;
+        }
+        for(int o = opp[start]; o >= 0; o = opp[h]) {
+            h = nextEdge(o);
+            fn(h);
+        }
+    }
+    // Half-edges that start or (on an open boundary) end the edges of v.
+    void edgesOf(int v, std::vector<int> &edges) const {
+        edges.clear();
+        circulate(v, [&](int h) {
+            edges.push_back(h);
+            if(opp[prevEdge(h)] < 0)
+                edges.push_back(prevEdge(h));
+        });
+    }
+    int otherEnd(int h, int v) const { return corner[h] == v ? corner[nextEdge(h)] : corner[h]; }
+
+    bool plan(int h, int part, Collapse &c) const;
+    bool folds(int face, int u, int v, const Eigen::Vector3d &p) const;
+    long collapse(const Collapse &c, int h, int part, Scratch &s);
+    void push(std::vector<Entry> &heap, const Collapse &c, int h) const;
+    void addBlockEntries(const std::vector<int> &faces, int part, std::vector<Entry> &heap) const;
+
+    long nV, nF;
+    std::vector<Eigen::Vector3d> pos;
+    std::vector<int> corner;
+    std::vector<int> opp;
+    std::vector<int> vh;
+    std::vector<int> mark;                // marker of every facet, empty without markers
+    std::vector<Quadric> quadric;
+    std::vector<uint32_t> stamp;
+    std::vector<uint8_t> faceAlive;
+    std::vector<uint8_t> removed;
+    std::vector<uint8_t> locked;          // non-manifold points, never moved
+    std::vector<uint8_t> constraints;     // constraint edges at every point, corners have other than 2
+    std::vector<int> owner;               // partition of every point, -1 between partitions
+};
+
+Decimator::Decimator(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::MatrixXi &M)
+    : nV(V.rows()), nF(F.rows()), pos(nV), corner(nF * 3), opp(nF * 3, -1), vh(nV, -1), quadric(nV), stamp(nV, 0),
+      faceAlive(nF, 1), removed(nV, 0), locked(nV, 0), constraints(nV, 0)
+{
+#pragma omp parallel for schedule(static)
+    for(long i = 0; i < nV; i++)
+        pos[i] = V.row(i).transpose();
+#pragma omp parallel for schedule(static)
+    for(long f = 0; f < nF; f++)
+        for(int k = 0; k < 3; k++)
+            corner[f * 3 + k] = F(f, k);
+    if(M.rows() == nF && M.cols() > 0) {
+        mark.resize(nF);
+        for(long f = 0; f < nF; f++)
+            mark[f] = M(f, 0);
+    }
+    for(long f = 0; f < nF; f++) {
+        const int *c = &corner[f * 3];
+        if(c[0] == c[1] || c[1] == c[2] || c[2] == c[0])
+            locked[c[0]] = locked[c[1]] = locked[c[2]] = 1;
+    }
+
+    // Outgoing half-edges of every point, by a counting sort.
+    std::vector<long> offset(nV + 1, 0);
+    for(long h = 0; h < nF * 3; h++)
+        offset[corner[h] + 1]++;
+    for(long i = 0; i < nV; i++)
+        offset[i + 1] += offset[i];
+    std::vector<int> outgoing(nF * 3);
+    {
+        std::vector<long> fill(offset.begin(), offset.end() - 1);
+        for(long h = 0; h < nF * 3; h++)
+            outgoing[fill[corner[h]]++] = (int)h;
+    }
+
+    // An edge is paired only when each of its two directions occurs once.
+#pragma omp parallel for schedule(static)
+    for(long h = 0; h < nF * 3; h++) {
+        const int a = corner[h], b = corner[nextEdge((int)h)];
+        int forward = 0, backward = 0, match = -1;
+        for(long j = offset[a]; j < offset[a + 1]; j++)
+            forward += corner[nextEdge(outgoing[j])] == b;
+        for(long j = offset[b]; j < offset[b + 1]; j++)
+            if(corner[nextEdge(outgoing[j])] == a) {
+                backward++;
+                match = outgoing[j];
+            }
+        if(forward == 1 && backward == 1)
+            opp[h] = match;
+        else if(backward > 1 || forward > 1) {
+#pragma omp atomic write
+            locked[a] = 1;
+#pragma omp atomic write
+            locked[b] = 1;
+        }
+    }
+
+    // Facet planes, then the quadric of every point from its facets and constraint edges.
+    std::vector<Eigen::Vector3d> normal(nF);
+    std::vector<double> area(nF);
+#pragma omp parallel for schedule(static)
+    for(long f = 0; f < nF; f++) {
+        const Eigen::Vector3d n = (pos[corner[f * 3 + 1]] - pos[corner[f * 3]]).cross(pos[corner[f * 3 + 2]] - pos[corner[f * 3]]);
+        const double length = n.norm();
+        area[f] = 0.5 * length;
+        normal[f] = length > 0 ? Eigen::Vector3d(n / length) : Eigen::Vector3d::Zero();
+    }
+#pragma omp parallel for schedule(dynamic, 4096)
+    for(long v = 0; v < nV; v++) {
+        if(offset[v] == offset[v + 1])
+            continue;
+        vh[v] = outgoing[offset[v]];
+        // A fan that does not reach every facet of the point is not a disk.
+        long fan = 0;
+        circulate((int)v, [&](int) { fan++; });
+        if(fan != offset[v + 1] - offset[v])
+            locked[v] = 1;
+        Quadric &Q = quadric[v];
+        int count = 0;
+        auto constraintPlane = [&](int h) {
+            count++;
+            const long f = h / 3;
+            const Eigen::Vector3d &p = pos[corner[h]];
+            const Eigen::Vector3d e = pos[corner[nextEdge(h)]] - p;
+            const Eigen::Vector3d n = e.cross(normal[f]);
+            const double length = n.norm();
+            if(length > 0)
+                Q.addPlane(n / length, -n.dot(p) / length, CONSTRAINT_WEIGHT * e.squaredNorm());
+        };
+        for(long j = offset[v]; j < offset[v + 1]; j++) {
+            const int h = outgoing[j];
+            const long f = h / 3;
+            Q.addPlane(normal[f], -normal[f].dot(pos[v]), area[f]);
+            if(isConstraint(h))
+                constraintPlane(h);
+            if(opp[prevEdge(h)] < 0)
+                constraintPlane(prevEdge(h));
+        }
+        constraints[v] = (uint8_t)min(count, 255);
+    }
+}
+
+/**
+ * Where the edge of h collapses to. A point on constraint edges stays, or slides along
+ * the constraint edge onto its neighbour when it is no corner; two free points meet at
+ * the point of least error.
+ */
+bool Decimator::plan(int h, int part, Collapse &c) const
+{
+    const int a = corner[h], b = corner[nextEdge(h)];
+    if(locked[a] || locked[b] || !owns(a, part) || !owns(b, part))
+        return false;
+    Quadric Q = quadric[a];
+    Q += quadric[b];
+    auto endpoint = [&](int keep, int remove) {
+        c.keep = keep;
+        c.remove = remove;
+        c.position = pos[keep];
+        c.cost = Q.error(c.position);
+    };
+    const bool constrainedA = constraints[a] > 0, constrainedB = constraints[b] > 0;
+    if(constrainedA && constrainedB) {
+        if(!isConstraint(h))
+            return false;
+        const bool cornerA = constraints[a] != 2, cornerB = constraints[b] != 2;
+        if(cornerA && cornerB)
+            return false;
+        if(cornerA)
+            endpoint(a, b);
+        else if(cornerB)
+            endpoint(b, a);
+        else {
+            endpoint(b, a);
+            const Collapse toB = c;
+            endpoint(a, b);
+            if(toB.cost < c.cost)
+                c = toB;
+        }
+    } else if(constrainedA)
+        endpoint(a, b);
+    else if(constrainedB)
+        endpoint(b, a);
+    else {
+        c.keep = a;
+        c.remove = b;
+        if(Q.optimum(c.position))
+            c.cost = Q.error(c.position);
+        else {
+            const Eigen::Vector3d candidates[3] = {pos[a], pos[b], 0.5 * (pos[a] + pos[b])};
+            c.cost = INFINITY;
+            for(const Eigen::Vector3d &p : candidates) {
+                const double cost = Q.error(p);
+                if(cost < c.cost) {
+                    c.cost = cost;
+                    c.position = p;
+                }
+            }
+        }
+    }
+    c.cost = max(c.cost, 0.0);
+    return true;
+}
+
+// True when moving u and v of the facet to p turns it over or flattens it.
+bool Decimator::folds(int face, int u, int v, const Eigen::Vector3d &p) const
+{
+    Eigen::Vector3d before[3], after[3];
+    for(int k = 0; k < 3; k++) {
+        const int w = corner[face * 3 + k];
+        before[k] = pos[w];
+        after[k] = w == u || w == v ? p : pos[w];
+    }
+    const Eigen::Vector3d n0 = (before[1] - before[0]).cross(before[2] - before[0]);
+    const Eigen::Vector3d n1 = (after[1] - after[0]).cross(after[2] - after[0]);
+    const double l0 = n0.norm(), l1 = n1.norm();
+    if(l0 == 0)
+        return false;
+    return n0.dot(n1) <= MIN_FOLD_COS * l0 * l1 || l1 == 0;
+}
+
+/**
+ * Collapse the edge of h as planned, unless the ends share other neighbours than the
+ * facets of the edge (the link condition, which keeps the mesh manifold) or a facet folds.
+ * @return the number of facets removed, 0 when the collapse was refused
+ */
+long Decimator::collapse(const Collapse &c, int h, int part, Scratch &s)
+{
+    const int u = c.keep, v = c.remove;
+    const int g = opp[h];
+    const int f0 = h / 3, f1 = g >= 0 ? g / 3 : -1;
+
+    edgesOf(u, s.edgesU);
+    edgesOf(v, s.edgesV);
+    s.ringU.clear();
+    s.ringV.clear();
+    for(int e : s.edgesU)
+        s.ringU.push_back(otherEnd(e, u));
+    for(int e : s.edgesV)
+        s.ringV.push_back(otherEnd(e, v));
+    sort(s.ringU.begin(), s.ringU.end());
+    sort(s.ringV.begin(), s.ringV.end());
+    long common = 0;
+    for(size_t i = 0, j = 0; i < s.ringU.size() && j < s.ringV.size();) {
+        if(s.ringU[i] < s.ringV[j])
+            i++;
+        else if(s.ringV[j] < s.ringU[i])
+            j++;
+        else {
+            common++;
+            i++;
+            j++;
+        }
+    }
+    if(common != (g >= 0 ? 2 : 1))
+        return 0;
+    // A tetrahedron, or a lone triangle, would collapse into nothing.
+    if(s.ringU.size() == (g >= 0 ? 3u : 2u) && s.ringV.size() == s.ringU.size())
+        return 0;
+    for(const std::vector<int> *edges : {&s.edgesU, &s.edgesV})
+        for(int e : *edges) {
+            const int face = e / 3;
+            if(face != f0 && face != f1 && folds(face, u, v, c.position))
+                return 0;
+        }
+
+    // Drop the facets of the edge, joining their two other edges.
+    for(int e : {h, g}) {
+        if(e < 0)
+            continue;
+        const int en = nextEdge(e), ep = prevEdge(e);
+        const int o1 = opp[en], o2 = opp[ep];
+        if(o1 >= 0)
+            opp[o1] = o2;
+        if(o2 >= 0)
+            opp[o2] = o1;
+        faceAlive[e / 3] = 0;
+        const int t = corner[ep];
+        if(owns(t, part))
+            vh[t] = o1 >= 0 ? o1 : o2 >= 0 ? nextEdge(o2) : -1;
+    }
+    for(int e : s.edgesV)
+        if(faceAlive[e / 3] && corner[e] == v)
+            corner[e] = u;
+    pos[u] = c.position;
+    quadric[u] += quadric[v];
+    removed[v] = 1;
+    stamp[u]++;
+    stamp[v]++;
+    vh[u] = -1;
+    for(const std::vector<int> *edges : {&s.edgesU, &s.edgesV})
+        for(int e : *edges)
+            if(vh[u] < 0 && faceAlive[e / 3] && corner[e] == u)
+                vh[u] = e;
+    return g >= 0 ? 2 : 1;
+}
+
+void Decimator::push(std::vector<Entry> &heap, const Collapse &c, int h) const
+{
+    const int a = corner[h], b = corner[nextEdge(h)];
+    heap.push_back(Entry{c.cost, a, b, stamp[a], stamp[b]});
+}
+
+// Entries of the edges of faces, over fixed blocks in parallel for the whole mesh.
+void Decimator::addBlockEntries(const std::vector<int> &faces, int part, std::vector<Entry> &heap) const
+{
+    const long n = faces.size();
+    const int blocks = part < 0 && n > BLOCKS * 64 ? BLOCKS : 1;
+    std::vector<std::vector<Entry>> partial(blocks);
+#pragma omp parallel for schedule(dynamic, 1) if(blocks > 1)
+    for(int b = 0; b < blocks; b++)
+        for(long i = n * b / blocks; i < n * (b + 1) / blocks; i++) {
+            const int f = faces[i];
+            if(!faceAlive[f])
+                continue;
+            for(int k = 0; k < 3; k++) {
+                const int h = f * 3 + k;
+                Collapse c;
+                if((opp[h] < 0 || opp[h] > h) && plan(h, part, c))
+                    push(partial[b], c, h);
+            }
+        }
+    for(const std::vector<Entry> &block : partial)
+        heap.insert(heap.end(), block.begin(), block.end());
+}
+
+/**
+ * Collapse the edges of faces whose ends belong to part (any edge for part -1), cheapest
+ * first, until budget facets are removed. Entries of edges whose ends changed since they
+ * were pushed are dropped as they come up instead of being searched for in the heap.
+ * @return the number of facets removed
+ */
+long Decimator::run(const std::vector<int> &faces, int part, long budget)
+{
+    std::vector<Entry> heap;
+    addBlockEntries(faces, part, heap);
+    make_heap(heap.begin(), heap.end(), Costlier());
+    Scratch s;
+    long count = 0;
+    while(count < budget && !heap.empty()) {
+        pop_heap(heap.begin(), heap.end(), Costlier());
+        const Entry e = heap.back();
+        heap.pop_back();
+        if(removed[e.a] || removed[e.b] || stamp[e.a] != e.stampA || stamp[e.b] != e.stampB)
+            continue;
+        edgesOf(e.a, s.edgesU);
+        int h = -1;
+        for(int edge : s.edgesU)
+            if(otherEnd(edge, e.a) == e.b)
+                h = edge;
+        Collapse c;
+        if(h < 0 || !plan(h, part, c))
+            continue;
+        const long n = collapse(c, h, part, s);
+        if(n == 0)
+            continue;
+        count += n;
+        edgesOf(c.keep, s.edgesU);
+        for(int edge : s.edgesU) {
+            Collapse next;
+            if(plan(edge, part, next)) {
+                push(heap, next, edge);
+                push_heap(heap.begin(), heap.end(), Costlier());
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * Decimate a grid of spatial partitions in parallel. Points between partitions are left
+ * to the final pass, so every partition only changes its own facets and points.
+ * @return the number of facets removed
+ */
+long Decimator::runPartitions(int partitions, long budget)
+{
+    Eigen::Vector3d lo = Eigen::Vector3d::Constant(INFINITY), hi = -lo;
+    for(const Eigen::Vector3d &p : pos) {
+        lo = lo.cwiseMin(p);
+        hi = hi.cwiseMax(p);
+    }
+    const int g = max(1, (int)ceil(cbrt((double)partitions)));
+    const Eigen::Vector3d scale = (hi - lo).cwiseMax(1e-300).cwiseInverse() * g;
+    std::vector<int> facePart(nF);
+#pragma omp parallel for schedule(static)
+    for(long f = 0; f < nF; f++) {
+        const Eigen::Vector3d c = (pos[corner[f * 3]] + pos[corner[f * 3 + 1]] + pos[corner[f * 3 + 2]]) / 3.0;
+        int cell = 0;
+        for(int k = 0; k < 3; k++)
+            cell = cell * g + min(g - 1, max(0, (int)((c[k] - lo[k]) * scale[k])));
+        facePart[f] = cell;
+    }
+    owner.assign(nV, -1);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for(long v = 0; v < nV; v++) {
+        int part = -2;
+        circulate((int)v, [&](int h) {
+            const int p = facePart[h / 3];
+            part = part == -2 || part == p ? p : -1;
+        });
+        owner[v] = max(part, -1);
+    }
+    const int nParts = g * g * g;
+    std::vector<std::vector<int>> faces(nParts);
+    for(long f = 0; f < nF; f++)
+        faces[facePart[f]].push_back((int)f);
+
+    long count = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(+ : count)
+    for(int p = 0; p < nParts; p++)
+        if(!faces[p].empty())
+            count += run(faces[p], p, budget * (long)faces[p].size() / nF);
+
+    // The partitions kept the outgoing half-edges of their own points only.
+    for(long v = 0; v < nV; v++)
+        if(owner[v] < 0)
+            vh[v] = -1;
+    for(long f = nF - 1; f >= 0; f--)
+        if(faceAlive[f])
+            for(int k = 0; k < 3; k++)
+                if(owner[corner[f * 3 + k]] < 0)
+                    vh[corner[f * 3 + k]] = (int)(f * 3 + k);
+    owner.clear();
+    return count;
+}
+
+void Decimator::result(Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) const
+{
+    std::vector<int> index(nV, -1);
+    int nKept = 0;
+    for(long v = 0; v < nV; v++)
+        if(!removed[v])
+            index[v] = nKept++;
+    Eigen::MatrixXd V2(nKept, 3);
+    for(long v = 0; v < nV; v++)
+        if(index[v] >= 0)
+            V2.row(index[v]) = pos[v].transpose();
+    long nAlive = 0;
+    for(long f = 0; f < nF; f++)
+        nAlive += faceAlive[f];
+    Eigen::MatrixXi F2(nAlive, 3), M2(M.rows() == nF ? nAlive : 0, M.cols());
+    long row = 0;
+    for(long f = 0; f < nF; f++) {
+        if(!faceAlive[f])
+            continue;
+        for(int k = 0; k < 3; k++)
+            F2(row, k) = index[corner[f * 3 + k]];
+        if(M2.rows())
+            M2.row(row) = M.row(f);
+        row++;
+    }
+    V.swap(V2);
+    F.swap(F2);
+    M.swap(M2);
+}
+
+}
+
+long MESHIO::decimateTarget(const std::string &value, long nFacets)
+{
+    char *end;
+    const double target = strtod(value.c_str(), &end);
+    if(value.empty() || *end != '\0' || !(target > 0)) {
+        std::cout << "The decimation target is a facet count or a fraction of the facets. - " << value << std::endl;
+        return -1;
+    }
+    return target < 1 ? max(1L, (long)llround(target * nFacets)) : (long)target;
+}
+
+long MESHIO::decimate(Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M, const DecimateOptions &options)
+{
+    MESH_TRACE("decimate");
+    if(F.cols() != 3) {
+        std::cout << "Decimation needs triangles." << std::endl;
+        return -1;
+    }
+    const long nF = F.rows();
+    if(nF > INT_MAX / 3) {
+        std::cout << "Too many facets to decimate." << std::endl;
+        return -1;
+    }
+    const long target = max(options.targetFacets, 1L);
+    if(target >= nF) {
+        std::cout << "The mesh has " << nF << " facets, not more than the decimation target." << std::endl;
+        return nF;
+    }
+    const long nPoints = V.rows();
+    Decimator decimator(V, F, M);
+    long left = nF;
+    if(options.parallel) {
+        const int partitions = options.partitions > 0 ? options.partitions : (int)min<long>(MAX_PARTITIONS, max(1L, nF / PARTITION_FACETS));
+        if(partitions > 1)
+            left -= decimator.runPartitions(partitions, nF - target);
+    }
+    std::vector<int> faces(nF);
+    for(long f = 0; f < nF; f++)
+        faces[f] = (int)f;
+    left -= decimator.run(faces, -1, left - target);
+    decimator.result(V, F, M);
+    std::cout << "Decimated " << nF << " facets to " << F.rows() << ", " << nPoints - V.rows() << " points removed." << std::endl;
+    if(F.rows() > target)
+        std::cout << "No more edge could be collapsed without breaking a constraint or folding a facet." << std::endl;
+    return F.rows();
+}
@@ -0,0 +1,34 @@
+#ifndef MESH_DECIMATE_H
+#define MESH_DECIMATE_H
+
+#include <Eigen/Dense>
+#include <string>
+
+namespace MESHIO {
+
+	struct DecimateOptions {
+		long targetFacets = 0;
+		// Decimate spatial partitions of the mesh in parallel, then the edges between them.
+		bool parallel = false;
+		int partitions = 0;      // 0: one per 65536 facets, at most 256
+	};
+
+	/**
+	 * Target of --decimate: a facet count, or a fraction of the facets when below 1.
+	 * @return the number of facets to keep, -1 for an illegal value
+	 */
+	long decimateTarget(const std::string &value, long nFacets);
+
+	/**
+	 * Collapse edges of the triangles F, cheapest first by the quadric error of their
+	 * points, until targetFacets are left or no edge can go. Edges between facets of
+	 * different markers and open boundary edges are constraints: their points only slide
+	 * along them and their ends stay. Collapses that would fold a facet over or make the
+	 * mesh non-manifold are skipped, and non-manifold points are left as they are.
+	 * V loses the removed points, M keeps the marker of every remaining facet.
+	 * @return the number of facets left, -1 on failure
+	 */
+	long decimate(Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M, const DecimateOptions &options);
+};
+
+#endif
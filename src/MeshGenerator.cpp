@@ -0,0 +1,287 @@
+#include "MeshGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// splitmix64, the same sequence on every platform unlike the <random> distributions.
+class Random {
+public:
+    explicit Random(unsigned long seed) : state(seed) {}
+    unsigned long long next() {
+        unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+    unsigned long long state;
+};
+
+struct Builder {
+    vector<double> points;
+    vector<int> facets;
+    vector<int> marks;
+
+    int addPoint(const Eigen::Vector3d &p) {
+        points.push_back(p.x()); points.push_back(p.y()); points.push_back(p.z());
+        return (int)(points.size() / 3 - 1);
+    }
+    void addFacet(int a, int b, int c, int mark) {
+        facets.push_back(a); facets.push_back(b); facets.push_back(c);
+        marks.push_back(mark);
+    }
+    void copyTo(Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) const {
+        const long nV = points.size() / 3, nF = facets.size() / 3;
+        V.resize(nV, 3);
+        F.resize(nF, 3);
+        M.resize(nF, 1);
+        for(long i = 0; i < nV; i++)
+            for(int k = 0; k < 3; k++)
+                V(i, k) = points[3 * i + k];
+        for(long i = 0; i < nF; i++) {
+            for(int k = 0; k < 3; k++)
+                F(i, k) = facets[3 * i + k];
+            M(i, 0) = marks[i];
+        }
+    }
+};
+
+/**
+ * Geodesic sphere of frequency n: 20 n^2 outward facets, 10 n^2 + 2 points. Points on the
+ * icosahedron edges are created once and shared by the two faces of the edge.
+ */
+void geodesicSphere(Builder &b, int n, const Eigen::Vector3d &center, double radius, int mark)
+{
+    const double t = (1.0 + sqrt(5.0)) / 2.0;
+    const double corners[12][3] = {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t},
+                                   {0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+    const int faces[20][3] = {{0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11}, {1, 5, 9}, {5, 11, 4},
+                              {11, 10, 2}, {10, 7, 6}, {7, 1, 8}, {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8},
+                              {3, 8, 9}, {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}};
+    auto project = [&](const Eigen::Vector3d &p) { return b.addPoint(center + radius * p.normalized()); };
+
+    int corner[12];
+    for(int i = 0; i < 12; i++)
+        corner[i] = project(Eigen::Vector3d(corners[i][0], corners[i][1], corners[i][2]));
+
+    // First of the n - 1 inner points of every edge, stored from the lower corner to the higher.
+    map<pair<int, int>, int> edgeStart;
+    for(const auto &face : faces) {
+        for(int e = 0; e < 3; e++) {
+            int a = min(face[e], face[(e + 1) % 3]), c = max(face[e], face[(e + 1) % 3]);
+            if(edgeStart.count({a, c}))
+                continue;
+            edgeStart[{a, c}] = (int)(b.points.size() / 3);
+            Eigen::Vector3d pa(corners[a][0], corners[a][1], corners[a][2]), pc(corners[c][0], corners[c][1], corners[c][2]);
+            for(int i = 1; i < n; i++)
+                project(pa + (pc - pa) * i / n);
+        }
+    }
+    auto edgePoint = [&](int a, int c, int i) {
+        if(i == 0) return corner[a];
+        if(i == n) return corner[c];
+        return a < c ? edgeStart[{a, c}] + i - 1 : edgeStart[{c, a}] + n - i - 1;
+    };
+
+    vector<int> grid((n + 1) * (n + 1));
+    for(const auto &face : faces) {
+        const int A = face[0], B = face[1], C = face[2];
+        Eigen::Vector3d pA(corners[A][0], corners[A][1], corners[A][2]);
+        Eigen::Vector3d pB(corners[B][0], corners[B][1], corners[B][2]);
+        Eigen::Vector3d pC(corners[C][0], corners[C][1], corners[C][2]);
+        // Point i steps towards B and j steps towards C.
+        for(int i = 0; i <= n; i++) {
+            for(int j = 0; i + j <= n; j++) {
+                int id;
+                if(j == 0) id = edgePoint(A, B, i);
+                else if(i == 0) id = edgePoint(A, C, j);
+                else if(i + j == n) id = edgePoint(B, C, j);
+                else id = project(pA + (pB - pA) * i / n + (pC - pA) * j / n);
+                grid[i * (n + 1) + j] = id;
+            }
+        }
+        for(int i = 0; i < n; i++) {
+            for(int j = 0; i + j < n; j++) {
+                b.addFacet(grid[i * (n + 1) + j], grid[(i + 1) * (n + 1) + j], grid[i * (n + 1) + j + 1], mark);
+                if(i + j + 1 < n)
+                    b.addFacet(grid[(i + 1) * (n + 1) + j], grid[(i + 1) * (n + 1) + j + 1], grid[i * (n + 1) + j + 1], mark);
+            }
+        }
+    }
+}
+
+int sphereFrequency(long facets)
+{
+    return max(1, (int)lround(sqrt(facets / 20.0)));
+}
+
+// Torus with u segments around the hole and v around the tube, 2 u v outward facets.
+void torus(Builder &b, int u, int v, int patchSize, Random *random)
+{
+    const double R = 1.0, r = 0.35;
+    for(int i = 0; i < u; i++) {
+        const double a = 2 * PI * i / u;
+        for(int j = 0; j < v; j++) {
+            const double c = 2 * PI * j / v;
+            b.addPoint(Eigen::Vector3d((R + r * cos(c)) * cos(a), (R + r * cos(c)) * sin(a), r * sin(c)));
+        }
+    }
+    const int patchesV = (v + patchSize - 1) / patchSize;
+    const int patchesU = (u + patchSize - 1) / patchSize;
+    vector<bool> flipped(patchesU * patchesV, false);
+    if(random)
+        for(size_t k = 0; k < flipped.size(); k++)
+            flipped[k] = random->uniform() < 0.5;
+    auto at = [&](int i, int j) { return (i % u) * v + j % v; };
+    for(int i = 0; i < u; i++) {
+        for(int j = 0; j < v; j++) {
+            const int patch = (i / patchSize) * patchesV + j / patchSize;
+            const int mark = random ? patch : 0;
+            int p00 = at(i, j), p10 = at(i + 1, j), p11 = at(i + 1, j + 1), p01 = at(i, j + 1);
+            if(flipped[patch]) {
+                b.addFacet(p00, p11, p10, mark);
+                b.addFacet(p00, p01, p11, mark);
+            } else {
+                b.addFacet(p00, p10, p11, mark);
+                b.addFacet(p00, p11, p01, mark);
+            }
+        }
+    }
+}
+
+/**
+ * Unit cube of n^3 cells, each split into the 6 tetrahedra around its diagonal: 6 n^3
+ * tetrahedra that share their faces, (n + 1)^3 points. Each tetrahedron has its last two
+ * corners swapped with probability 1/2.
+ */
+void cubeTetrahedra(int n, Random &random, Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M)
+{
+    const long side = n + 1;
+    V.resize(side * side * side, 3);
+    for(long k = 0; k < side; k++)
+        for(long j = 0; j < side; j++)
+            for(long i = 0; i < side; i++)
+                V.row((k * side + j) * side + i) << (double)i / n, (double)j / n, (double)k / n;
+    // The 6 orders in which a path from corner (0,0,0) to (1,1,1) steps along the axes.
+    const int paths[6][3] = { {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0} };
+    const long nT = 6L * n * n * n;
+    F.resize(nT, 4);
+    M.resize(nT, 1);
+    long t = 0;
+    for(int k = 0; k < n; k++)
+        for(int j = 0; j < n; j++)
+            for(int i = 0; i < n; i++)
+                for(const auto &path : paths) {
+                    int c[3] = {i, j, k};
+                    F(t, 0) = (int)((c[2] * side + c[1]) * side + c[0]);
+                    for(int s = 0; s < 3; s++) {
+                        c[path[s]]++;
+                        F(t, s + 1) = (int)((c[2] * side + c[1]) * side + c[0]);
+                    }
+                    if(random.uniform() < 0.5)
+                        swap(F(t, 2), F(t, 3));
+                    M(t, 0) = (2 * i >= n) + 2 * (2 * j >= n) + 4 * (2 * k >= n);
+                    t++;
+                }
+}
+
+}
+
+bool MESHIO::shapeFromName(const std::string &name, GeneratedShape &shape)
+{
+    const pair<const char *, GeneratedShape> names[] = {
+        {"sphere", GeneratedShape::Sphere}, {"torus", GeneratedShape::Torus}, {"shells", GeneratedShape::Shells},
+        {"patches", GeneratedShape::Patches}, {"soup", GeneratedShape::Soup}, {"markers", GeneratedShape::Markers},
+        {"tets", GeneratedShape::Tetrahedra}};
+    for(const auto &entry : names) {
+        if(name == entry.first) {
+            shape = entry.second;
+            return true;
+        }
+    }
+    std::cout << "Unknown shape - " << name << ". (sphere, torus, shells, patches, soup, markers, tets)" << std::endl;
+    return false;
+}
+
+/**
+ * Generate a synthetic mesh, see GeneratedShape.
+ * @return 1/-1
+ */
+int MESHIO::generateMesh(const GeneratorOptions &opt, Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M)
+{
+    if(opt.facets <= 0) {
+        std::cout << "The facet count must be positive." << std::endl;
+        return -1;
+    }
+    Random random(opt.seed);
+    if(opt.shape == GeneratedShape::Tetrahedra) {
+        cubeTetrahedra(max(1, (int)lround(cbrt(opt.facets / 6.0))), random, V, F, M);
+        return 1;
+    }
+    Builder b;
+    switch(opt.shape) {
+    case GeneratedShape::Sphere:
+        geodesicSphere(b, sphereFrequency(opt.facets), Eigen::Vector3d::Zero(), 1.0, 0);
+        break;
+    case GeneratedShape::Torus:
+    case GeneratedShape::Patches: {
+        const int v = max(3, (int)lround(sqrt(opt.facets / 4.0)));
+        torus(b, 2 * v, v, 8, opt.shape == GeneratedShape::Patches ? &random : nullptr);
+        break;
+    }
+    case GeneratedShape::Shells: {
+        // Frequency 2 shells, 80 facets each, on a cubic grid.
+        const long count = max(1L, opt.facets / 80);
+        const long side = (long)ceil(cbrt((double)count));
+        for(long k = 0; k < count; k++) {
+            Eigen::Vector3d center(3.0 * (k % side), 3.0 * (k / side % side), 3.0 * (k / (side * side)));
+            geodesicSphere(b, 2, center, 1.0, (int)k);
+        }
+        break;
+    }
+    case GeneratedShape::Soup: {
+        Builder sphere;
+        geodesicSphere(sphere, sphereFrequency(opt.facets), Eigen::Vector3d::Zero(), 1.0, 0);
+        const long nF = sphere.facets.size() / 3;
+        for(long i = 0; i < nF; i++) {
+            int corners[3];
+            for(int k = 0; k < 3; k++) {
+                const int p = sphere.facets[3 * i + k];
+                corners[k] = b.addPoint(Eigen::Vector3d(sphere.points[3 * p], sphere.points[3 * p + 1], sphere.points[3 * p + 2]));
+            }
+            // About 1% zero-area triangles, collapsed onto their first corner.
+            if(random.uniform() < 0.01) {
+                for(int k = 1; k < 3; k++)
+                    for(int d = 0; d < 3; d++)
+                        b.points[3 * corners[k] + d] = b.points[3 * corners[0] + d];
+            }
+            b.addFacet(corners[0], corners[1], corners[2], 0);
+        }
+        break;
+    }
+    case GeneratedShape::Markers: {
+        geodesicSphere(b, sphereFrequency(opt.facets), Eigen::Vector3d::Zero(), 1.0, 0);
+        const long nF = b.marks.size();
+        const int groups = max(1, opt.groups);
+        for(long i = 0; i < nF; i++)
+            b.marks[i] = (int)(i * groups / nF);
+        break;
+    }
+    case GeneratedShape::Tetrahedra:
+        break;
+    }
+    b.copyTo(V, F, M);
+    return 1;
+}
@@ -0,0 +1,36 @@
+#ifndef MESH_GENERATOR_H
+#define MESH_GENERATOR_H
+
+#include <Eigen/Dense>
+#include <string>
+
+namespace MESHIO {
+
+	/**
+	 * Synthetic test meshes, all deterministic for a given seed on every platform.
+	 *  sphere: geodesic sphere, an icosahedron with every face split into n x n triangles.
+	 *  torus: closed torus, twice as many segments around the hole as around the tube.
+	 *  shells: many small disjoint spheres on a grid.
+	 *  patches: torus cut into 8 x 8 patches, each one reversed with probability 1/2, for
+	 *           the orientation code. The marker is the patch id.
+	 *  soup: sphere triangles that each have their own three points, with about 1% of
+	 *        zero-area triangles, for repair.
+	 *  markers: sphere with its facets spread over groups marker groups, for OBJ grouping.
+	 *  tets: unit cube of n^3 cells, 6 tetrahedra each (F has 4 columns), about half of them
+	 *        inverted, for surface extraction. The marker is the octant of the cube.
+	 * The facet count is met as closely as the shape allows.
+	 */
+	enum class GeneratedShape { Sphere, Torus, Shells, Patches, Soup, Markers, Tetrahedra };
+
+	struct GeneratorOptions {
+		GeneratedShape shape = GeneratedShape::Sphere;
+		long facets = 100000;
+		int groups = 64;          // markers only
+		unsigned long seed = 1;   // patches, soup and tets
+	};
+
+	bool shapeFromName(const std::string &name, GeneratedShape &shape);
+	int generateMesh(const GeneratorOptions &opt, Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M);
+};
+
+#endif
@@ -0,0 +1,561 @@
+#include "MeshInspect.h"
+#include "MiniJson.h"
+#include "MeshBinary.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#define SCAN_CHUNK (4 << 20)
+#define MAX_LINE 4096
+
+using namespace std;
+
+namespace {
+
+/**
+ * Positioned reads of a file. Scans go chunk by chunk with memchr, which the C library
+ * vectorizes, and never parse the data they skip.
+ */
+class FileScanner {
+public:
+    FILE *f = nullptr;
+    long size = 0;
+
+    ~FileScanner() {
+        if(f)
+            fclose(f);
+    }
+    bool open(const std::string &filename) {
+        f = fopen(filename.c_str(), "rb");
+        if(!f)
+            return false;
+        fseeko(f, 0, SEEK_END);
+        size = (long)ftello(f);
+        return true;
+    }
+    size_t readAt(long offset, char *out, size_t count) {
+        if(offset < 0 || offset >= size || fseeko(f, offset, SEEK_SET) != 0)
+            return 0;
+        return fread(out, 1, count, f);
+    }
+    // Line at offset without its end of line, offset moves to the next line.
+    bool readLine(long &offset, std::string &line) {
+        char buffer[MAX_LINE];
+        size_t n = readAt(offset, buffer, sizeof(buffer));
+        if(n == 0)
+            return false;
+        const char *end = (const char *)memchr(buffer, '\n', n);
+        size_t len = end ? (size_t)(end - buffer) : n;
+        offset += (long)len + (end ? 1 : 0);
+        line.assign(buffer, len);
+        if(!line.empty() && line.back() == '\r')
+            line.pop_back();
+        return true;
+    }
+    // Next non-empty line.
+    bool nextLine(long &offset, std::string &line) {
+        while(readLine(offset, line))
+            if(line.find_first_not_of(" \t") != std::string::npos)
+                return true;
+        return false;
+    }
+    /**
+     * Offset of the first line at or after from that starts with keyword, -1 if none.
+     * memchr jumps to the candidates: numeric data has none of the letters keywords start with.
+     */
+    long findLine(long from, const char *keyword) {
+        const size_t len = strlen(keyword);
+        vector<char> chunk(min((long)SCAN_CHUNK, max(0L, size - from)) + len);
+        const size_t step = chunk.size() - len;
+        for(long pos = from; pos < size; pos += step) {
+            size_t n = readAt(pos, chunk.data(), chunk.size());
+            const char *p = chunk.data(), *end = chunk.data() + min(n, step);
+            while((p = (const char *)memchr(p, keyword[0], end - p)) != nullptr) {
+                long at = pos + (p - chunk.data());
+                bool lineStart = at == 0 || (p > chunk.data() ? p[-1] == '\n' : precededByNewline(at));
+                if(lineStart && (size_t)(chunk.data() + n - p) >= len && memcmp(p, keyword, len) == 0)
+                    return at;
+                p++;
+            }
+        }
+        return -1;
+    }
+    /**
+     * findLine for several keywords in one pass: offsets[k] is the first line at or after from
+     * that starts with keywords[k], -1 if none. memchr goes from line to line, and the scan
+     * stops once every keyword is found.
+     */
+    void findLines(long from, const char *const *keywords, int count, long *offsets) {
+        size_t len = 0;
+        for(int k = 0; k < count; k++) {
+            offsets[k] = -1;
+            len = max(len, strlen(keywords[k]));
+        }
+        int left = count;
+        vector<char> chunk(min((long)SCAN_CHUNK, max(0L, size - from)) + len);
+        const size_t step = chunk.size() - len;
+        for(long pos = from; left > 0 && pos < size; pos += step) {
+            size_t n = readAt(pos, chunk.data(), chunk.size());
+            const char *p = chunk.data(), *end = chunk.data() + min(n, step);
+            if(pos > 0 && !precededByNewline(pos))
+                p = (const char *)memchr(p, '\n', end - p);
+            for(; left > 0 && p != nullptr && p < end; p = (const char *)memchr(p, '\n', end - p)) {
+                if(*p == '\n')
+                    p++;
+                for(int k = 0; k < count && p < end; k++) {
+                    const size_t kLen = strlen(keywords[k]);
+                    if(offsets[k] < 0 && (size_t)(chunk.data() + n - p) >= kLen && memcmp(p, keywords[k], kLen) == 0) {
+                        offsets[k] = pos + (p - chunk.data());
+                        left--;
+                    }
+                }
+            }
+        }
+    }
+    // Offset just after the count-th newline from offset, -1 if the file ends first.
+    long skipLines(long offset, long count) {
+        vector<char> chunk(min((long)SCAN_CHUNK, max(1L, size - offset)));
+        for(long pos = offset; count > 0 && pos < size; pos += chunk.size()) {
+            size_t n = readAt(pos, chunk.data(), chunk.size());
+            const char *p = chunk.data(), *end = chunk.data() + n;
+            while(count > 0 && (p = (const char *)memchr(p, '\n', end - p)) != nullptr) {
+                p++;
+                if(--count == 0)
+                    return pos + (p - chunk.data());
+            }
+        }
+        return count == 0 ? offset : -1;
+    }
+
+private:
+    bool precededByNewline(long at) {
+        char c;
+        return readAt(at - 1, &c, 1) == 1 && c == '\n';
+    }
+};
+
+std::string lowerExtension(const std::string &filename)
+{
+    size_t dotpos = filename.find_last_of('.');
+    std::string ext = dotpos == std::string::npos ? "" : filename.substr(dotpos + 1);
+    transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext;
+}
+
+std::string cornerType(int nCorner)
+{
+    if(nCorner == 3) return "triangle";
+    if(nCorner == 4) return "quad";
+    if(nCorner > 4) return "polygon";
+    return "";
+}
+
+// VTK cell type ids of the legacy format.
+std::string vtkCellType(int type)
+{
+    switch(type) {
+    case 5: return "triangle";
+    case 7: return "polygon";
+    case 9: return "quad";
+    case 10: return "tetra";
+    case 12: return "hexahedron";
+    case 13: return "wedge";
+    case 14: return "pyramid";
+    default: return "vtk type " + to_string(type);
+    }
+}
+
+int vtkTypeSize(const std::string &type)
+{
+    if(type == "double" || type == "long" || type == "unsigned_long" || type == "vtktypeint64") return 8;
+    if(type == "short" || type == "unsigned_short") return 2;
+    if(type == "char" || type == "unsigned_char" || type == "bit") return 1;
+    return 4;
+}
+
+uint32_t bigEndian32(const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+int inspectVTK(FileScanner &file, MESHIO::MeshHeader &header)
+{
+    std::string line, keyword;
+    long offset = 0;
+    file.readLine(offset, line);                 // # vtk DataFile Version x.x
+    std::string version = line.substr(line.find_last_of(' ') + 1);
+    file.readLine(offset, line);                 // title
+    file.nextLine(offset, line);                 // ASCII | BINARY
+    const bool binary = line.find("BINARY") != std::string::npos;
+    std::string dataset;
+    while(file.nextLine(offset, line)) {
+        std::stringstream ss(line);
+        ss >> keyword;
+        if(keyword == "DATASET")
+            ss >> dataset;
+        if(keyword == "POINTS")
+            break;
+    }
+    header.variant = std::string(binary ? "BINARY " : "ASCII ") + dataset + " " + version;
+    if(keyword != "POINTS") {
+        std::cout << "The format of VTK file is illegal, No POINTS. - " << std::endl;
+        return -1;
+    }
+    std::string type;
+    std::stringstream(line) >> keyword >> header.nPoints >> type;
+
+    const std::string cellKeyword = dataset == "POLYDATA" ? "POLYGONS" : "CELLS";
+    long cells;
+    if(binary) {
+        cells = offset + header.nPoints * 3 * vtkTypeSize(type);
+        if(!file.nextLine(cells, line))
+            return 1;
+        std::stringstream(line) >> keyword;
+        if(keyword != cellKeyword)
+            return 1;
+    } else {
+        cells = file.findLine(offset, cellKeyword.c_str());
+        header.scanned = true;
+        if(cells < 0 || !file.readLine(cells, line))
+            return 1;
+    }
+    long size = 0;
+    std::stringstream(line) >> keyword >> header.nFacets >> size;
+    if(header.nFacets > 0 && size % header.nFacets == 0) {
+        header.nCorner = (int)(size / header.nFacets - 1);
+        header.elementType = cornerType(header.nCorner);
+    } else if(header.nFacets > 0) {
+        header.elementType = "mixed";
+    }
+
+    // Unstructured grids name the cell type, which tells quads from tetrahedra.
+    if(dataset == "UNSTRUCTURED_GRID") {
+        long types;
+        if(binary) {
+            types = cells + size * 4;
+            if(!file.nextLine(types, line) || line.compare(0, 10, "CELL_TYPES") != 0)
+                return 1;
+            unsigned char raw[4];
+            if(file.readAt(types, (char *)raw, 4) == 4)
+                header.elementType = vtkCellType((int)bigEndian32(raw));
+        } else {
+            types = file.findLine(cells, "CELL_TYPES");
+            header.scanned = true;
+            if(types < 0 || !file.readLine(types, line) || !file.nextLine(types, line))
+                return 1;
+            header.elementType = vtkCellType(atoi(line.c_str()));
+        }
+        if(header.elementType == "tetra" || header.elementType == "hexahedron")
+            header.nCorner = header.elementType == "tetra" ? 4 : 8;
+    }
+    return 1;
+}
+
+int inspectPLY(FileScanner &file, MESHIO::MeshHeader &header)
+{
+    std::string line, keyword, name;
+    long offset = 0;
+    std::string format;
+    bool inVertex = false;
+    long vertexBytes = 0;
+    std::string countType = "uchar";
+    while(file.readLine(offset, line) && line != "end_header") {
+        std::stringstream ss(line);
+        ss >> keyword;
+        if(keyword == "format") {
+            std::string version;
+            ss >> format >> version;
+            header.variant = format + " " + version;
+        } else if(keyword == "element") {
+            long count = 0;
+            ss >> name >> count;
+            inVertex = name == "vertex";
+            if(name == "vertex") header.nPoints = count;
+            if(name == "face") header.nFacets = count;
+        } else if(keyword == "property") {
+            std::string type;
+            ss >> type;
+            if(inVertex && type != "list") {
+                static const pair<const char *, int> sizes[] = {{"char", 1}, {"uchar", 1}, {"int8", 1}, {"uint8", 1},
+                    {"short", 2}, {"ushort", 2}, {"int16", 2}, {"uint16", 2}, {"int", 4}, {"uint", 4}, {"int32", 4},
+                    {"uint32", 4}, {"float", 4}, {"float32", 4}, {"double", 8}, {"float64", 8}};
+                for(const auto &s : sizes)
+                    if(type == s.first)
+                        vertexBytes += s.second;
+            }
+            if(type == "list")
+                ss >> countType;
+        }
+    }
+    if(header.nFacets <= 0)
+        return 1;
+
+    // The corner count is the list length of the first face, right after the vertices.
+    if(format == "ascii") {
+        long faces = file.skipLines(offset, header.nPoints);
+        header.scanned = true;
+        if(faces >= 0 && file.nextLine(faces, line))
+            header.nCorner = atoi(line.c_str());
+    } else if(countType == "uchar" || countType == "uint8" || countType == "char" || countType == "int8") {
+        unsigned char count;
+        if(file.readAt(offset + header.nPoints * vertexBytes, (char *)&count, 1) == 1)
+            header.nCorner = count;
+    }
+    header.elementType = cornerType(header.nCorner);
+    return 1;
+}
+
+int inspectPLS(FileScanner &file, MESHIO::MeshHeader &header)
+{
+    std::string line;
+    long offset = 0;
+    if(!file.readLine(offset, line))
+        return -1;
+    std::stringstream(line) >> header.nFacets >> header.nPoints;
+    header.nCorner = 3;
+    header.elementType = "triangle";
+    header.variant = "ASCII";
+    return 1;
+}
+
+int inspectMESH(FileScanner &file, MESHIO::MeshHeader &header)
+{
+    std::string line;
+    int dimension = 3;
+    // Every keyword is found in a single pass; counts of all element kinds are summed.
+    const char *keywords[] = {"Dimension", "Vertices", "Triangles", "Quadrilaterals", "Tetrahedra", "Hexahedra"};
+    const int corners[] = {3, 4, 4, 8};
+    const char *types[] = {"triangle", "quad", "tetra", "hexahedron"};
+    long at[6];
+    file.findLines(0, keywords, 6, at);
+    header.scanned = true;
+    long dim = at[0], vertices = at[1];
+    if(dim >= 0 && (vertices < 0 || dim < vertices) && file.readLine(dim, line)) {
+        std::stringstream ss(line.substr(9));
+        if(!(ss >> dimension) && file.nextLine(dim, line))
+            dimension = atoi(line.c_str());
+    }
+    header.variant = "ASCII dimension " + to_string(dimension);
+    if(vertices < 0 || !file.readLine(vertices, line) || !file.nextLine(vertices, line))
+        return 1;
+    header.nPoints = atol(line.c_str());
+
+    int kinds = 0;
+    for(int k = 0; k < 4; k++) {
+        long section = at[k + 2];
+        if(section < at[1] || !file.readLine(section, line) || !file.nextLine(section, line))
+            continue;
+        long count = atol(line.c_str());
+        if(count <= 0)
+            continue;
+        header.nFacets = max(0L, header.nFacets) + count;
+        header.nCorner = corners[k];
+        header.elementType = types[k];
+        kinds++;
+    }
+    if(kinds > 1) {
+        header.elementType = "mixed";
+        header.nCorner = -1;
+    }
+    return 1;
+}
+
+/**
+ * Binary GMF (.meshb): every keyword block starts with its code and the position of the
+ * next block, so the counts are read by jumping from block to block.
+ */
+int inspectMESHB(FileScanner &file, MESHIO::MeshHeader &header)
+{
+    int32_t code = 0, version = 0;
+    if(file.readAt(0, (char *)&code, 4) != 4 || file.readAt(4, (char *)&version, 4) != 4)
+        return -1;
+    const bool swap = code != 1;
+    auto fix32 = [&](int32_t v) { return swap ? (int32_t)__builtin_bswap32((uint32_t)v) : v; };
+    auto fix64 = [&](int64_t v) { return swap ? (int64_t)__builtin_bswap64((uint64_t)v) : v; };
+    version = fix32(version);
+    if(fix32(code) != 1 || version < 1 || version > 4) {
+        std::cout << "Not a GMF binary mesh file." << std::endl;
+        return -1;
+    }
+    header.variant = "GMF version " + to_string(version);
+    const int posBytes = version >= 3 ? 8 : 4;
+    const int countBytes = version >= 4 ? 8 : 4;
+    auto readInt = [&](long at, int bytes) -> long {
+        if(bytes == 8) {
+            int64_t v = 0;
+            return file.readAt(at, (char *)&v, 8) == 8 ? (long)fix64(v) : -1;
+        }
+        int32_t v = 0;
+        return file.readAt(at, (char *)&v, 4) == 4 ? (long)fix32(v) : -1;
+    };
+
+    enum { Dimension = 3, Vertices = 4, Triangles = 6, Quadrilaterals = 7, Tetrahedra = 8, Hexahedra = 10, End = 54 };
+    int kinds = 0;
+    long at = 8;
+    while(at > 0 && at < file.size) {
+        long keyword = readInt(at, 4);
+        long next = readInt(at + 4, posBytes);
+        long value = readInt(at + 4 + posBytes, keyword == Dimension ? 4 : countBytes);
+        if(keyword == End || keyword < 0)
+            break;
+        if(keyword == Dimension)
+            header.variant += " dimension " + to_string(value);
+        else if(keyword == Vertices)
+            header.nPoints = value;
+        else if(keyword == Triangles || keyword == Quadrilaterals || keyword == Tetrahedra || keyword == Hexahedra) {
+            header.nFacets = max(0L, header.nFacets) + value;
+            header.nCorner = keyword == Triangles ? 3 : keyword == Hexahedra ? 8 : 4;
+            header.elementType = keyword == Triangles ? "triangle" : keyword == Quadrilaterals ? "quad"
+                               : keyword == Tetrahedra ? "tetra" : "hexahedron";
+            kinds++;
+        }
+        if(next <= at)
+            break;
+        at = next;
+    }
+    if(kinds > 1) {
+        header.elementType = "mixed";
+        header.nCorner = -1;
+    }
+    return 1;
+}
+
+int inspectMCB(FileScanner &file, MESHIO::MeshHeader &header)
+{
+    MESHIO::McbHeader mcb;
+    if(file.readAt(0, (char *)&mcb, sizeof(mcb)) != sizeof(mcb) || memcmp(mcb.magic, "MCBMESH1", 8) != 0) {
+        std::cout << "Not a MCB mesh file." << std::endl;
+        return -1;
+    }
+    header.variant = "version " + to_string(mcb.version) + ", " + to_string(mcb.nArrays) + " arrays";
+    // V and T are the first arrays written.
+    MESHIO::McbArray arrays[2];
+    if(mcb.nArrays >= 2 && file.readAt(sizeof(mcb), (char *)arrays, sizeof(arrays)) == sizeof(arrays)) {
+        if(arrays[0].type == MESHIO::McbFloat32)
+            header.variant += ", float32 points";
+        if(arrays[1].type == MESHIO::McbInt64)
+            header.variant += ", int64 indices";
+    }
+    header.nPoints = (long)mcb.nPoints;
+    header.nFacets = (long)mcb.nFacets;
+    header.nCorner = (int)mcb.nCorner;
+    header.elementType = cornerType(header.nCorner);
+    return 1;
+}
+
+/**
+ * OBJ has no counts: count the lines starting with "v ", "f " and "g" with memchr over
+ * large chunks, and read only the first face line to know its corner count.
+ */
+int inspectOBJ(FileScanner &file, MESHIO::MeshHeader &header)
+{
+    header.nPoints = header.nFacets = header.nGroups = 0;
+    header.variant = "ASCII";
+    long firstFace = -1;
+    const size_t step = min((long)SCAN_CHUNK, max(1L, file.size));
+    vector<char> chunk(step + 2);
+    // The two characters after the last newline of a chunk are read with the chunk.
+    for(long pos = 0; pos < file.size; pos += step) {
+        size_t n = file.readAt(pos, chunk.data(), chunk.size());
+        const char *base = chunk.data();
+        const char *end = base + min(n, step);
+        const char *limit = base + n;
+        // Start of the next line to classify: the file start, then every newline + 1.
+        const char *line = pos == 0 ? base : (const char *)memchr(base, '\n', end - base);
+        if(line && pos != 0)
+            line++;
+        while(line) {
+            if(line < limit) {
+                const char c0 = *line;
+                const char c1 = line + 1 < limit ? line[1] : '\n';
+                if((c1 == ' ' || c1 == '\t') && c0 == 'v')
+                    header.nPoints++;
+                else if((c1 == ' ' || c1 == '\t') && c0 == 'f') {
+                    if(header.nFacets++ == 0)
+                        firstFace = pos + (line - base);
+                } else if(c0 == 'g')
+                    header.nGroups++;
+            }
+            if(line >= end)
+                break;
+            line = (const char *)memchr(line, '\n', end - line);
+            if(line)
+                line++;
+        }
+    }
+    std::string line;
+    if(firstFace >= 0 && file.readLine(firstFace, line)) {
+        std::stringstream ss(line.substr(1));
+        std::string corner;
+        header.nCorner = 0;
+        while(ss >> corner)
+            header.nCorner++;
+        header.elementType = cornerType(header.nCorner);
+    }
+    header.scanned = true;
+    return 1;
+}
+
+}
+
+/**
+ * Counts, element type and format variant of a mesh file, reading only its headers
+ * where the format allows.
+ * @return 1/-1
+ */
+int MESHIO::inspectMesh(const std::string &filename, MeshHeader &header)
+{
+    auto start = std::chrono::steady_clock::now();
+    header = MeshHeader();
+    FileScanner file;
+    if(!file.open(filename)) {
+        std::cout << "No such file. - " << filename << std::endl;
+        return -1;
+    }
+    header.fileBytes = file.size;
+    header.format = lowerExtension(filename);
+    int result;
+    if(header.format == "vtk") result = inspectVTK(file, header);
+    else if(header.format == "ply") result = inspectPLY(file, header);
+    else if(header.format == "pls") result = inspectPLS(file, header);
+    else if(header.format == "mesh") result = inspectMESH(file, header);
+    else if(header.format == "meshb") result = inspectMESHB(file, header);
+    else if(header.format == "obj") result = inspectOBJ(file, header);
+    else if(header.format == "mcb") result = inspectMCB(file, header);
+    else {
+        std::cout << "Unsupported input format - " << header.format << std::endl;
+        return -1;
+    }
+    header.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void MESHIO::printHeader(const MeshHeader &header)
+{
+    std::cout << "Format : " << header.format << " (" << header.variant << ")" << std::endl;
+    std::cout << "File size : " << header.fileBytes << " bytes" << std::endl;
+    std::cout << "Number of points : " << header.nPoints << std::endl;
+    std::cout << "Number of facets : " << header.nFacets << std::endl;
+    std::cout << "Element type : " << (header.elementType.empty() ? "unknown" : header.elementType) << std::endl;
+    if(header.nGroups >= 0)
+        std::cout << "Groups : " << header.nGroups << std::endl;
+    std::cout << "Inspected in " << header.seconds * 1000 << " ms" << (header.scanned ? " (data scanned)" : "") << std::endl;
+}
+
+std::string MESHIO::headerToJson(const MeshHeader &header)
+{
+    std::stringstream json;
+    json << "{\"format\": " << jsonString(header.format) << ", \"variant\": " << jsonString(header.variant);
+    json << ", \"element_type\": " << jsonString(header.elementType) << ", \"points\": " << header.nPoints;
+    json << ", \"facets\": " << header.nFacets << ", \"corners\": " << header.nCorner;
+    json << ", \"file_bytes\": " << header.fileBytes << ", \"scanned\": " << (header.scanned ? "true" : "false");
+    json << ", \"seconds\": " << header.seconds << "}";
+    return json.str();
+}
@@ -0,0 +1,33 @@
+#ifndef MESH_INSPECT_H
+#define MESH_INSPECT_H
+
+#include <string>
+
+namespace MESHIO {
+
+	/**
+	 * What can be known about a mesh file without loading it. Counts come from the
+	 * header where the format states them (PLS first line, VTK POINTS/CELLS, PLY header,
+	 * .mesh/.meshb keywords, .mcb header); the data between the headers is skipped, not parsed.
+	 * OBJ states nothing, so its lines are counted by a memchr scan that parses no number.
+	 * Unknown values are -1 or empty.
+	 */
+	struct MeshHeader {
+		std::string format;        // vtk, ply, pls, mesh, meshb, obj, mcb
+		std::string variant;       // e.g. "ASCII UNSTRUCTURED_GRID", "binary_little_endian 1.0", "GMF version 2"
+		std::string elementType;   // triangle, quad, polygon, tetra, hexahedron, mixed
+		long nPoints = -1;
+		long nFacets = -1;
+		int nCorner = -1;
+		long nGroups = -1;         // OBJ g lines
+		long fileBytes = 0;
+		bool scanned = false;      // data past the header was read (OBJ, ASCII .mesh, ASCII VTK and PLY)
+		double seconds = 0.0;
+	};
+
+	int inspectMesh(const std::string &filename, MeshHeader &header);
+	void printHeader(const MeshHeader &header);
+	std::string headerToJson(const MeshHeader &header);
+};
+
+#endif
@@ -0,0 +1,453 @@
+#ifndef MESH_LAYOUT_H
+#define MESH_LAYOUT_H
+
+#include "MeshTrace.h"
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace MESHIO {
+
+	/**
+	 * Storage order of a mesh in memory.
+	 *  AoS: row-major, the x y z of a point (the corners of a facet) are adjacent. Readers,
+	 *       writers and the operations that gather the corners of facets walk this way.
+	 *  SoA: column-major, all x then all y then all z. This is Eigen's default, the layout of
+	 *       Eigen::MatrixXd / MatrixXi everywhere else in MESHIO, and of .mcb files; loops over
+	 *       one coordinate of every point vectorize on it.
+	 */
+	enum class MeshLayout { AoS, SoA };
+
+	// Facets with 64-bit indices, for meshes of more than 2^31 - 1 points.
+	typedef Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic> MatrixXl;
+
+	/**
+	 * Scalar is the coordinate type, double or float (--float32). Index is the type of the
+	 * point indices: int keeps the facets at 4 bytes a corner, int64_t is for more points
+	 * than int can address (see needsIndex64).
+	 */
+	template<MeshLayout L, class Scalar = double, class Index = int> struct LayoutTypes;
+	template<class Scalar, class Index> struct LayoutTypes<MeshLayout::AoS, Scalar, Index> {
+		typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 3, Eigen::RowMajor> Points;
+		typedef Eigen::Matrix<Index, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Facets;
+	};
+	template<class Scalar, class Index> struct LayoutTypes<MeshLayout::SoA, Scalar, Index> {
+		typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Points;  // MatrixXd, MatrixXf
+		typedef Eigen::Matrix<Index, Eigen::Dynamic, Eigen::Dynamic> Facets;   // MatrixXi, MatrixXl
+	};
+
+	// A mesh in a layout chosen at compile time. Markers have one column, so no layout.
+	template<MeshLayout L, class Scalar = double, class Index = int> struct MeshData {
+		typename LayoutTypes<L, Scalar, Index>::Points V;
+		typename LayoutTypes<L, Scalar, Index>::Facets T;
+		Eigen::MatrixXi M;
+	};
+
+	// The only way between layouts: one explicit copy that reorders the arrays.
+	template<MeshLayout To, MeshLayout From, class Scalar, class Index>
+	MeshData<To, Scalar, Index> toLayout(const MeshData<From, Scalar, Index> &mesh)
+	{
+		MESH_TRACE("toLayout");
+		MeshData<To, Scalar, Index> out;
+		out.V = mesh.V;
+		out.T = mesh.T;
+		out.M = mesh.M;
+		return out;
+	}
+
+	/**
+	 * Writers and operations written once for any Eigen matrix or Map, so they run on both
+	 * layouts and on the views of a MappedMesh. The meshIO.h functions are these, on SoA.
+	 */
+	namespace Kernels {
+
+		// Digits that keep every value of the scalar: the historic 16 for double, 9 for float.
+		template<class Scalar> int outputPrecision()
+		{
+			return std::is_same<Scalar, float>::value ? std::numeric_limits<float>::max_digits10 : std::numeric_limits<double>::digits10 + 1;
+		}
+		template<class Scalar> const char *scalarName() { return std::is_same<Scalar, float>::value ? "float" : "double"; }
+
+		/**
+		 * Distance under which repair merges points and area under which it drops facets:
+		 * 1e-8 in double, and a few float ulps of a unit coordinate in float, where 1e-8 is
+		 * below the resolution of the coordinates themselves.
+		 */
+		template<class Scalar> double repairTolerance()
+		{
+			return std::max(1e-8, 8.0 * (double)std::numeric_limits<Scalar>::epsilon());
+		}
+
+		template<class MV, class MT, class MM>
+		int writeVTK(std::ostream &f, const MV &V, const MT &T, const MM &M, const std::string &mark_pattern = "")
+		{
+			MESH_TRACE("writeVTK");
+			f.precision(outputPrecision<typename MV::Scalar>());
+			f << "# vtk DataFile Version 2.0" << std::endl;
+			f << "TetWild Mesh" << std::endl;
+			f << "ASCII" << std::endl;
+			f << "DATASET UNSTRUCTURED_GRID" << std::endl;
+			f << "POINTS " << V.rows() << " " << scalarName<typename MV::Scalar>() << std::endl;
+			for(long i = 0; i < V.rows(); i++)
+				f << V(i, 0) << " " << V(i, 1) << " " << V(i, 2) << std::endl;
+			f << "CELLS " << T.rows() << " " << T.rows() * (T.cols() + 1) << std::endl;
+			for(long i = 0; i < T.rows(); i++) {
+				f << T.cols() << " ";
+				for(long j = 0; j < T.cols(); j++)
+					f << T(i, j) << " ";
+				f << std::endl;
+			}
+			f << "CELL_TYPES " << T.rows() << std::endl;
+			int cellType = 0;
+			if(T.cols() == 2)
+				cellType = 3;
+			else if(T.cols() == 3)
+				cellType = 5;
+			else if(T.cols() == 4)
+				cellType = 10;
+			for(long i = 0; i < T.rows(); i++)
+				f << cellType << std::endl;
+			if(M.rows() != T.rows())
+				return 1;
+			f << "CELL_DATA " << M.rows() << std::endl;
+			f << "SCALARS " << mark_pattern << " int " << M.cols() << std::endl;
+			f << "LOOKUP_TABLE default" << std::endl;
+			for(long i = 0; i < M.rows(); i++) {
+				for(long j = 0; j < M.cols(); j++)
+					f << M(i, j);
+				f << std::endl;
+			}
+			f << std::endl;
+			return 1;
+		}
+
+		template<class MV, class MT>
+		int writeMESH(std::ostream &f, const MV &V, const MT &T)
+		{
+			MESH_TRACE("writeMESH");
+			f.precision(outputPrecision<typename MV::Scalar>());
+			f << "MeshVersionFormatted 1" << std::endl;
+			f << "Dimension " << V.cols() << std::endl;
+			f << "Vertices" << std::endl;
+			f << V.rows() << std::endl;
+			for(long i = 0; i < V.rows(); i++) {
+				for(long j = 0; j < V.cols(); j++)
+					f << V(i, j) << " ";
+				f << i + 1 << std::endl;
+			}
+			if(T.cols() == 3)
+				f << "Triangles" << std::endl;
+			else if(T.cols() == 4)
+				f << "Tetrahedra" << std::endl;
+			else {
+				std::cout << "Unsupported format for .mesh file." << std::endl;
+				return -1;
+			}
+			f << T.rows() << std::endl;
+			for(long i = 0; i < T.rows(); i++) {
+				for(long j = 0; j < T.cols(); j++)
+					f << T(i, j) + 1 << " ";
+				f << i + 1 << std::endl;
+			}
+			return 1;
+		}
+
+		// normals, one row per point, are written as nx ny nz after the coordinates.
+		template<class MV, class MT>
+		int writePLY(std::ostream &plyfile, const MV &V, const MT &T, const Eigen::MatrixXd *normals = nullptr)
+		{
+			MESH_TRACE("writePLY");
+			if(T.cols() != 3) {
+				std::cout << "Unsupported format for .ply file." << std::endl;
+				return -1;
+			}
+			plyfile.precision(outputPrecision<typename MV::Scalar>());
+			plyfile << "ply" << std::endl;
+			plyfile << "format ascii 1.0" << std::endl;
+			plyfile << "comment VTK generated PLY File" << std::endl;
+			plyfile << "obj_info vtkPolyData points and polygons: vtk4.0" << std::endl;
+			plyfile << "element vertex " << V.rows() << std::endl;
+			plyfile << "property float x" << std::endl;
+			plyfile << "property float y" << std::endl;
+			plyfile << "property float z" << std::endl;
+			if(normals) {
+				plyfile << "property float nx" << std::endl;
+				plyfile << "property float ny" << std::endl;
+				plyfile << "property float nz" << std::endl;
+			}
+			plyfile << "element face " << T.rows() << std::endl;
+			plyfile << "property list uchar int vertex_indices" << std::endl;
+			plyfile << "end_header" << std::endl;
+			for(long i = 0; i < V.rows(); i++) {
+				plyfile << V(i, 0) << " " << V(i, 1) << " " << V(i, 2);
+				if(normals)
+					plyfile << " " << (*normals)(i, 0) << " " << (*normals)(i, 1) << " " << (*normals)(i, 2);
+				plyfile << std::endl;
+			}
+			for(long i = 0; i < T.rows(); i++)
+				plyfile << T.cols() << " " << T(i, 0) << " " << T(i, 1) << " " << T(i, 2) << std::endl;
+			return 1;
+		}
+
+		template<class MV, class MT, class MM>
+		int writePLS(std::ostream &plsfile, const MV &V, const MT &T, const MM &M)
+		{
+			MESH_TRACE("writePLS");
+			if(T.cols() != 3) {
+				std::cout << "Unsupported format for .pls file." << std::endl;
+				return -1;
+			}
+			plsfile << T.rows() << " " << V.rows() << " " << "0 0 0 0\n";
+			for(long i = 0; i < V.rows(); i++)
+				plsfile << i + 1 << " " << V(i, 0) << " " << V(i, 1) << " " << V(i, 2) << std::endl;
+			for(long i = 0; i < T.rows(); i++)
+				plsfile << i + 1 << " " << T(i, 0) + 1 << " " << T(i, 1) + 1 << " " << T(i, 2) + 1 << " " << (M.rows() >= T.rows() ? M(i, 0) : 0) + 1 << std::endl;
+			return 1;
+		}
+
+		template<class MV, class MT, class MM>
+		int writeFacet(std::ostream &facetfile, const MV &V, const MT &T, const MM &M)
+		{
+			MESH_TRACE("writeFacet");
+			facetfile.precision(outputPrecision<typename MV::Scalar>());
+			facetfile << "FACET FILE V3.0  exported from Meshconverter http://10.12.220.71/tools/meshconverter " << std::endl;
+			facetfile << 1 << std::endl;
+			facetfile << "Grid" << std::endl;
+			facetfile << "0, 0.00 0.00 0.00 0.00" << std::endl;
+			facetfile << V.rows() << std::endl;
+			for(long i = 0; i < V.rows(); i++)
+				facetfile << V(i, 0) << " " << V(i, 1) << " " << V(i, 2) << std::endl;
+			facetfile << 1 << std::endl;
+			facetfile << "Triangles" << std::endl;
+			facetfile << T.rows() << " 3" << std::endl;
+			for(long i = 0; i < T.rows(); i++) {
+				facetfile << " " << T(i, 0) + 1 << " " << T(i, 1) + 1 << " " << T(i, 2) + 1 << " 0 ";
+				if(M.rows() >= T.rows())
+					facetfile << M(i, 0);
+				else
+					facetfile << 0;
+				facetfile << " " << i + 1 << std::endl;
+			}
+			return 0;
+		}
+
+		// normals, one row per point, are written as vn lines and referenced as f v//v.
+		template<class MV, class MT, class MM>
+		int writeOBJ(std::ostream &objFile, const MV &V, const MT &F, const MM &M, const Eigen::MatrixXd *normals = nullptr)
+		{
+			MESH_TRACE("writeOBJ");
+			// Facet group
+			typedef typename MT::Scalar Index;
+			bool doGroup = (M.rows() == F.rows());
+			std::vector<std::vector<Index>> flist;
+			for(long i = 0; i < F.rows(); i++) {
+				std::vector<Index> facet;
+				facet.push_back(doGroup ? M(i, 0) : 0);
+				for(long j = 0; j < F.cols(); j++) {
+					facet.push_back(F(i, j));
+				}
+				flist.push_back(facet);
+			}
+			if(doGroup) {
+				std::sort(flist.begin(), flist.end(), [](std::vector<Index> A, std::vector<Index> B){ return A[0] < B[0]; });
+			}
+
+			objFile.precision(outputPrecision<typename MV::Scalar>());
+
+			// Get current time.
+			std::string export_time;
+			char stime[256] = {0};
+			time_t now_time;
+			time(&now_time);
+			strftime(stime, sizeof(stime), "%H:%M:%S", localtime(&now_time));
+			export_time = stime;
+
+			// Header
+			objFile << "# TIGER Mesh converter. (c) 2021." << std::endl;
+			objFile << "# Created File: " << export_time << std::endl;
+			objFile << "# " << std::endl;
+			objFile << "# object default" << std::endl;
+			objFile << "# " << std::endl;
+			objFile << std::endl;
+
+			// Write points
+			for(long i = 0; i < V.rows(); i++) {
+				objFile << "v";
+				for(long j = 0; j < V.cols(); j++) {
+					objFile << " " << V(i, j);
+				}
+				objFile << std::endl;
+			}
+			objFile << "# " << V.rows() << " vertices" << std::endl << std::endl;
+			if(normals) {
+				for(long i = 0; i < normals->rows(); i++)
+					objFile << "vn " << (*normals)(i, 0) << " " << (*normals)(i, 1) << " " << (*normals)(i, 2) << std::endl;
+				objFile << "# " << normals->rows() << " vertex normals" << std::endl << std::endl;
+			}
+
+			// Write facets with groups
+			int curGroup = INT_MIN;
+			for(size_t i = 0; i < flist.size(); i++) {
+				if(flist[i][0] != curGroup) {
+					curGroup = flist[i][0];
+					objFile << "g " << curGroup << std::endl;
+				}
+				objFile << "f";
+				for(size_t j = 1; j < flist[i].size(); j++) {
+					objFile << " " << flist[i][j] + 1;
+					if(normals)
+						objFile << "//" << flist[i][j] + 1;
+				}
+				objFile << std::endl;
+			}
+
+			// Write facets
+			objFile << "# " << F.rows() << " faces" << std::endl << std::endl;
+
+			return 1;
+		}
+
+		template<class MT>
+		bool reverseOrient(MT &T)
+		{
+			MESH_TRACE("reverseOrient");
+			std::cout << "Reversing\n";
+			for(long i = 0; i < T.rows(); i++)
+			{
+				typename MT::Scalar t = T(i, 0);
+				T(i, 0) = T(i, 2);
+				T(i, 2) = t;
+			}
+			std::cout << "reversed\n";
+			return 1;
+		}
+
+		/**
+		 * Remove the facets of zero area and merge the points closer than repairTolerance.
+		 * V and T are plain matrices, resized in place.
+		 */
+		template<class MV, class MT, class MM>
+		bool repair(MV &V, MT &T, const MM &M)
+		{
+			MESH_TRACE("repair");
+			typedef typename MV::Scalar Scalar;
+			typedef typename MT::Scalar Index;
+			typedef Eigen::Matrix<Scalar, 3, 1> Point;
+			const double tolerance = repairTolerance<Scalar>();
+
+			std::cout << "Vertex number is  " << V.rows() << " X " << V.cols() << "  before clean. \n";
+			std::cout << "Cell number is  " << T.rows() << " X " << T.cols() << "  before clean. \n";
+			std::cout << "Attribute number is  " << M.rows() << " X " << M.cols() << "  before clean. \n";
+			// 检测面积为0的单元个数
+
+			Eigen::Matrix<Scalar, 3, 3> Tri;
+			std::vector<long> emptyTri;
+			for(long i = 0; i < T.rows(); i++)
+			{
+				for(int j = 0; j < 3; j++)
+				{
+					Tri(j, 0) = V(T(i, j), 0);
+					Tri(j, 1) = V(T(i, j), 1);
+					Tri(j, 2) = V(T(i, j), 2);
+				}
+				Point lin1(Tri(1, 0) - Tri(0, 0), Tri(1, 1) - Tri(0, 1), Tri(1, 2) - Tri(0, 2));
+				Point lin2(Tri(2, 0) - Tri(0, 0), Tri(2, 1) - Tri(0, 1), Tri(2, 2) - Tri(0, 2));
+
+				Point crossResult = lin1.cross(lin2);
+				double area = crossResult.norm();
+				if(area < tolerance)
+				{
+					emptyTri.push_back(i);
+				}
+			}
+
+			std::cout << "There are " << emptyTri.size() << " cells whose area is equal to zero.\n";
+
+			// 去除面积为0的单元
+
+			struct node
+			{
+				Index oldid;
+				Point point;
+			};
+			std::vector<node> vec(V.rows(), node());
+			std::map<Index, Index> mpid;
+
+			for(long i = 0; i < V.rows(); i++)
+			{
+				vec[i].oldid = i;
+				vec[i].point = V.row(i).transpose();
+			}
+
+			std::sort(vec.begin(), vec.end(), [](const node& a, const node& b)
+			{
+				if( a.point.x() != b.point.x() ) return a.point.x() < b.point.x();
+				if( a.point.y() != b.point.y() ) return a.point.y() < b.point.y();
+				if( a.point.z() != b.point.z() ) return a.point.z() < b.point.z();
+				return a.oldid < b.oldid;
+			});
+
+			Index curid = 0;
+			for(size_t i = 0; i < vec.size(); i++)
+			{
+				while( i + 1 < vec.size() && (vec[i].point - vec[i + 1].point).norm() < tolerance )
+				{
+					mpid[vec[i].oldid] = curid;
+					i++;
+				}
+				mpid[vec[i].oldid] = curid;
+				curid++;
+			}
+
+			V.resize(curid, V.cols());
+
+			for(size_t i = 0; i < vec.size(); i++)
+			{
+				V.row(mpid[ vec[i].oldid ]) = vec[i].point.transpose();
+				while( i + 1 < vec.size() && (vec[i].point - vec[i + 1].point).norm() < tolerance ) i++;
+			}
+
+			MT T2(T.rows() - emptyTri.size(), T.cols());
+
+			long locT2 = 0, locEmptyTri = 0;
+			for(long i = 0; i < T.rows(); i++)
+			{
+				if(locEmptyTri < (long)emptyTri.size() && emptyTri[locEmptyTri] == i)
+				{
+					locEmptyTri++;
+					continue;
+				}
+				for(long j = 0; j < T.cols(); j++)
+				{
+					T2(locT2, j) = mpid[T(i, j)];
+				}
+				locT2++;
+			}
+
+			T = T2;
+
+			std::cout << "Vertex number is  " << V.rows() << " X " << V.cols() << "  after clean. \n";
+			std::cout << "Cell number is  " << T.rows() << " X " << T.cols() << "  after clean. \n";
+			std::cout << "Attribute number is  " << M.rows() << " X " << M.cols() << "  after clean. \n";
+			std::cout << "Clean all cell whose area is equal to zero. " << '\n';
+			return 0;
+		}
+	}
+
+	template<MeshLayout L, class Scalar, class Index>
+	bool repair(MeshData<L, Scalar, Index> &mesh) { return Kernels::repair(mesh.V, mesh.T, mesh.M); }
+
+	template<MeshLayout L, class Scalar, class Index>
+	bool reverseOrient(MeshData<L, Scalar, Index> &mesh) { return Kernels::reverseOrient(mesh.T); }
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include "MeshNormals.h"
+#include "MeshTrace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/**
+ * One pass over the triangles: unit normal N and the weight of the triangle at each of its
+ * corners W. The points are read column by column, so the cross products of consecutive
+ * triangles are plain arithmetic on doubles that the compiler vectorizes.
+ */
+void faceNormals(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, Eigen::MatrixXd &N, Eigen::MatrixXd *W, MESHIO::NormalWeighting weighting)
+{
+    const long nF = F.rows();
+    const double *x = V.col(0).data(), *y = V.col(1).data(), *z = V.col(2).data();
+    N.resize(nF, 3);
+    if(W)
+        W->resize(nF, 3);
+#pragma omp parallel for schedule(static)
+    for(long f = 0; f < nF; f++) {
+        const int a = F(f, 0), b = F(f, 1), c = F(f, 2);
+        const double ux = x[b] - x[a], uy = y[b] - y[a], uz = z[b] - z[a];
+        const double vx = x[c] - x[a], vy = y[c] - y[a], vz = z[c] - z[a];
+        const double nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+        const double length = sqrt(nx * nx + ny * ny + nz * nz);
+        const double scale = length > 0 ? 1.0 / length : 0.0;
+        N(f, 0) = nx * scale;
+        N(f, 1) = ny * scale;
+        N(f, 2) = nz * scale;
+        if(!W)
+            continue;
+        if(weighting == MESHIO::NormalWeighting::Area) {
+            (*W)(f, 0) = (*W)(f, 1) = (*W)(f, 2) = 0.5 * length;
+            continue;
+        }
+        // Corner angles from the edge vectors, atan2 stays accurate for needle triangles.
+        const double wx = x[c] - x[b], wy = y[c] - y[b], wz = z[c] - z[b];
+        auto angle = [length](double px, double py, double pz, double qx, double qy, double qz) {
+            return atan2(length, px * qx + py * qy + pz * qz);
+        };
+        (*W)(f, 0) = angle(ux, uy, uz, vx, vy, vz);
+        (*W)(f, 1) = angle(-ux, -uy, -uz, wx, wy, wz);
+        (*W)(f, 2) = M_PI - (*W)(f, 0) - (*W)(f, 1);
+    }
+}
+
+}
+
+bool MESHIO::normalWeightingFromName(const std::string &name, NormalWeighting &weighting)
+{
+    if(name == "area")
+        weighting = NormalWeighting::Area;
+    else if(name == "angle")
+        weighting = NormalWeighting::Angle;
+    else {
+        std::cout << "Unknown normal weighting - " << name << ". (area, angle)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Unit normal of every triangle, by the right hand rule on its corners.
+ * @return 1/-1
+ */
+int MESHIO::computeFaceNormals(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, Eigen::MatrixXd &N)
+{
+    MESH_TRACE("computeFaceNormals");
+    if(F.cols() != 3) {
+        std::cout << "Normals need triangles." << std::endl;
+        return -1;
+    }
+    faceNormals(V, F, N, nullptr, NormalWeighting::Area);
+    return 1;
+}
+
+/**
+ * Unit point normals. The corners are gathered per point with a counting sort (CSR), so
+ * each point sums its own facets and the points are shared out among the threads
+ * without atomics or a reduction of per-thread copies.
+ * @return 1/-1
+ */
+int MESHIO::computeVertexNormals(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, Eigen::MatrixXd &N, NormalWeighting weighting)
+{
+    MESH_TRACE("computeVertexNormals");
+    if(F.cols() != 3) {
+        std::cout << "Normals need triangles." << std::endl;
+        return -1;
+    }
+    const long nV = V.rows();
+    const long nF = F.rows();
+    Eigen::MatrixXd faceN, W;
+    faceNormals(V, F, faceN, &W, weighting);
+
+    // Corners k = f * 3 + j of every point, counted and filled in parallel.
+    vector<long> offset(nV + 1, 0);
+#pragma omp parallel for schedule(static)
+    for(long f = 0; f < nF; f++)
+        for(int j = 0; j < 3; j++) {
+#pragma omp atomic
+            offset[F(f, j) + 1]++;
+        }
+    for(long v = 0; v < nV; v++)
+        offset[v + 1] += offset[v];
+    vector<long> corner(nF * 3);
+    vector<long> fill(offset.begin(), offset.end() - 1);
+#pragma omp parallel for schedule(static)
+    for(long f = 0; f < nF; f++)
+        for(int j = 0; j < 3; j++) {
+            long slot;
+#pragma omp atomic capture
+            slot = fill[F(f, j)]++;
+            corner[slot] = f * 3 + j;
+        }
+    vector<long>().swap(fill);
+
+    N.resize(nV, 3);
+#pragma omp parallel for schedule(static)
+    for(long v = 0; v < nV; v++) {
+        // The threads filled the corners in any order, sorted the sum does not depend on it.
+        sort(corner.begin() + offset[v], corner.begin() + offset[v + 1]);
+        double sum[3] = {0.0, 0.0, 0.0};
+        for(long k = offset[v]; k < offset[v + 1]; k++) {
+            const long f = corner[k] / 3;
+            const double w = W(f, corner[k] % 3);
+            for(int d = 0; d < 3; d++)
+                sum[d] += w * faceN(f, d);
+        }
+        const double length = sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+        const double scale = length > 0 ? 1.0 / length : 0.0;
+        for(int d = 0; d < 3; d++)
+            N(v, d) = sum[d] * scale;
+    }
+    return 1;
+}
+
+/**
+ * Compute the point and facet normals and append them to attributes, replacing the
+ * normals a previous call or the input file left there.
+ * @return 1/-1
+ */
+int MESHIO::addNormals(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, NormalWeighting weighting, MeshAttributes &attributes)
+{
+    Eigen::MatrixXd pointN, faceN;
+    if(computeVertexNormals(V, F, pointN, weighting) < 0 || computeFaceNormals(V, F, faceN) < 0)
+        return -1;
+    attributes.erase(remove_if(attributes.begin(), attributes.end(), [](const MeshAttribute &a) {
+        return a.kind == AttributeKind::Normals;
+    }), attributes.end());
+    attributes.emplace_back("Normals", true, pointN);
+    attributes.back().kind = AttributeKind::Normals;
+    attributes.emplace_back("FaceNormals", false, faceN);
+    attributes.back().kind = AttributeKind::Normals;
+    return 1;
+}
+
+const MESHIO::MeshAttribute *MESHIO::findPointNormals(const MeshAttributes &attributes, long nPoints)
+{
+    for(const MeshAttribute &a : attributes)
+        if(a.onPoints && a.kind == AttributeKind::Normals && a.components == 3 && a.rows == nPoints)
+            return &a;
+    return nullptr;
+}
@@ -0,0 +1,31 @@
+#ifndef MESH_NORMALS_H
+#define MESH_NORMALS_H
+
+#include "MeshAttributes.h"
+
+#include <Eigen/Dense>
+#include <string>
+
+namespace MESHIO {
+
+	/**
+	 * Weight of a facet in the normal of its corners.
+	 *  Area: the facet area, large facets dominate; the usual choice on even meshes.
+	 *  Angle: the angle of the facet at the corner, independent of how the fan around the
+	 *         point is split into facets.
+	 */
+	enum class NormalWeighting { Area, Angle };
+
+	bool normalWeightingFromName(const std::string &name, NormalWeighting &weighting);
+
+	// Unit normal of every triangle, zero for degenerate ones.
+	int computeFaceNormals(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, Eigen::MatrixXd &N);
+	// Unit normal of every point, the weighted sum of the normals of its facets. Unused points get zero.
+	int computeVertexNormals(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, Eigen::MatrixXd &N, NormalWeighting weighting = NormalWeighting::Area);
+	// Both, as the "Normals" point attribute and the "FaceNormals" cell attribute the writers export.
+	int addNormals(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, NormalWeighting weighting, MeshAttributes &attributes);
+	// The point normals among attributes (NORMALS kind, 3 components, one row per point), or null.
+	const MeshAttribute *findPointNormals(const MeshAttributes &attributes, long nPoints);
+};
+
+#endif
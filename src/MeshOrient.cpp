@@ -1,5 +1,6 @@
 #include "MeshOrient.h"
 #include "triMesh.h"
+#include "MeshTrace.h"
 
 #include <iostream>
 #include <unordered_map>
@@ -12,6 +13,7 @@ using namespace std;
 using namespace MESHIO;
 
 int MESHIO::resetOrientation(Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M){
+	MESH_TRACE("resetOrientation");
 
 	vector<vector<double>> point_list(V.rows(), vector<double>(V.cols()));
 	vector<vector<int>> facet_list(F.rows(), vector<int>(F.cols()));
@@ -67,6 +69,7 @@ sfMesh::sfMesh(std::vector<std::vector<double>> plist, std::vector<std::vector<i
 }
 
 void sfMesh::Init(std::vector<std::vector<double>> plist, std::vector<std::vector<int>> flist) {
+    MESH_TRACE("buildTopology");
     this->points.clear();
     this->facets.clear();
     for(int i = 0; i < plist.size(); i++) {
@@ -127,6 +130,7 @@ void sfMesh::Init(std::vector<std::vector<double>> plist, std::vector<std::vecto
 }
 
 void sfMesh::resetOrientation() {
+    MESH_TRACE("orientBlocks");
     vector<int> blockStart;
     for(int bcnt = 0; bcnt < this->nBlock; bcnt++) {
         for(int i = 0; i < facets.size(); i++) {
@@ -0,0 +1,492 @@
+#include "MeshPipeline.h"
+#include "meshIO.h"
+#include "MeshOrient.h"
+#include "MeshBoundary.h"
+#include "MeshTransform.h"
+#include "MeshStats.h"
+#include "MeshQuality.h"
+#include "MeshDecimate.h"
+#include "MeshTrace.h"
+#include "MeshLayout.h"
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+
+#define MAX_MARKER_TABLE (1 << 20)
+
+using namespace std;
+
+namespace {
+
+bool parseNumbers(const std::string &text, std::vector<double> &values)
+{
+    values.clear();
+    std::stringstream ss(text);
+    std::string item;
+    while(getline(ss, item, ',')) {
+        char *end;
+        double value = strtod(item.c_str(), &end);
+        if(end == item.c_str() || *end != '\0')
+            return false;
+        values.push_back(value);
+    }
+    return true;
+}
+
+MESHIO::PipelineStage globalStage(const std::string &name, std::function<int(Eigen::MatrixXd &, Eigen::MatrixXi &, Eigen::MatrixXi &)> run)
+{
+    MESHIO::PipelineStage stage;
+    stage.name = name;
+    stage.kind = MESHIO::StageKind::Global;
+    stage.run = run;
+    return stage;
+}
+
+// Tetrahedra to their boundary triangles, without the interior points. A surface is left as it is.
+template<class MF>
+int surfaceStage(Eigen::MatrixXd &V, MF &F, Eigen::MatrixXi &M)
+{
+    if(F.cols() == 3) {
+        std::cout << "The mesh is already a surface." << std::endl;
+        return 1;
+    }
+    MF S;
+    Eigen::MatrixXi SM;
+    if(MESHIO::extractSurface(V, F, M, S, SM) < 0)
+        return -1;
+    F.swap(S);
+    M.swap(SM);
+    long removed = MESHIO::removeUnreferencedPoints(V, F);
+    std::cout << "Removed " << removed << " interior points." << std::endl;
+    return 1;
+}
+
+MESHIO::PipelineStage rotateStage(const std::vector<double> &rotateVec)
+{
+    MESHIO::PipelineStage stage;
+    stage.name = "rotate";
+    stage.kind = MESHIO::StageKind::Vertex;
+    if(rotateVec.size() == 4)
+        stage.affine = MESHIO::rotationTransform(Eigen::Vector3d::Zero(), Eigen::Vector3d(rotateVec[0], rotateVec[1], rotateVec[2]), rotateVec[3]);
+    else
+        stage.affine = MESHIO::rotationTransform(Eigen::Vector3d(rotateVec[0], rotateVec[1], rotateVec[2]),
+                                                 Eigen::Vector3d(rotateVec[3], rotateVec[4], rotateVec[5]), rotateVec[6]);
+    return stage;
+}
+
+// One traversal of the points and one of the facets, in the same parallel region.
+// Points are transformed in double whatever they are stored in.
+template<class MV, class MF>
+void runMap(const MESHIO::PipelineStage &stage, MV &V, MF &F, Eigen::MatrixXi &M)
+{
+    typedef typename MV::Scalar Scalar;
+    typedef typename MF::Scalar Index;
+    const Eigen::Matrix4d &A = stage.affine;
+    const bool doPoints = !A.isIdentity() && V.cols() == 3;
+    const bool doFlip = stage.flip && F.cols() >= 3;
+    const bool doRemap = !stage.markerMap.empty();
+    if(doRemap && M.rows() != F.rows())
+        M = Eigen::MatrixXi::Zero(F.rows(), 1);
+
+    // Dense lookup when the remapped markers span a small range.
+    const int lo = doRemap ? stage.markerMap.begin()->first : 0;
+    const long span = doRemap ? (long)stage.markerMap.rbegin()->first - lo + 1 : 0;
+    vector<int> table;
+    if(doRemap && span <= MAX_MARKER_TABLE) {
+        table.resize(span);
+        for(long k = 0; k < span; k++)
+            table[k] = (int)(lo + k);
+        for(const auto &entry : stage.markerMap)
+            table[entry.first - lo] = entry.second;
+    }
+
+    const double a00 = A(0, 0), a01 = A(0, 1), a02 = A(0, 2), a03 = A(0, 3);
+    const double a10 = A(1, 0), a11 = A(1, 1), a12 = A(1, 2), a13 = A(1, 3);
+    const double a20 = A(2, 0), a21 = A(2, 1), a22 = A(2, 2), a23 = A(2, 3);
+    Scalar *x = doPoints ? V.col(0).data() : nullptr;
+    Scalar *y = doPoints ? V.col(1).data() : nullptr;
+    Scalar *z = doPoints ? V.col(2).data() : nullptr;
+    Index *c0 = doFlip ? F.col(0).data() : nullptr;
+    Index *c2 = doFlip ? F.col(2).data() : nullptr;
+    int *m = doRemap ? M.col(0).data() : nullptr;
+    const long nPoints = V.rows();
+    const long nFacets = F.rows();
+
+#pragma omp parallel
+    {
+        MESH_TRACE("map.worker");
+        if(doPoints) {
+#pragma omp for simd schedule(static) nowait
+            for(long i = 0; i < nPoints; i++) {
+                const double px = x[i], py = y[i], pz = z[i];
+                x[i] = (Scalar)(a00 * px + a01 * py + a02 * pz + a03);
+                y[i] = (Scalar)(a10 * px + a11 * py + a12 * pz + a13);
+                z[i] = (Scalar)(a20 * px + a21 * py + a22 * pz + a23);
+            }
+        }
+        if(doFlip || doRemap) {
+#pragma omp for schedule(static) nowait
+            for(long i = 0; i < nFacets; i++) {
+                if(doFlip) {
+                    const Index t = c0[i];
+                    c0[i] = c2[i];
+                    c2[i] = t;
+                }
+                if(doRemap) {
+                    if(!table.empty()) {
+                        const long k = (long)m[i] - lo;
+                        if(k >= 0 && k < span)
+                            m[i] = table[k];
+                    } else {
+                        auto it = stage.markerMap.find(m[i]);
+                        if(it != stage.markerMap.end())
+                            m[i] = it->second;
+                    }
+                }
+            }
+        }
+    }
+}
+
+}
+
+bool MESHIO::parseStage(const std::string &op, PipelineStage &stage)
+{
+    size_t colon = op.find(':');
+    const string name = op.substr(0, colon);
+    const string args = colon == string::npos ? "" : op.substr(colon + 1);
+    stage = PipelineStage();
+    stage.name = op;
+
+    if(name == "rotate" || name == "translate" || name == "scale" || name == "mirror") {
+        stage.kind = StageKind::Vertex;
+        return parseTransform({op}, stage.affine);
+    }
+    if(name == "reverse-orient") {
+        stage.kind = StageKind::Facet;
+        stage.flip = true;
+        return true;
+    }
+    if(name == "remap-marker") {
+        stage.kind = StageKind::Facet;
+        std::stringstream ss(args);
+        std::string pair;
+        while(getline(ss, pair, ',')) {
+            size_t eq = pair.find('=');
+            char *end1, *end2;
+            long from = eq == string::npos ? 0 : strtol(pair.c_str(), &end1, 10);
+            long to = eq == string::npos ? 0 : strtol(pair.c_str() + eq + 1, &end2, 10);
+            if(eq == string::npos || end1 != pair.c_str() + eq || *end2 != '\0') {
+                std::cout << "Illegal marker pair, expected from=to. - " << pair << std::endl;
+                return false;
+            }
+            stage.markerMap[(int)from] = (int)to;
+        }
+        if(stage.markerMap.empty()) {
+            std::cout << "remap-marker needs at least one from=to pair." << std::endl;
+            return false;
+        }
+        return true;
+    }
+    if(name == "box") {
+        vector<double> boxVec;
+        if(!parseNumbers(args, boxVec) || boxVec.size() != 3) {
+            std::cout << "box needs length,width,hight. - " << op << std::endl;
+            return false;
+        }
+        stage = globalStage(op, [boxVec](Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) {
+            return MESHIO::addBox(boxVec, V, F, M) ? 1 : -1;
+        });
+        return true;
+    }
+    if(name == "reset-orient") {
+        stage = globalStage(op, [](Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) {
+            return MESHIO::resetOrientation(V, F, M) < 0 ? -1 : 1;
+        });
+        return true;
+    }
+    if(name == "repair") {
+        stage = globalStage(op, [](Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) {
+            MESHIO::repair(V, F, M);
+            return 1;
+        });
+        stage.runFloat = [](Eigen::MatrixXf &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) {
+            MESHIO::Kernels::repair(V, F, M);
+            return 1;
+        };
+        stage.runLong = [](Eigen::MatrixXd &V, MESHIO::MatrixXl &F, Eigen::MatrixXi &M) {
+            MESHIO::Kernels::repair(V, F, M);
+            return 1;
+        };
+        return true;
+    }
+    if(name == "info") {
+        stage = globalStage(op, [](Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) {
+            MESHIO::MeshStats stats;
+            MESHIO::computeStats(V, F, M, stats);
+            MESHIO::printStats(stats);
+            return 1;
+        });
+        return true;
+    }
+    if(name == "quality") {
+        stage = globalStage(op, [](Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) {
+            MESHIO::MeshQuality quality;
+            if(MESHIO::computeQuality(V, F, quality) < 0)
+                return -1;
+            MESHIO::printQuality(quality);
+            return 1;
+        });
+        return true;
+    }
+    if(name == "surface") {
+        stage = globalStage(op, [](Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) {
+            return surfaceStage(V, F, M);
+        });
+        stage.runLong = [](Eigen::MatrixXd &V, MESHIO::MatrixXl &F, Eigen::MatrixXi &M) {
+            return surfaceStage(V, F, M);
+        };
+        return true;
+    }
+    if(name == "decimate") {
+        const size_t comma = args.find(',');
+        const string target = args.substr(0, comma);
+        const string mode = comma == string::npos ? "" : args.substr(comma + 1);
+        if(target.empty() || (mode != "" && mode != "parallel")) {
+            std::cout << "decimate needs a facet count or fraction, optionally followed by ,parallel. - " << op << std::endl;
+            return false;
+        }
+        stage = globalStage(op, [target, mode](Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) {
+            MESHIO::DecimateOptions options;
+            options.targetFacets = MESHIO::decimateTarget(target, F.rows());
+            options.parallel = mode == "parallel";
+            if(options.targetFacets < 0)
+                return -1;
+            return MESHIO::decimate(V, F, M, options) < 0 ? -1 : 1;
+        });
+        return true;
+    }
+    if(name == "boundary") {
+        stage = globalStage(op, [](Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) {
+            MESHIO::BoundaryLoops loops;
+            MESHIO::extractBoundary(V, F, loops);
+            MESHIO::printBoundary(loops);
+            return 1;
+        });
+        return true;
+    }
+    std::cout << "Unknown operation - " << op << std::endl;
+    return false;
+}
+
+bool MESHIO::buildPipeline(const ConvertOptions &opt, std::vector<PipelineStage> &stages, std::vector<std::string> *outputs)
+{
+    stages.clear();
+    PipelineStage stage;
+
+    if(opt.surface && parseStage("surface", stage))
+        stages.push_back(stage);
+    if(!opt.rotateVec.empty()) {
+        if(opt.rotateVec.size() != 4 && opt.rotateVec.size() != 7) {
+            std::cout << "The format is Error.Format is (start_x, start_y, start_z, end_x, end_y, end_z, angle) or (end_x, end_y, end_z, angle). angle value scale is (0, 2)." << std::endl;
+            return false;
+        }
+        stages.push_back(rotateStage(opt.rotateVec));
+    }
+    for(const std::string &op : opt.transformOps) {
+        if(!parseStage(op, stage) || stage.kind != StageKind::Vertex) {
+            std::cout << "Not a transform - " << op << std::endl;
+            return false;
+        }
+        stages.push_back(stage);
+    }
+    if(!opt.boxVec.empty()) {
+        vector<double> boxVec = opt.boxVec;
+        stages.push_back(globalStage("box", [boxVec](Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) {
+            MESHIO::addBox(boxVec, V, F, M);
+            return 1;
+        }));
+    }
+    if(opt.resetOrientation && parseStage("reset-orient", stage))
+        stages.push_back(stage);
+    if(opt.reverseOrient && parseStage("reverse-orient", stage))
+        stages.push_back(stage);
+    if(opt.repair && parseStage("repair", stage))
+        stages.push_back(stage);
+    if(!opt.decimate.empty()) {
+        if(!parseStage("decimate:" + opt.decimate + (opt.decimateParallel ? ",parallel" : ""), stage))
+            return false;
+        stages.push_back(stage);
+    }
+    if(opt.reportInfo && parseStage("info", stage))
+        stages.push_back(stage);
+    if(opt.reportBoundary || opt.exportBoundary) {
+        const string boundaryFile = opt.exportBoundary ? opt.outputBase() + ".boundary.vtk" : "";
+        if(!boundaryFile.empty() && outputs)
+            outputs->push_back(boundaryFile);
+        stages.push_back(globalStage("boundary", [boundaryFile](Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) {
+            MESHIO::BoundaryLoops loops;
+            MESHIO::extractBoundary(V, F, loops);
+            MESHIO::printBoundary(loops);
+            if(!boundaryFile.empty())
+                return MESHIO::writeBoundaryVTK(boundaryFile, V, loops);
+            return 1;
+        }));
+    }
+
+    if(opt.reportQuality || !opt.qualityJson.empty()) {
+        const string qualityFile = opt.qualityJson;
+        if(!qualityFile.empty() && outputs)
+            outputs->push_back(qualityFile);
+        stages.push_back(globalStage("quality", [qualityFile](Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M) {
+            MESHIO::MeshQuality quality;
+            if(MESHIO::computeQuality(V, F, quality) < 0)
+                return -1;
+            MESHIO::printQuality(quality);
+            if(!qualityFile.empty())
+                return MESHIO::writeQualityJson(qualityFile, quality) ? 1 : -1;
+            return 1;
+        }));
+    }
+
+    for(const std::string &op : opt.pipelineOps) {
+        if(!parseStage(op, stage))
+            return false;
+        stages.push_back(stage);
+    }
+    return true;
+}
+
+/**
+ * Vertex maps compose into one matrix, facet maps into one flip parity and one marker
+ * table, and the two commute, so any run of them is a single Map stage. A mirror in the
+ * composed matrix also flips the winding, as applyTransform does.
+ */
+std::vector<MESHIO::PipelineStage> MESHIO::fusePipeline(const std::vector<PipelineStage> &stages)
+{
+    std::vector<PipelineStage> fused;
+    for(const PipelineStage &stage : stages) {
+        if(stage.kind == StageKind::Global) {
+            fused.push_back(stage);
+            continue;
+        }
+        if(fused.empty() || fused.back().kind != StageKind::Map) {
+            PipelineStage map;
+            map.kind = StageKind::Map;
+            fused.push_back(map);
+        }
+        PipelineStage &map = fused.back();
+        map.name += (map.name.empty() ? "" : " + ") + stage.name;
+        if(stage.kind == StageKind::Vertex) {
+            map.affine = stage.affine * map.affine;
+            if(stage.affine.block<3, 3>(0, 0).determinant() < 0)
+                map.flip = !map.flip;
+        } else {
+            map.flip = map.flip != stage.flip;
+            if(!stage.markerMap.empty()) {
+                // Compose: markers already remapped go through the new map, new entries are added.
+                std::map<int, int> composed;
+                for(const auto &entry : map.markerMap) {
+                    auto it = stage.markerMap.find(entry.second);
+                    composed[entry.first] = it == stage.markerMap.end() ? entry.second : it->second;
+                }
+                for(const auto &entry : stage.markerMap)
+                    if(!composed.count(entry.first))
+                        composed[entry.first] = entry.second;
+                map.markerMap.swap(composed);
+            }
+        }
+    }
+    return fused;
+}
+
+namespace {
+
+int runGlobal(const MESHIO::PipelineStage &stage, Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M)
+{
+    return stage.run(V, F, M);
+}
+
+int runGlobal(const MESHIO::PipelineStage &stage, Eigen::MatrixXf &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M)
+{
+    if(stage.runFloat)
+        return stage.runFloat(V, F, M);
+    Eigen::MatrixXd wide = V.cast<double>();
+    int result = stage.run(wide, F, M);
+    V = wide.cast<float>();
+    return result;
+}
+
+int runGlobal(const MESHIO::PipelineStage &stage, Eigen::MatrixXd &V, MESHIO::MatrixXl &F, Eigen::MatrixXi &M)
+{
+    if(!stage.runLong) {
+        std::cout << "Operation not supported with 64-bit indices - " << stage.name << std::endl;
+        return -1;
+    }
+    return stage.runLong(V, F, M);
+}
+
+int runGlobal(const MESHIO::PipelineStage &stage, Eigen::MatrixXf &V, MESHIO::MatrixXl &F, Eigen::MatrixXi &M)
+{
+    Eigen::MatrixXd wide = V.cast<double>();
+    int result = runGlobal(stage, wide, F, M);
+    V = wide.cast<float>();
+    return result;
+}
+
+template<class MV, class MF>
+int runStages(const std::vector<MESHIO::PipelineStage> &stages, MV &V, MF &F, Eigen::MatrixXi &M,
+              std::vector<MESHIO::StageProfile> *profile)
+{
+    using namespace MESHIO;
+    for(const PipelineStage &stage : stages) {
+        MESH_TRACE("stage", stage.name);
+        StageTimer timer;
+        if(stage.kind == StageKind::Global) {
+            if(runGlobal(stage, V, F, M) < 0) {
+                std::cout << "Operation failed - " << stage.name << std::endl;
+                return -1;
+            }
+        } else {
+            PipelineStage map = stage;
+            if(stage.kind == StageKind::Vertex && stage.affine.block<3, 3>(0, 0).determinant() < 0)
+                map.flip = !map.flip;
+            runMap(map, V, F, M);
+        }
+        if(profile)
+            profile->push_back(timer.finish("op:" + stage.name, V.rows() + F.rows()));
+    }
+    return 1;
+}
+
+}
+
+/**
+ * Run the stages in order, Vertex and Facet stages that were not fused run as a Map of their own.
+ * @param profile optional, one record per stage is added to it.
+ * @return 1/-1, stops at the first failing stage.
+ */
+int MESHIO::runPipeline(const std::vector<PipelineStage> &stages, Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M,
+                         std::vector<StageProfile> *profile)
+{
+    return runStages(stages, V, F, M, profile);
+}
+
+int MESHIO::runPipeline(const std::vector<PipelineStage> &stages, Eigen::MatrixXf &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M,
+                         std::vector<StageProfile> *profile)
+{
+    return runStages(stages, V, F, M, profile);
+}
+
+int MESHIO::runPipeline(const std::vector<PipelineStage> &stages, Eigen::MatrixXd &V, MatrixXl &F, Eigen::MatrixXi &M,
+                         std::vector<StageProfile> *profile)
+{
+    return runStages(stages, V, F, M, profile);
+}
+
+int MESHIO::runPipeline(const std::vector<PipelineStage> &stages, Eigen::MatrixXf &V, MatrixXl &F, Eigen::MatrixXi &M,
+                         std::vector<StageProfile> *profile)
+{
+    return runStages(stages, V, F, M, profile);
+}
@@ -0,0 +1,65 @@
+#ifndef MESH_PIPELINE_H
+#define MESH_PIPELINE_H
+
+#include "MeshConvert.h"
+#include "MeshProfile.h"
+#include "MeshLayout.h"
+
+#include <Eigen/Dense>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace MESHIO {
+
+	/**
+	 * Kind of a pipeline stage.
+	 *  Vertex: affine map of every point (rotate, translate, scale, mirror).
+	 *  Facet: map of every facet on its own (reverse the winding, remap the marker).
+	 *  Map: consecutive vertex and facet stages fused into one parallel traversal.
+	 *  Global: needs the whole mesh (surface, box, reset-orient, repair, decimate, info, boundary, quality).
+	 */
+	enum class StageKind { Vertex, Facet, Map, Global };
+
+	struct PipelineStage {
+		std::string name;
+		StageKind kind = StageKind::Global;
+		Eigen::Matrix4d affine = Eigen::Matrix4d::Identity();  // Vertex and Map
+		bool flip = false;                                     // Facet and Map, reverse the winding
+		std::map<int, int> markerMap;                          // Facet and Map, markers not listed are kept
+		std::function<int(Eigen::MatrixXd &, Eigen::MatrixXi &, Eigen::MatrixXi &)> run;  // Global
+		// Global, optional: the stage on float points (--float32). Without it, run is given
+		// a double copy of the points, narrowed back afterwards.
+		std::function<int(Eigen::MatrixXf &, Eigen::MatrixXi &, Eigen::MatrixXi &)> runFloat;
+		// Global, optional: the stage on 64-bit indices. Without it, the stage fails on them.
+		std::function<int(Eigen::MatrixXd &, MatrixXl &, Eigen::MatrixXi &)> runLong;
+	};
+
+	/**
+	 * Operation strings of --op, applied in the given order:
+	 *   rotate:... | translate:... | scale:... | mirror:...   (see MeshTransform.h)
+	 *   reverse-orient | remap-marker:from=to[,from=to...]
+	 *   box:length,width,hight | reset-orient | repair | info | boundary | quality
+	 *   surface                                                (tetrahedra to their boundary triangles)
+	 *   decimate:target[,parallel]                             (target facet count, or fraction below 1)
+	 */
+	bool parseStage(const std::string &op, PipelineStage &stage);
+	/**
+	 * Stages of a conversion: the single operation flags in their fixed order, then the
+	 * --op list. The outputs of boundary-vtk and quality-json are added to outputs.
+	 */
+	bool buildPipeline(const ConvertOptions &opt, std::vector<PipelineStage> &stages, std::vector<std::string> *outputs = nullptr);
+	// Merge every run of consecutive vertex and facet stages into one Map stage.
+	std::vector<PipelineStage> fusePipeline(const std::vector<PipelineStage> &stages);
+	int runPipeline(const std::vector<PipelineStage> &stages, Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M,
+	                std::vector<StageProfile> *profile = nullptr);
+	int runPipeline(const std::vector<PipelineStage> &stages, Eigen::MatrixXf &V, Eigen::MatrixXi &F, Eigen::MatrixXi &M,
+	                std::vector<StageProfile> *profile = nullptr);
+	int runPipeline(const std::vector<PipelineStage> &stages, Eigen::MatrixXd &V, MatrixXl &F, Eigen::MatrixXi &M,
+	                std::vector<StageProfile> *profile = nullptr);
+	int runPipeline(const std::vector<PipelineStage> &stages, Eigen::MatrixXf &V, MatrixXl &F, Eigen::MatrixXi &M,
+	                std::vector<StageProfile> *profile = nullptr);
+};
+
+#endif
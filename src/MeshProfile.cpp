@@ -0,0 +1,135 @@
+#include "MeshProfile.h"
+#include "MiniJson.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+double MESHIO::processCPUSeconds()
+{
+#ifdef _WIN32
+    return 0.0;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.0;
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + 1e-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+#endif
+}
+
+long MESHIO::peakRSSKB()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;   // bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+long MESHIO::fileBytes(const std::string &filename)
+{
+    struct stat st;
+    if(stat(filename.c_str(), &st) != 0)
+        return 0;
+    return (long)st.st_size;
+}
+
+MESHIO::StageTimer::StageTimer()
+    : wallStart(std::chrono::steady_clock::now()), cpuStart(processCPUSeconds())
+{
+}
+
+MESHIO::StageProfile MESHIO::StageTimer::finish(const std::string &name, long elements, long bytesRead, long bytesWritten) const
+{
+    StageProfile stage;
+    stage.name = name;
+    stage.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    stage.cpuSeconds = processCPUSeconds() - cpuStart;
+    stage.elements = elements;
+    stage.bytesRead = bytesRead;
+    stage.bytesWritten = bytesWritten;
+    stage.peakRSSKB = peakRSSKB();
+    return stage;
+}
+
+void MESHIO::printProfile(const std::vector<StageProfile> &stages)
+{
+    StageProfile total;
+    total.name = "total";
+    char line[256];
+    printf("%-28s %10s %10s %12s %12s %12s %10s %12s\n", "stage", "wall(s)", "cpu(s)", "read(B)", "written(B)", "elements", "MB/s", "peakRSS(KB)");
+    auto print = [&](const StageProfile &s) {
+        double bytes = (double)(s.bytesRead + s.bytesWritten);
+        double rate = s.wallSeconds > 0 && bytes > 0 ? bytes / s.wallSeconds / (1 << 20) : 0.0;
+        snprintf(line, sizeof(line), "%-28s %10.4f %10.4f %12ld %12ld %12ld %10.1f %12ld",
+                 s.name.c_str(), s.wallSeconds, s.cpuSeconds, s.bytesRead, s.bytesWritten, s.elements, rate, s.peakRSSKB);
+        std::cout << line << std::endl;
+    };
+    for(const StageProfile &s : stages) {
+        print(s);
+        total.wallSeconds += s.wallSeconds;
+        total.cpuSeconds += s.cpuSeconds;
+        total.bytesRead += s.bytesRead;
+        total.bytesWritten += s.bytesWritten;
+        total.elements = std::max(total.elements, s.elements);
+        total.peakRSSKB = std::max(total.peakRSSKB, s.peakRSSKB);
+    }
+    print(total);
+    long hits = 0, misses = 0;
+    cacheCounts(stages, hits, misses);
+    if(hits + misses > 0)
+        std::cout << "cache: " << hits << " hits, " << misses << " misses" << std::endl;
+}
+
+// Result cache lookups among the stages.
+void MESHIO::cacheCounts(const std::vector<StageProfile> &stages, long &hits, long &misses)
+{
+    hits = misses = 0;
+    for(const StageProfile &s : stages) {
+        if(s.name == "cache:hit") hits++;
+        if(s.name == "cache:miss") misses++;
+    }
+}
+
+/**
+ * {"input": "...", "peak_rss_kb": n, "cache_hits": n, "cache_misses": n, "stages": [{"name": "parse:pls", "wall_seconds": ..,
+ *  "cpu_seconds": .., "bytes_read": .., "bytes_written": .., "elements": .., "peak_rss_kb": ..}, ...]}
+ */
+bool MESHIO::writeProfileJson(const std::string &filename, const std::string &input, const std::vector<StageProfile> &stages)
+{
+    std::ofstream f(filename);
+    if(!f.is_open()) {
+        std::cout << "Write profile failed. - " << filename << std::endl;
+        return false;
+    }
+    long peak = 0;
+    for(const StageProfile &s : stages)
+        peak = std::max(peak, s.peakRSSKB);
+    long hits, misses;
+    cacheCounts(stages, hits, misses);
+    f << "{\"input\": " << jsonString(input) << ", \"peak_rss_kb\": " << peak;
+    f << ", \"cache_hits\": " << hits << ", \"cache_misses\": " << misses << ", \"stages\": [";
+    for(size_t i = 0; i < stages.size(); i++) {
+        const StageProfile &s = stages[i];
+        f << (i ? ",\n  " : "\n  ") << "{\"name\": " << jsonString(s.name);
+        f << ", \"wall_seconds\": " << s.wallSeconds << ", \"cpu_seconds\": " << s.cpuSeconds;
+        f << ", \"bytes_read\": " << s.bytesRead << ", \"bytes_written\": " << s.bytesWritten;
+        f << ", \"elements\": " << s.elements << ", \"peak_rss_kb\": " << s.peakRSSKB << "}";
+    }
+    f << "\n]}\n";
+    return true;
+}
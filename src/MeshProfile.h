@@ -0,0 +1,45 @@
+#ifndef MESH_PROFILE_H
+#define MESH_PROFILE_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace MESHIO {
+
+	/**
+	 * Cost of one stage of a conversion: parse, an operation, or a writer.
+	 * CPU time is the process time, so it includes the OpenMP workers of the stage.
+	 * Peak RSS is the high-water mark of the process at the end of the stage.
+	 */
+	struct StageProfile {
+		std::string name;        // "parse:pls", "op:reset-orient", "write:vtk", ...
+		double wallSeconds = 0.0;
+		double cpuSeconds = 0.0;
+		long bytesRead = 0;
+		long bytesWritten = 0;
+		long elements = 0;       // points + facets handled
+		long peakRSSKB = 0;
+	};
+
+	// Measures one stage from its construction to finish().
+	class StageTimer {
+	public:
+		StageTimer();
+		StageProfile finish(const std::string &name, long elements, long bytesRead = 0, long bytesWritten = 0) const;
+
+	private:
+		std::chrono::steady_clock::time_point wallStart;
+		double cpuStart;
+	};
+
+	double processCPUSeconds();
+	long peakRSSKB();
+	long fileBytes(const std::string &filename);
+
+	void cacheCounts(const std::vector<StageProfile> &stages, long &hits, long &misses);
+	void printProfile(const std::vector<StageProfile> &stages);
+	bool writeProfileJson(const std::string &filename, const std::string &input, const std::vector<StageProfile> &stages);
+};
+
+#endif
@@ -0,0 +1,284 @@
+#include "MeshQuality.h"
+#include "MeshTrace.h"
+#include "MeshLayout.h"
+#include "MiniJson.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+using namespace std;
+
+namespace {
+
+const int RANGE_BINS = 20;          // edge length and area, between their min and max
+const long MAX_BLOCKS = 256;
+const double DEGREES = 180.0 / M_PI;
+
+// Histogram of one block of facets, merged into the total in block order.
+struct Accumulator {
+    const vector<double> *edges = nullptr;
+    vector<long> counts;
+    long count = 0;
+    double sum = 0.0;
+    double min = numeric_limits<double>::infinity();
+    double max = -numeric_limits<double>::infinity();
+
+    void reset(const vector<double> &binEdges) {
+        edges = &binEdges;
+        counts.assign(binEdges.size() - 1, 0);
+    }
+    // Values past the outer edges go to the first and last bins.
+    void add(double value) {
+        const long bins = (long)counts.size();
+        long b = (long)(upper_bound(edges->begin(), edges->end(), value) - edges->begin()) - 1;
+        counts[std::max(0L, std::min(b, bins - 1))]++;
+        count++;
+        sum += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+    void track(double value) {
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+    void merge(const Accumulator &other) {
+        for(size_t b = 0; b < counts.size(); b++)
+            counts[b] += other.counts[b];
+        count += other.count;
+        sum += other.sum;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+};
+
+void finish(const string &name, const vector<double> &edges, const Accumulator &total, MESHIO::QualityHistogram &h)
+{
+    h.name = name;
+    h.edges = edges;
+    h.counts = total.counts;
+    h.count = total.count;
+    h.min = total.count ? total.min : 0.0;
+    h.max = total.count ? total.max : 0.0;
+    h.mean = total.count ? total.sum / total.count : 0.0;
+}
+
+vector<double> uniformEdges(double lo, double hi, int bins)
+{
+    vector<double> edges(bins + 1);
+    for(int b = 0; b <= bins; b++)
+        edges[b] = lo + (hi - lo) * b / bins;
+    return edges;
+}
+
+void edgeLengths(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, long f, double l[3])
+{
+    for(int j = 0; j < 3; j++)
+        l[j] = (V.row(F(f, (j + 1) % 3)) - V.row(F(f, j))).norm();
+}
+
+void printHistogram(const MESHIO::QualityHistogram &h)
+{
+    std::cout << h.name << " : min " << h.min << ", max " << h.max << ", mean " << h.mean << std::endl;
+    for(size_t b = 0; b < h.counts.size(); b++) {
+        std::cout << "  [" << std::setw(10) << h.edges[b] << ", " << std::setw(10) << h.edges[b + 1] << (b + 1 == h.counts.size() ? "] " : ") ")
+                  << std::setw(12) << h.counts[b] << "  " << std::fixed << std::setprecision(2)
+                  << (h.count ? 100.0 * h.counts[b] / h.count : 0.0) << "%" << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+}
+
+void histogramJson(std::ostream &f, const MESHIO::QualityHistogram &h)
+{
+    f << "{\"count\": " << h.count << ", \"min\": " << h.min << ", \"max\": " << h.max << ", \"mean\": " << h.mean << ", \"edges\": [";
+    for(size_t b = 0; b < h.edges.size(); b++)
+        f << (b ? ", " : "") << h.edges[b];
+    f << "], \"counts\": [";
+    for(size_t b = 0; b < h.counts.size(); b++)
+        f << (b ? ", " : "") << h.counts[b];
+    f << "]}";
+}
+
+}
+
+/**
+ * Measure every triangle in two parallel passes over fixed blocks of facets. The first
+ * computes the angles, aspect ratio and area of each facet and bins the angles and the
+ * aspect ratio, whose bins are fixed; the second bins edge lengths and areas between the
+ * extremes the first found. Each block fills its own histograms, which are summed in
+ * block order afterwards: no locks, and the same result for any number of threads.
+ * @param V
+ * @param F triangles.
+ * @param quality result.
+ * @param perFacet optional per-facet measures, see QualityColumn.
+ * @return 1/-1
+ */
+int MESHIO::computeQuality(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, MeshQuality &quality, Eigen::MatrixXd *perFacet)
+{
+    MESH_TRACE("computeQuality");
+    if(F.cols() != 3) {
+        std::cout << "Quality metrics need triangles." << std::endl;
+        return -1;
+    }
+    const long nF = F.rows();
+    const double tolerance = Kernels::repairTolerance<double>();
+    quality = MeshQuality();
+    quality.nFacets = nF;
+
+    Eigen::MatrixXd local;
+    Eigen::MatrixXd &Q = perFacet ? *perFacet : local;
+    Q.resize(nF, QualityColumns);
+    vector<uint8_t> degenerate(nF, 0);
+
+    const vector<double> minAngleEdges = uniformEdges(0.0, 60.0, 12);
+    const vector<double> maxAngleEdges = uniformEdges(60.0, 180.0, 12);
+    vector<double> aspectEdges = {1.0, 1.25, 1.5, 2.0, 3.0, 5.0, 10.0, 10.0};
+
+    const long nBlocks = std::max(1L, std::min(MAX_BLOCKS, nF));
+    enum { MinAngle, MaxAngle, Aspect, Length, Area, Kinds };
+    vector<Accumulator> blocks(nBlocks * Kinds);
+    for(long b = 0; b < nBlocks; b++) {
+        blocks[b * Kinds + MinAngle].reset(minAngleEdges);
+        blocks[b * Kinds + MaxAngle].reset(maxAngleEdges);
+        blocks[b * Kinds + Aspect].reset(aspectEdges);
+    }
+    auto blockBegin = [&](long b) { return b * nF / nBlocks; };
+
+#pragma omp parallel for schedule(static)
+    for(long b = 0; b < nBlocks; b++) {
+        Accumulator *acc = &blocks[b * Kinds];
+        for(long f = blockBegin(b); f < blockBegin(b + 1); f++) {
+            const Eigen::Vector3d p0 = V.row(F(f, 0)).transpose();
+            const Eigen::Vector3d p1 = V.row(F(f, 1)).transpose();
+            const Eigen::Vector3d p2 = V.row(F(f, 2)).transpose();
+            const Eigen::Vector3d e0 = p1 - p0, e1 = p2 - p1, e2 = p0 - p2;
+            const double twiceArea = e0.cross(-e2).norm();
+            const double l0 = e0.norm(), l1 = e1.norm(), l2 = e2.norm();
+            // Angle at each corner between its two edges, atan2 stays accurate for needles.
+            const double a0 = atan2(twiceArea, e0.dot(-e2)) * DEGREES;
+            const double a1 = atan2(twiceArea, e1.dot(-e0)) * DEGREES;
+            const double a2 = 180.0 - a0 - a1;
+            Q(f, QualityMinAngle) = std::min(a0, std::min(a1, a2));
+            Q(f, QualityMaxAngle) = std::max(a0, std::max(a1, a2));
+            Q(f, QualityArea) = 0.5 * twiceArea;
+            const double lmax = std::max(l0, std::max(l1, l2));
+            Q(f, QualityAspectRatio) = twiceArea > 0 ? lmax * (l0 + l1 + l2) / (2.0 * sqrt(3.0) * twiceArea)
+                                                     : numeric_limits<double>::infinity();
+            acc[Area].track(Q(f, QualityArea));
+            acc[Length].track(std::min(l0, std::min(l1, l2)));
+            acc[Length].track(lmax);
+            if(twiceArea < tolerance) {
+                degenerate[f] = 1;
+                continue;
+            }
+            acc[MinAngle].add(Q(f, QualityMinAngle));
+            acc[MaxAngle].add(Q(f, QualityMaxAngle));
+            acc[Aspect].add(Q(f, QualityAspectRatio));
+        }
+    }
+
+    Accumulator total[Kinds];
+    total[MinAngle].reset(minAngleEdges);
+    total[MaxAngle].reset(maxAngleEdges);
+    total[Aspect].reset(aspectEdges);
+    for(long b = 0; b < nBlocks; b++)
+        for(int k : {MinAngle, MaxAngle, Aspect})
+            total[k].merge(blocks[b * Kinds + k]);
+    for(long b = 0; b < nBlocks; b++) {
+        for(int k : {Length, Area}) {
+            total[k].track(blocks[b * Kinds + k].min);
+            total[k].track(blocks[b * Kinds + k].max);
+        }
+    }
+    // The last aspect ratio bin reaches the worst facet.
+    aspectEdges.back() = std::max(aspectEdges.back(), total[Aspect].count ? total[Aspect].max : 0.0);
+
+    const vector<double> lengthEdges = uniformEdges(nF ? total[Length].min : 0.0, nF ? total[Length].max : 0.0, RANGE_BINS);
+    const vector<double> areaEdges = uniformEdges(nF ? total[Area].min : 0.0, nF ? total[Area].max : 0.0, RANGE_BINS);
+    for(long b = 0; b < nBlocks; b++) {
+        blocks[b * Kinds + Length].reset(lengthEdges);
+        blocks[b * Kinds + Area].reset(areaEdges);
+    }
+#pragma omp parallel for schedule(static)
+    for(long b = 0; b < nBlocks; b++) {
+        Accumulator *acc = &blocks[b * Kinds];
+        for(long f = blockBegin(b); f < blockBegin(b + 1); f++) {
+            double l[3];
+            edgeLengths(V, F, f, l);
+            for(int j = 0; j < 3; j++)
+                acc[Length].add(l[j]);
+            acc[Area].add(Q(f, QualityArea));
+        }
+    }
+    total[Length] = Accumulator();
+    total[Area] = Accumulator();
+    total[Length].reset(lengthEdges);
+    total[Area].reset(areaEdges);
+    for(long b = 0; b < nBlocks; b++)
+        for(int k : {Length, Area})
+            total[k].merge(blocks[b * Kinds + k]);
+
+    for(long f = 0; f < nF; f++)
+        quality.nDegenerate += degenerate[f];
+    finish("Min angle (degrees)", minAngleEdges, total[MinAngle], quality.minAngle);
+    finish("Max angle (degrees)", maxAngleEdges, total[MaxAngle], quality.maxAngle);
+    finish("Aspect ratio", aspectEdges, total[Aspect], quality.aspectRatio);
+    finish("Edge length", lengthEdges, total[Length], quality.edgeLength);
+    finish("Area", areaEdges, total[Area], quality.area);
+    return 1;
+}
+
+void MESHIO::printQuality(const MeshQuality &quality)
+{
+    std::cout << "Number of facets : " << quality.nFacets << std::endl;
+    std::cout << "Degenerate facets : " << quality.nDegenerate << std::endl;
+    for(const QualityHistogram *h : {&quality.minAngle, &quality.maxAngle, &quality.aspectRatio, &quality.edgeLength, &quality.area})
+        printHistogram(*h);
+}
+
+/**
+ * {"facets": n, "degenerate": n, "min_angle": {"count": n, "min": .., "max": .., "mean": .., "edges": [..], "counts": [..]},
+ *  "max_angle": {..}, "aspect_ratio": {..}, "edge_length": {..}, "area": {..}}
+ */
+bool MESHIO::writeQualityJson(const std::string &filename, const MeshQuality &quality)
+{
+    std::ofstream f(filename);
+    if(!f.is_open()) {
+        std::cout << "Write quality report failed. - " << filename << std::endl;
+        return false;
+    }
+    f.precision(std::numeric_limits<double>::digits10 + 1);
+    f << "{\"facets\": " << quality.nFacets << ", \"degenerate\": " << quality.nDegenerate;
+    const pair<const char *, const QualityHistogram *> histograms[] = {
+        {"min_angle", &quality.minAngle}, {"max_angle", &quality.maxAngle}, {"aspect_ratio", &quality.aspectRatio},
+        {"edge_length", &quality.edgeLength}, {"area", &quality.area}};
+    for(const auto &h : histograms) {
+        f << ",\n " << jsonString(h.first) << ": ";
+        histogramJson(f, *h.second);
+    }
+    f << "}\n";
+    return true;
+}
+
+/**
+ * Append the per-facet measures as cell attributes, replacing those of an earlier call.
+ * @return 1/-1
+ */
+int MESHIO::addQualityAttributes(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, MeshAttributes &attributes)
+{
+    MeshQuality quality;
+    Eigen::MatrixXd Q;
+    if(computeQuality(V, F, quality, &Q) < 0)
+        return -1;
+    const char *names[QualityColumns] = {"min_angle", "max_angle", "aspect_ratio", "area"};
+    for(int c = 0; c < QualityColumns; c++) {
+        attributes.erase(remove_if(attributes.begin(), attributes.end(), [&](const MeshAttribute &a) {
+            return !a.onPoints && a.name == names[c];
+        }), attributes.end());
+        attributes.emplace_back(names[c], false, Q.col(c));
+    }
+    return 1;
+}
@@ -0,0 +1,57 @@
+#ifndef MESH_QUALITY_H
+#define MESH_QUALITY_H
+
+#include "MeshAttributes.h"
+
+#include <Eigen/Dense>
+#include <string>
+#include <vector>
+
+namespace MESHIO {
+
+	/**
+	 * Distribution of one facet measure over fixed bins: counts[b] holds the values in
+	 * [edges[b], edges[b + 1]), the last bin also holds its upper edge.
+	 */
+	struct QualityHistogram {
+		std::string name;
+		std::vector<double> edges;   // bins + 1 entries
+		std::vector<long> counts;
+		long count = 0;
+		double min = 0.0;
+		double max = 0.0;
+		double mean = 0.0;
+	};
+
+	/**
+	 * Triangle quality: angles in degrees, aspect ratio longest edge * perimeter /
+	 * (4 sqrt(3) area), 1 for an equilateral triangle and infinite for a degenerate one.
+	 * Edge lengths are counted per facet, an edge shared by two facets twice.
+	 * Degenerate facets are those repair would remove (area under its tolerance); their
+	 * angles and aspect ratio are left out of the histograms.
+	 */
+	struct MeshQuality {
+		long nFacets = 0;
+		long nDegenerate = 0;
+		QualityHistogram minAngle;
+		QualityHistogram maxAngle;
+		QualityHistogram aspectRatio;
+		QualityHistogram edgeLength;
+		QualityHistogram area;
+	};
+
+	// Columns of the per-facet measures of computeQuality.
+	enum QualityColumn { QualityMinAngle, QualityMaxAngle, QualityAspectRatio, QualityArea, QualityColumns };
+
+	/**
+	 * @param perFacet when not null, gets one row per facet with the QualityColumn measures.
+	 * @return 1/-1
+	 */
+	int computeQuality(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, MeshQuality &quality, Eigen::MatrixXd *perFacet = nullptr);
+	void printQuality(const MeshQuality &quality);
+	bool writeQualityJson(const std::string &filename, const MeshQuality &quality);
+	// The per-facet measures as cell attributes min_angle, max_angle, aspect_ratio and area, for the VTK writer.
+	int addQualityAttributes(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, MeshAttributes &attributes);
+};
+
+#endif
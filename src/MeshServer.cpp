@@ -0,0 +1,588 @@
+#include "MeshServer.h"
+#include "MiniJson.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Flag {
+    const char *name;
+    bool MESHIO::ConvertOptions::*member;
+};
+
+const Flag operationFlags[] = {
+    {"surface", &MESHIO::ConvertOptions::surface},
+    {"reset-orient", &MESHIO::ConvertOptions::resetOrientation},
+    {"reverse-orient", &MESHIO::ConvertOptions::reverseOrient},
+    {"repair", &MESHIO::ConvertOptions::repair},
+    {"info", &MESHIO::ConvertOptions::reportInfo},
+    {"boundary", &MESHIO::ConvertOptions::reportBoundary},
+    {"boundary-vtk", &MESHIO::ConvertOptions::exportBoundary},
+    {"quality", &MESHIO::ConvertOptions::reportQuality},
+    {"quality-cells", &MESHIO::ConvertOptions::qualityCells},
+    {"decimate-parallel", &MESHIO::ConvertOptions::decimateParallel},
+};
+
+const Flag formatFlags[] = {
+    {"vtk", &MESHIO::ConvertOptions::exportVTK},
+    {"mesh", &MESHIO::ConvertOptions::exportMESH},
+    {"ply", &MESHIO::ConvertOptions::exportPLY},
+    {"pls", &MESHIO::ConvertOptions::exportPLS},
+    {"facet", &MESHIO::ConvertOptions::exportFacet},
+    {"obj", &MESHIO::ConvertOptions::exportOBJ},
+    {"mcb", &MESHIO::ConvertOptions::exportMCB},
+    {"eps-vtk", &MESHIO::ConvertOptions::exportEpsVTK},
+};
+
+bool readNumbers(const JsonValue *value, std::vector<double> &out)
+{
+    if(!value)
+        return true;
+    if(value->type != JsonValue::Array)
+        return false;
+    for(const JsonValue &item : value->items) {
+        if(item.type != JsonValue::Number)
+            return false;
+        out.push_back(item.number);
+    }
+    return true;
+}
+
+bool readStrings(const JsonValue *value, std::vector<std::string> &out)
+{
+    if(!value)
+        return true;
+    if(value->type != JsonValue::Array)
+        return false;
+    for(const JsonValue &item : value->items) {
+        if(item.type != JsonValue::String)
+            return false;
+        out.push_back(item.text);
+    }
+    return true;
+}
+
+}
+
+std::string MESHIO::jobToJson(const ConvertOptions &opt)
+{
+    std::stringstream json;
+    json.precision(17);
+    json << "{\"input\": " << jsonString(opt.input);
+    json << ", \"eps\": " << jsonString(opt.inputEx);
+    json << ", \"operations\": [";
+    bool first = true;
+    for(const Flag &flag : operationFlags) {
+        if(opt.*flag.member) {
+            json << (first ? "" : ", ") << jsonString(flag.name);
+            first = false;
+        }
+    }
+    json << "], \"formats\": [";
+    first = true;
+    for(const Flag &flag : formatFlags) {
+        if(opt.*flag.member) {
+            json << (first ? "" : ", ") << jsonString(flag.name);
+            first = false;
+        }
+    }
+    json << "]";
+    auto numbers = [&](const char *key, const std::vector<double> &values) {
+        json << ", \"" << key << "\": [";
+        for(size_t i = 0; i < values.size(); i++)
+            json << (i ? ", " : "") << values[i];
+        json << "]";
+    };
+    numbers("rotate", opt.rotateVec);
+    numbers("box", opt.boxVec);
+    json << ", \"transform\": [";
+    for(size_t i = 0; i < opt.transformOps.size(); i++)
+        json << (i ? ", " : "") << jsonString(opt.transformOps[i]);
+    json << "], \"pipeline\": [";
+    for(size_t i = 0; i < opt.pipelineOps.size(); i++)
+        json << (i ? ", " : "") << jsonString(opt.pipelineOps[i]);
+    json << "], \"stream\": " << (opt.stream ? "true" : "false");
+    json << ", \"float32\": " << (opt.float32 ? "true" : "false");
+    json << ", \"index64\": " << (opt.index64 ? "true" : "false");
+    json << ", \"cells\": " << (opt.cells ? "true" : "false");
+    json << ", \"normals\": " << jsonString(opt.normals);
+    json << ", \"quality-json\": " << jsonString(opt.qualityJson);
+    json << ", \"decimate\": " << jsonString(opt.decimate);
+    json << ", \"cache\": " << jsonString(opt.cacheDir);
+    json << ", \"cache-size\": " << opt.cacheMaxMB << "}";
+    return json.str();
+}
+
+bool MESHIO::jobFromJson(const std::string &message, ConvertOptions &opt, std::string &error)
+{
+    JsonValue job;
+    if(!JsonValue::parse(message, job, &error))
+        return false;
+    if(job.type != JsonValue::Object) {
+        error = "A job must be a JSON object.";
+        return false;
+    }
+    opt = ConvertOptions();
+    const JsonValue *input = job.find("input");
+    if(!input || input->type != JsonValue::String || input->text.empty()) {
+        error = "A job needs an \"input\" filename.";
+        return false;
+    }
+    opt.input = input->text;
+    const JsonValue *eps = job.find("eps");
+    if(eps && eps->type == JsonValue::String)
+        opt.inputEx = eps->text;
+
+    std::vector<std::string> operations, formats;
+    if(!readStrings(job.find("operations"), operations) || !readStrings(job.find("formats"), formats)
+        || !readStrings(job.find("transform"), opt.transformOps) || !readStrings(job.find("pipeline"), opt.pipelineOps)
+        || !readNumbers(job.find("rotate"), opt.rotateVec) || !readNumbers(job.find("box"), opt.boxVec)) {
+        error = "Illegal job field type.";
+        return false;
+    }
+    for(const std::string &name : operations) {
+        bool known = false;
+        for(const Flag &flag : operationFlags)
+            if(name == flag.name)
+                known = opt.*flag.member = true;
+        if(!known) {
+            error = "Unknown operation - " + name;
+            return false;
+        }
+    }
+    for(const std::string &name : formats) {
+        bool known = false;
+        for(const Flag &flag : formatFlags)
+            if(name == flag.name)
+                known = opt.*flag.member = true;
+        if(!known) {
+            error = "Unknown format - " + name;
+            return false;
+        }
+    }
+    const JsonValue *stream = job.find("stream");
+    opt.stream = stream && stream->type == JsonValue::Bool && stream->boolean;
+    const JsonValue *float32 = job.find("float32");
+    opt.float32 = float32 && float32->type == JsonValue::Bool && float32->boolean;
+    const JsonValue *index64 = job.find("index64");
+    opt.index64 = index64 && index64->type == JsonValue::Bool && index64->boolean;
+    const JsonValue *cells = job.find("cells");
+    opt.cells = cells && cells->type == JsonValue::Bool && cells->boolean;
+    const JsonValue *normals = job.find("normals");
+    if(normals && normals->type == JsonValue::String)
+        opt.normals = normals->text;
+    const JsonValue *qualityJson = job.find("quality-json");
+    if(qualityJson && qualityJson->type == JsonValue::String)
+        opt.qualityJson = qualityJson->text;
+    const JsonValue *decimate = job.find("decimate");
+    if(decimate && decimate->type == JsonValue::String)
+        opt.decimate = decimate->text;
+    const JsonValue *cacheDir = job.find("cache");
+    if(cacheDir && cacheDir->type == JsonValue::String)
+        opt.cacheDir = cacheDir->text;
+    const JsonValue *cacheSize = job.find("cache-size");
+    if(cacheSize && cacheSize->type == JsonValue::Number)
+        opt.cacheMaxMB = cacheSize->number;
+    return true;
+}
+
+#ifndef _WIN32
+
+namespace {
+
+struct CachedMesh {
+    Eigen::MatrixXd V;
+    Eigen::MatrixXi F;
+    Eigen::MatrixXi M;
+    MESHIO::MeshAttributes attributes;
+    size_t bytes() const {
+        size_t total = V.size() * sizeof(double) + (F.size() + M.size()) * sizeof(int);
+        for(const MESHIO::MeshAttribute &a : attributes)
+            total += a.data.size();
+        return total;
+    }
+};
+
+/**
+ * Parsed meshes by file, least recently used first out. The key holds the modification
+ * time and size, so an input rewritten between two jobs is parsed again.
+ */
+class MeshLRU {
+public:
+    explicit MeshLRU(size_t capacity) : capacity(capacity) {}
+
+    std::shared_ptr<const CachedMesh> get(const std::string &key) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = index.find(key);
+        if(it == index.end())
+            return nullptr;
+        order.splice(order.begin(), order, it->second);
+        return it->second->mesh;
+    }
+    void put(const std::string &key, std::shared_ptr<const CachedMesh> mesh) {
+        size_t bytes = mesh->bytes();
+        if(bytes > capacity)
+            return;
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = index.find(key);
+        if(it != index.end()) {
+            used -= it->second->bytes;
+            order.erase(it->second);
+            index.erase(it);
+        }
+        order.push_front(Entry{key, mesh, bytes});
+        index[key] = order.begin();
+        used += bytes;
+        while(used > capacity) {
+            used -= order.back().bytes;
+            index.erase(order.back().key);
+            order.pop_back();
+        }
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const CachedMesh> mesh;
+        size_t bytes;
+    };
+    std::mutex lock;
+    std::list<Entry> order;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t capacity;
+    size_t used = 0;
+};
+
+std::string cacheKey(const std::string &filename)
+{
+    struct stat st;
+    if(stat(filename.c_str(), &st) != 0)
+        return "";
+    return filename + "|" + std::to_string((long long)st.st_mtime) + "|" + std::to_string((long long)st.st_size);
+}
+
+bool sendAll(int fd, const std::string &data)
+{
+    size_t sent = 0;
+    while(sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if(n <= 0)
+            return false;
+        sent += n;
+    }
+    return true;
+}
+
+// Read up to the next newline, keeping what follows it in pending.
+bool receiveLine(int fd, std::string &pending, std::string &line)
+{
+    while(true) {
+        size_t eol = pending.find('\n');
+        if(eol != std::string::npos) {
+            line = pending.substr(0, eol);
+            pending.erase(0, eol + 1);
+            return true;
+        }
+        char buffer[4096];
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if(n <= 0) {
+            line = pending;
+            pending.clear();
+            return !line.empty();
+        }
+        pending.append(buffer, n);
+    }
+}
+
+std::string failedReply(const std::string &message)
+{
+    return "{\"status\": \"failed\", \"message\": " + jsonString(message) + "}\n";
+}
+
+std::string runJob(const std::string &message, MeshLRU &cache, std::atomic<bool> &stop)
+{
+    JsonValue request;
+    if(JsonValue::parse(message, request)) {
+        const JsonValue *command = request.find("command");
+        if(command && command->text == "shutdown") {
+            stop = true;
+            return "{\"status\": \"ok\", \"message\": \"shutting down\"}\n";
+        }
+    }
+
+    MESHIO::ConvertOptions opt;
+    std::string error;
+    if(!MESHIO::jobFromJson(message, opt, error))
+        return failedReply(error);
+
+    MESH_TRACE("serverJob", opt.input);
+    MESHIO::ConvertReport report;
+    bool cached = false;
+    int result = -1;
+    try {
+        std::string key = cacheKey(opt.input);
+        if(key.empty())
+            return failedReply("No such file. - " + opt.input);
+        // The server keeps its parsed meshes in double and int; these read the file themselves.
+        // So do jobs with a result cache, which skip parsing altogether on a hit.
+        if(opt.stream || opt.float32 || opt.index64 || opt.cells || !opt.cacheDir.empty() || MESHIO::needsIndex64(opt.input)) {
+            result = MESHIO::convertMesh(opt, &report);
+        }
+        else {
+            std::shared_ptr<const CachedMesh> mesh = cache.get(key);
+            cached = (mesh != nullptr);
+            if(!cached) {
+                auto start = std::chrono::steady_clock::now();
+                std::shared_ptr<CachedMesh> parsed = std::make_shared<CachedMesh>();
+                if(MESHIO::readMesh(opt.input, parsed->V, parsed->F, parsed->M, parsed->attributes) < 0)
+                    return failedReply("Read mesh failed. - " + opt.input);
+                report.readSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                cache.put(key, parsed);
+                mesh = parsed;
+            }
+            // The operations work in place, so they get a copy of the cached mesh.
+            Eigen::MatrixXd V = mesh->V;
+            Eigen::MatrixXi F = mesh->F;
+            Eigen::MatrixXi M = mesh->M;
+            result = MESHIO::processMesh(opt, V, F, M, &report, &mesh->attributes);
+        }
+    } catch(const std::exception &e) {
+        return failedReply(e.what());
+    }
+
+    std::stringstream reply;
+    reply << "{\"status\": " << jsonString(result > 0 ? "ok" : "failed");
+    reply << ", \"cached\": " << (cached ? "true" : "false");
+    if(!report.cache.empty())
+        reply << ", \"cache\": " << jsonString(report.cache);
+    reply << ", \"points\": " << report.nPoints << ", \"facets\": " << report.nFacets;
+    reply << ", \"read_seconds\": " << report.readSeconds;
+    reply << ", \"operation_seconds\": " << report.operationSeconds;
+    reply << ", \"write_seconds\": " << report.writeSeconds;
+    reply << ", \"outputs\": [";
+    for(size_t i = 0; i < report.outputs.size(); i++)
+        reply << (i ? ", " : "") << jsonString(report.outputs[i]);
+    reply << "]}\n";
+    return reply.str();
+}
+
+bool socketAddress(const std::string &path, sockaddr_un &addr)
+{
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(addr.sun_path)) {
+        std::cout << "Socket path is too long. - " << path << std::endl;
+        return false;
+    }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    return true;
+}
+
+}
+
+/**
+ * Serve conversion jobs until a shutdown command arrives. The accept loop polls the open
+ * connections and submits one pool task per received job, so an idle client holds no
+ * worker. A connection runs one job at a time, its next lines wait until the reply is sent.
+ */
+int MESHIO::runServer(const ServerOptions &server)
+{
+    sockaddr_un addr;
+    if(!socketAddress(server.socketPath, addr))
+        return -1;
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listenFd < 0) {
+        std::cout << "Create socket failed." << std::endl;
+        return -1;
+    }
+    unlink(server.socketPath.c_str());
+    if(bind(listenFd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listenFd, 64) != 0) {
+        std::cout << "Listen on socket failed. - " << server.socketPath << std::endl;
+        close(listenFd);
+        return -1;
+    }
+    // Finished jobs write a byte here to wake the poll.
+    int wake[2];
+    if(pipe(wake) != 0) {
+        std::cout << "Create pipe failed." << std::endl;
+        close(listenFd);
+        return -1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    struct Connection {
+        std::string pending;
+        bool busy = false;      // a job of the connection is running
+        bool closing = false;   // the client closed its end, or a reply could not be sent
+    };
+    std::map<int, Connection> connections;
+    std::mutex finishedLock;
+    std::vector<std::pair<int, bool>> finished;   // connection, reply sent
+
+    MeshLRU cache((size_t)(server.cacheMemoryMB * 1024.0 * 1024.0));
+    std::atomic<bool> stop{false};
+    {
+        ThreadPool pool(server.jobs);
+        std::cout << "Serving on - " << server.socketPath << " with " << pool.size() << " threads." << std::endl;
+        while(!stop) {
+            std::vector<pollfd> fds = {{listenFd, POLLIN, 0}, {wake[0], POLLIN, 0}};
+            for(const auto &c : connections)
+                if(!c.second.busy && !c.second.closing)
+                    fds.push_back({c.first, POLLIN, 0});
+            if(poll(fds.data(), fds.size(), 200) < 0)
+                continue;
+            if(fds[1].revents & POLLIN) {
+                char drain[64];
+                (void)!read(wake[0], drain, sizeof(drain));
+                std::lock_guard<std::mutex> guard(finishedLock);
+                for(const auto &f : finished) {
+                    connections[f.first].busy = false;
+                    if(!f.second)
+                        connections[f.first].closing = true;
+                }
+                finished.clear();
+            }
+            if(fds[0].revents & POLLIN) {
+                int fd = accept(listenFd, nullptr, nullptr);
+                if(fd >= 0)
+                    connections[fd];
+            }
+            for(size_t i = 2; i < fds.size(); i++) {
+                if(!(fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                    continue;
+                Connection &c = connections[fds[i].fd];
+                char buffer[4096];
+                ssize_t n = recv(fds[i].fd, buffer, sizeof(buffer), 0);
+                if(n <= 0)
+                    c.closing = true;
+                else
+                    c.pending.append(buffer, n);
+            }
+
+            // Next job of every idle connection; a last line without newline counts once the client closed.
+            for(auto it = connections.begin(); it != connections.end();) {
+                const int fd = it->first;
+                Connection &c = it->second;
+                std::string line;
+                const size_t eol = c.pending.find('\n');
+                if(c.busy) {
+                    ++it;
+                    continue;
+                }
+                if(eol != std::string::npos) {
+                    line = c.pending.substr(0, eol);
+                    c.pending.erase(0, eol + 1);
+                } else if(c.closing && !c.pending.empty()) {
+                    line.swap(c.pending);
+                } else {
+                    if(c.closing) {
+                        close(fd);
+                        it = connections.erase(it);
+                    } else
+                        ++it;
+                    continue;
+                }
+                c.busy = true;
+                pool.submit([fd, line, &cache, &stop, &finishedLock, &finished, &wake] {
+                    const bool sent = sendAll(fd, runJob(line, cache, stop));
+                    {
+                        std::lock_guard<std::mutex> guard(finishedLock);
+                        finished.emplace_back(fd, sent);
+                    }
+                    (void)!write(wake[1], "", 1);
+                });
+                ++it;
+            }
+        }
+        // Jobs already running finish and reply, idle connections are closed.
+        pool.wait();
+    }
+    for(const auto &c : connections)
+        close(c.first);
+    close(wake[0]);
+    close(wake[1]);
+    close(listenFd);
+    unlink(server.socketPath.c_str());
+    std::cout << "Server stopped." << std::endl;
+    return 1;
+}
+
+/**
+ * Send one job to a running server and print its reply.
+ * @return 1 if the server converted the job, -1 otherwise.
+ */
+int MESHIO::runClient(const std::string &socketPath, const ConvertOptions &opt)
+{
+    sockaddr_un addr;
+    if(!socketAddress(socketPath, addr))
+        return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0 || connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+        std::cout << "Connect to server failed. - " << socketPath << std::endl;
+        if(fd >= 0)
+            close(fd);
+        return -1;
+    }
+    // The server may run in another directory.
+    ConvertOptions job = opt;
+    std::error_code ec;
+    if(!job.input.empty())
+        job.input = fs::absolute(job.input, ec).string();
+    if(!job.inputEx.empty())
+        job.inputEx = fs::absolute(job.inputEx, ec).string();
+    if(!job.qualityJson.empty())
+        job.qualityJson = fs::absolute(job.qualityJson, ec).string();
+    if(!job.cacheDir.empty())
+        job.cacheDir = fs::absolute(job.cacheDir, ec).string();
+    std::string pending, reply;
+    bool ok = sendAll(fd, jobToJson(job) + "\n") && receiveLine(fd, pending, reply);
+    close(fd);
+    if(!ok) {
+        std::cout << "No reply from server. - " << socketPath << std::endl;
+        return -1;
+    }
+    std::cout << reply << std::endl;
+    JsonValue value;
+    const JsonValue *status = JsonValue::parse(reply, value) ? value.find("status") : nullptr;
+    return status && status->text == "ok" ? 1 : -1;
+}
+
+#else
+
+int MESHIO::runServer(const ServerOptions &server)
+{
+    std::cout << "The conversion server needs Unix domain sockets." << std::endl;
+    return -1;
+}
+
+int MESHIO::runClient(const std::string &socketPath, const ConvertOptions &opt)
+{
+    std::cout << "The conversion server needs Unix domain sockets." << std::endl;
+    return -1;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef MESH_SERVER_H
+#define MESH_SERVER_H
+
+#include "MeshConvert.h"
+
+#include <string>
+
+namespace MESHIO {
+
+	/**
+	 * Resident conversion daemon on a Unix domain socket. A client sends one job per line
+	 * as a JSON object and gets one JSON line back:
+	 *   {"input": "/abs/part.pls", "operations": ["reset-orient", "repair"], "formats": ["vtk", "obj"],
+	 *    "rotate": [...], "box": [...], "transform": ["scale:2"],
+	 *    "pipeline": ["mirror:x", "remap-marker:1=2"], "stream": false, "float32": false,
+	 *    "index64": false, "cells": false}
+	 *   {"command": "shutdown"}
+	 * Jobs run on a shared thread pool, and recently parsed meshes stay in an LRU cache so
+	 * repeated jobs on an unchanged input skip parsing.
+	 */
+	struct ServerOptions {
+		std::string socketPath;
+		int jobs = 0;                   // worker threads, 0 for one per core
+		double cacheMemoryMB = 1024.0;  // memory of the parsed meshes kept, 0 disables the cache
+	};
+
+	std::string jobToJson(const ConvertOptions &opt);
+	bool jobFromJson(const std::string &message, ConvertOptions &opt, std::string &error);
+	int runServer(const ServerOptions &server);
+	int runClient(const std::string &socketPath, const ConvertOptions &opt);
+};
+
+#endif
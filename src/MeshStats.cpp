@@ -0,0 +1,141 @@
+#include "MeshStats.h"
+#include "MeshTrace.h"
+
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Fixed blocks, so the sums do not depend on the number of threads.
+const long MAX_BLOCKS = 256;
+
+// Sums of one block of points and of the facets of the same block number.
+struct BlockStats {
+    Eigen::Vector3d lo = Eigen::Vector3d::Constant(numeric_limits<double>::infinity());
+    Eigen::Vector3d hi = Eigen::Vector3d::Constant(-numeric_limits<double>::infinity());
+    Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+    double area = 0.0, volume = 0.0;
+    map<int, double> markerArea;
+};
+
+}
+
+/**
+ * Compute the statistics in one parallel region over fixed blocks of points and of facets:
+ * each block reduces into its own accumulators, which are merged in block order at the end,
+ * so the sums are the same for any number of threads and from run to run.
+ * Medians use selection (nth_element) on one scratch array reused for the three axes.
+ * @param V
+ * @param T
+ * @param M marker per facet, ignored unless it has one row per facet.
+ * @param stats result.
+ * @param withMedian skip the selection when the medians are not needed.
+ * @return 1
+ */
+int MESHIO::computeStats(const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M, MeshStats &stats, bool withMedian)
+{
+    MESH_TRACE("computeStats");
+    stats = MeshStats();
+    stats.nPoints = V.rows();
+    stats.nFacets = T.rows();
+    if(V.rows() == 0 || V.cols() != 3)
+        return 1;
+
+    const bool doMarker = (M.rows() == T.rows() && M.cols() > 0);
+    const long nV = V.rows();
+    const long nT = T.rows();
+    const int nCorner = T.cols();
+    const long nBlocks = std::max(1L, std::min(MAX_BLOCKS, std::max(nV, nT)));
+    vector<BlockStats> blocks(nBlocks);
+
+#pragma omp parallel
+    {
+        MESH_TRACE("computeStats.worker");
+#pragma omp for schedule(static) nowait
+        for(long b = 0; b < nBlocks; b++) {
+            BlockStats &block = blocks[b];
+            for(long i = b * nV / nBlocks; i < (b + 1) * nV / nBlocks; i++) {
+                Eigen::Vector3d p = V.row(i).transpose();
+                block.lo = block.lo.cwiseMin(p);
+                block.hi = block.hi.cwiseMax(p);
+                block.sum += p;
+            }
+        }
+
+        if(nCorner >= 3) {
+#pragma omp for schedule(static) nowait
+            for(long b = 0; b < nBlocks; b++) {
+                BlockStats &block = blocks[b];
+                int lastMarker = 0;
+                double *lastArea = nullptr;
+                for(long i = b * nT / nBlocks; i < (b + 1) * nT / nBlocks; i++) {
+                    Eigen::Vector3d p0 = V.row(T(i, 0)).transpose();
+                    double facetArea = 0.0;
+                    for(int j = 1; j + 1 < nCorner; j++) {
+                        Eigen::Vector3d p1 = V.row(T(i, j)).transpose();
+                        Eigen::Vector3d p2 = V.row(T(i, j + 1)).transpose();
+                        Eigen::Vector3d n = (p1 - p0).cross(p2 - p0);
+                        facetArea += 0.5 * n.norm();
+                        block.volume += p0.dot(p1.cross(p2)) / 6.0;
+                    }
+                    block.area += facetArea;
+                    if(doMarker) {
+                        // Markers come in runs, so the map lookup is mostly skipped.
+                        if(lastArea == nullptr || M(i, 0) != lastMarker) {
+                            lastMarker = M(i, 0);
+                            lastArea = &block.markerArea[lastMarker];
+                        }
+                        *lastArea += facetArea;
+                    }
+                }
+            }
+        }
+    }
+
+    BlockStats total;
+    for(const BlockStats &block : blocks) {
+        total.lo = total.lo.cwiseMin(block.lo);
+        total.hi = total.hi.cwiseMax(block.hi);
+        total.sum += block.sum;
+        total.area += block.area;
+        total.volume += block.volume;
+        for(auto &it : block.markerArea)
+            stats.markerArea[it.first] += it.second;
+    }
+    stats.bboxMin = total.lo;
+    stats.bboxMax = total.hi;
+    stats.centroid = total.sum / (double)nV;
+    stats.area = total.area;
+    stats.volume = total.volume;
+
+    if(withMedian) {
+        vector<double> scratch(nV);
+        const long mid = nV / 2;
+        for(int k = 0; k < 3; k++) {
+            const double *col = V.col(k).data();
+            copy(col, col + nV, scratch.begin());
+            nth_element(scratch.begin(), scratch.begin() + mid, scratch.end());
+            stats.median[k] = scratch[mid];
+        }
+    }
+    return 1;
+}
+
+void MESHIO::printStats(const MeshStats &stats)
+{
+    std::cout << "Number of points : " << stats.nPoints << std::endl;
+    std::cout << "Number of facets : " << stats.nFacets << std::endl;
+    std::cout << "Bounding box min : " << stats.bboxMin.transpose() << std::endl;
+    std::cout << "Bounding box max : " << stats.bboxMax.transpose() << std::endl;
+    std::cout << "Extent : " << stats.extent().transpose() << std::endl;
+    std::cout << "Centroid : " << stats.centroid.transpose() << std::endl;
+    std::cout << "Median : " << stats.median.transpose() << std::endl;
+    std::cout << "Surface area : " << stats.area << std::endl;
+    std::cout << "Enclosed volume : " << stats.volume << std::endl;
+    for(auto &it : stats.markerArea)
+        std::cout << "  marker " << it.first << " area : " << it.second << std::endl;
+}
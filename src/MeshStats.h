@@ -0,0 +1,31 @@
+#ifndef MESH_STATS_H
+#define MESH_STATS_H
+
+#include <Eigen/Dense>
+#include <map>
+
+namespace MESHIO {
+
+	/**
+	 * Geometric statistics of a surface mesh.
+	 * Facets are treated as polygons and fanned from their first corner.
+	 */
+	struct MeshStats {
+		long nPoints = 0;
+		long nFacets = 0;
+		Eigen::Vector3d bboxMin = Eigen::Vector3d::Zero();
+		Eigen::Vector3d bboxMax = Eigen::Vector3d::Zero();
+		Eigen::Vector3d centroid = Eigen::Vector3d::Zero();   // mean of the points
+		Eigen::Vector3d median = Eigen::Vector3d::Zero();     // per axis, element n / 2
+		double area = 0.0;
+		double volume = 0.0;                                  // signed, positive for outward facets
+		std::map<int, double> markerArea;                     // only filled when M has one row per facet
+
+		Eigen::Vector3d extent() const { return bboxMax - bboxMin; }
+	};
+
+	int computeStats(const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M, MeshStats &stats, bool withMedian = true);
+	void printStats(const MeshStats &stats);
+};
+
+#endif
@@ -0,0 +1,915 @@
+#include "MeshStream.h"
+#include "MeshCells.h"
+#include "MeshTrace.h"
+
+#include <iostream>
+#include <sstream>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <time.h>
+
+#define BUFFER_LENGTH 256
+#define COUNT_WIDTH 20
+
+using namespace std;
+
+namespace {
+
+std::string fileExtension(const std::string &filename)
+{
+    size_t dotpos = filename.find_last_of('.');
+    if(dotpos == std::string::npos)
+        return "";
+    return filename.substr(dotpos + 1);
+}
+
+// Read lines until one contains pattern, leave it in line.
+bool seekLine(std::istream &file, std::string &line, const std::string &pattern)
+{
+    while(getline(file, line)) {
+        if(line.find(pattern) != std::string::npos)
+            return true;
+    }
+    return false;
+}
+
+// Position of the line starting with keyword after the current position, -1 if there is none.
+// The rest of the file is scanned in blocks, much faster than line by line; file is left at its position.
+std::streamoff findKeyword(std::istream &file, const std::string &keyword)
+{
+    const std::streampos start = file.tellg();
+    if(start < 0)
+        return -1;
+    const std::string pattern = "\n" + keyword;
+    std::vector<char> block(1 << 20);
+    std::streamoff blockStart = (std::streamoff)start - 1;   // the current position starts a line
+    size_t kept = 1;
+    block[0] = '\n';
+    std::streamoff found = -1;
+    while(found < 0) {
+        file.read(block.data() + kept, block.size() - kept);
+        size_t size = kept + file.gcount();
+        if(size < pattern.size())
+            break;
+        const char *hit = (const char *)memmem(block.data(), size, pattern.data(), pattern.size());
+        if(hit) {
+            found = blockStart + (hit - block.data()) + 1;
+            break;
+        }
+        if(!file)
+            break;
+        // Keep the tail, a keyword may straddle two blocks.
+        kept = pattern.size() - 1;
+        memmove(block.data(), block.data() + size - kept, kept);
+        blockStart += size - kept;
+    }
+    file.clear();
+    file.seekg(start);
+    return found;
+}
+
+// Next line that is not empty.
+bool nextLine(std::istream &file, std::string &line)
+{
+    while(getline(file, line)) {
+        if(line.find_first_not_of(" \t\r") != std::string::npos)
+            return true;
+    }
+    return false;
+}
+
+/********************************* Readers *********************************/
+
+class PLSStreamReader : public MESHIO::MeshStreamReader {
+public:
+    long pointsRead = 0;
+    long facetsRead = 0;
+
+    bool readHeader() override {
+        std::string line;
+        getline(f, line);
+        std::stringstream ss(line);
+        ss >> nFacets >> nPoints;
+        hasMarks = true;
+        return true;
+    }
+    long readPoints(std::vector<double> &points, long maxCount) override {
+        points.clear();
+        long n = 0;
+        for(; n < maxCount && pointsRead < nPoints; n++, pointsRead++) {
+            long index;
+            double x, y, z;
+            if(!(f >> index >> x >> y >> z))
+                break;
+            points.push_back(x); points.push_back(y); points.push_back(z);
+        }
+        return n;
+    }
+    bool beginFacets() override {
+        return true;
+    }
+    long readFacets(std::vector<int64_t> &facets, std::vector<int> &marks, long maxCount) override {
+        facets.clear();
+        marks.clear();
+        long n = 0;
+        for(; n < maxCount && facetsRead < nFacets; n++, facetsRead++) {
+            long index, a, b, c;
+            int m;
+            if(!(f >> index >> a >> b >> c >> m))
+                break;
+            facets.push_back(a - 1); facets.push_back(b - 1); facets.push_back(c - 1);
+            marks.push_back(m);
+        }
+        return n;
+    }
+};
+
+class VTKStreamReader : public MESHIO::MeshStreamReader {
+public:
+    std::string cellKeyword = "CELLS ";
+    long pointsRead = 0;
+    long facetsRead = 0;  // cells
+    long nCells = 0;
+    bool split = false;   // mixed cells, fanned into triangles
+    bool warned = false;
+    std::vector<uint8_t> cellTypes;  // CELL_TYPES of split cells, empty for POLYDATA
+
+    // Read CELL_TYPES ahead, the stream is left at its position. False when it can not seek.
+    bool peekCellTypes() {
+        const std::streampos start = f.tellg();
+        const std::streamoff types = findKeyword(f, "CELL_TYPES");
+        if(start < 0 || types < 0)
+            return false;
+        std::string line;
+        f.seekg(types);
+        getline(f, line);
+        cellTypes.resize(nCells);
+        for(long i = 0; i < nCells; i++) {
+            int type = 0;
+            f >> type;
+            cellTypes[i] = (uint8_t)type;
+        }
+        f.clear();
+        f.seekg(start);
+        return true;
+    }
+
+    bool readHeader() override {
+        std::string line;
+        while(getline(f, line)) {
+            if(line.find("DATASET") != std::string::npos && line.find("POLYDATA") != std::string::npos)
+                cellKeyword = "POLYGONS ";
+            if(line.find("POINTS ") != std::string::npos) {
+                std::stringstream ss(line);
+                std::string keyword;
+                ss >> keyword >> nPoints;
+                return true;
+            }
+        }
+        std::cout << "The format of VTK file is illegal, No POINTS. - " << filename << std::endl;
+        return false;
+    }
+    long readPoints(std::vector<double> &points, long maxCount) override {
+        points.clear();
+        long n = 0;
+        for(; n < maxCount && pointsRead < nPoints; n++, pointsRead++) {
+            double x, y, z;
+            if(!(f >> x >> y >> z))
+                break;
+            points.push_back(x); points.push_back(y); points.push_back(z);
+        }
+        return n;
+    }
+    bool beginFacets() override {
+        std::string line;
+        if(!seekLine(f, line, cellKeyword)) {
+            std::cout << "The format of VTK file is illegal, No " << cellKeyword << "- " << filename << std::endl;
+            return false;
+        }
+        std::stringstream ss(line);
+        std::string keyword;
+        long size = 0;
+        ss >> keyword >> nCells >> size;
+        nFacets = nCells;
+        nCorner = nFacets > 0 ? (int)(size / nFacets - 1) : 3;
+        // Cells of different sizes are split into triangles as they are read, how many is not known yet.
+        // So are cells of one size but other than triangles and tetrahedra: quads, polygons, pixels.
+        split = nCells > 0 && size != nCells * (nCorner + 1);
+        if(nCells > 0 && !split && nCorner > 3) {
+            if(cellKeyword == "POLYGONS ")
+                split = true;
+            else if(peekCellTypes()) {
+                for(uint8_t type : cellTypes)
+                    split = split || (nCorner == 4 ? type != MESHIO::CellTetra : MESHIO::isSurfaceCell(type));
+            }
+        }
+        if(split && cellKeyword != "POLYGONS " && cellTypes.empty())
+            peekCellTypes();
+        if(split) {
+            nCorner = 3;
+            nFacets = -1;
+        }
+        return true;
+    }
+    long readFacets(std::vector<int64_t> &facets, std::vector<int> &marks, long maxCount) override {
+        facets.clear();
+        marks.clear();
+        long n = 0;
+        if(split) {
+            std::vector<int64_t> cell;
+            for(; n < maxCount && facetsRead < nCells; facetsRead++) {
+                int count;
+                if(!(f >> count))
+                    break;
+                cell.resize(count);
+                for(int j = 0; j < count; j++)
+                    f >> cell[j];
+                const uint8_t type = cellTypes.empty() ? MESHIO::polygonType(count) : cellTypes[facetsRead];
+                if(!MESHIO::isSurfaceCell(type)) {
+                    if(!warned)
+                        std::cout << "Cells of different types, only the surface cells kept. - " << filename << std::endl;
+                    warned = true;
+                    continue;
+                }
+                if(type == MESHIO::CellPixel && count == 4)
+                    std::swap(cell[2], cell[3]);
+                for(int j = 1; j + 1 < count; j++, n++) {
+                    if(type == MESHIO::CellTriangleStrip) {
+                        const int k = j - 1;  // every other triangle of a strip is flipped
+                        facets.push_back(cell[k + (k & 1)]); facets.push_back(cell[k + 1 - (k & 1)]); facets.push_back(cell[k + 2]);
+                        continue;
+                    }
+                    facets.push_back(cell[0]); facets.push_back(cell[j]); facets.push_back(cell[j + 1]);
+                }
+            }
+            return n;
+        }
+        for(; n < maxCount && facetsRead < nFacets; n++, facetsRead++) {
+            int count;
+            if(!(f >> count))
+                break;
+            if(count != nCorner && !warned) {
+                std::cout << "Cells of different sizes, only " << nCorner << " corners of each kept. - " << filename << std::endl;
+                warned = true;
+            }
+            for(int j = 0; j < count; j++) {
+                int64_t v;
+                f >> v;
+                if(j < nCorner)
+                    facets.push_back(v);
+            }
+            for(int j = count; j < nCorner; j++)
+                facets.push_back(facets.back());
+        }
+        return n;
+    }
+    int readAttributes(MESHIO::MeshAttributes &attributes) override {
+        attributes.clear();
+        std::string line;
+        bool onPoints = false;
+        long rows = -1;  // of the current CELL_DATA or POINT_DATA, -1 to skip it
+        while(getline(f, line)) {
+            std::stringstream ss(line);
+            std::string keyword;
+            ss >> keyword;
+            if(keyword == "CELL_DATA" || keyword == "POINT_DATA") {
+                onPoints = keyword == "POINT_DATA";
+                ss >> rows;
+                if(rows != (onPoints ? nPoints : nCells)) {
+                    std::cout << "The number of " << keyword << " is not equal to number of " << (onPoints ? "points" : "cells") << ". Ignore " << keyword << " - " << filename << std::endl;
+                    rows = -1;
+                }
+                continue;
+            }
+            if(rows < 0 || keyword.empty() || !isalpha((unsigned char)keyword[0]))
+                continue;
+            if(MESHIO::readVTKArray(f, line, onPoints, rows, attributes) < 0) {
+                std::cout << "The format of VTK file is illegal, truncated " << keyword << ". - " << filename << std::endl;
+                return -1;
+            }
+        }
+        // The triangles of split cells are not remembered, so their cell arrays no longer fit.
+        if(split) {
+            for(size_t i = 0; i < attributes.size();) {
+                if(attributes[i].onPoints) {
+                    i++;
+                    continue;
+                }
+                std::cout << "Left out cell array " << attributes[i].name << ", the cells were split into triangles. - " << filename << std::endl;
+                attributes.erase(attributes.begin() + i);
+            }
+        }
+        return 1;
+    }
+};
+
+class MESHStreamReader : public MESHIO::MeshStreamReader {
+public:
+    long pointsRead = 0;
+    long facetsRead = 0;
+
+    bool readHeader() override {
+        std::string line;
+        while(getline(f, line)) {
+            std::stringstream ss(line);
+            std::string keyword;
+            ss >> keyword;
+            if(keyword == "Dimension") {
+                int dimension = 3;
+                if(!(ss >> dimension) && nextLine(f, line))
+                    dimension = atoi(line.c_str());
+                if(dimension != 3) {
+                    std::cout << "Only 3D .mesh files can be streamed. - " << filename << std::endl;
+                    return false;
+                }
+            }
+            if(keyword == "Vertices") {
+                if(!nextLine(f, line))
+                    break;
+                nPoints = atol(line.c_str());
+                hasMarks = true;
+                return true;
+            }
+        }
+        std::cout << "The format of MESH file is illegal, No Vertices. - " << filename << std::endl;
+        return false;
+    }
+    long readPoints(std::vector<double> &points, long maxCount) override {
+        points.clear();
+        long n = 0;
+        for(; n < maxCount && pointsRead < nPoints; n++, pointsRead++) {
+            double x, y, z;
+            long ref;
+            if(!(f >> x >> y >> z >> ref))
+                break;
+            points.push_back(x); points.push_back(y); points.push_back(z);
+        }
+        return n;
+    }
+    bool beginFacets() override {
+        std::string line;
+        // Like readMESH, the Tetrahedra of a volume mesh come before its Triangles.
+        std::streamoff tetrahedra = findKeyword(f, "Tetrahedra");
+        if(tetrahedra >= 0) {
+            f.seekg(tetrahedra);
+            getline(f, line);
+            nCorner = 4;
+        } else if(!seekLine(f, line, "Triangles")) {
+            std::cout << "The format of MESH file is illegal, No Triangles. - " << filename << std::endl;
+            return false;
+        }
+        if(!nextLine(f, line)) {
+            std::cout << "The format of MESH file is illegal, No Triangles. - " << filename << std::endl;
+            return false;
+        }
+        nFacets = atol(line.c_str());
+        return true;
+    }
+    long readFacets(std::vector<int64_t> &facets, std::vector<int> &marks, long maxCount) override {
+        facets.clear();
+        marks.clear();
+        long n = 0;
+        for(; n < maxCount && facetsRead < nFacets; n++, facetsRead++) {
+            int64_t corner[4];
+            int ref;
+            for(int j = 0; j < nCorner; j++)
+                f >> corner[j];
+            if(!(f >> ref))
+                break;
+            for(int j = 0; j < nCorner; j++)
+                facets.push_back(corner[j] - 1);
+            marks.push_back(ref - 1);
+        }
+        return n;
+    }
+};
+
+// OBJ states no counts and may interleave points and facets, so it is read in two passes.
+class OBJStreamReader : public MESHIO::MeshStreamReader {
+public:
+    std::string line;
+    int curMark = 0;
+
+    bool readHeader() override {
+        hasMarks = true;
+        return true;
+    }
+    long readPoints(std::vector<double> &points, long maxCount) override {
+        points.clear();
+        long n = 0;
+        while(n < maxCount && getline(f, line)) {
+            if(line.size() < 2 || line[0] != 'v' || (line[1] != ' ' && line[1] != '\t'))
+                continue;
+            const char *p = line.c_str() + 1;
+            char *end;
+            for(int k = 0; k < 3; k++) {
+                points.push_back(strtod(p, &end));
+                p = end;
+            }
+            n++;
+        }
+        return n;
+    }
+    bool beginFacets() override {
+        f.clear();
+        f.seekg(0);
+        return true;
+    }
+    long readFacets(std::vector<int64_t> &facets, std::vector<int> &marks, long maxCount) override {
+        facets.clear();
+        marks.clear();
+        long n = 0;
+        while(n < maxCount && getline(f, line)) {
+            if(line.empty())
+                continue;
+            if(line[0] == 'g') {
+                ++curMark;
+                continue;
+            }
+            if(line.size() < 2 || line[0] != 'f' || (line[1] != ' ' && line[1] != '\t'))
+                continue;
+            // Corners look like v, v/vt, v//vn or v/vt/vn; strtol stops at the slash.
+            const char *p = line.c_str() + 1;
+            char *end;
+            for(int k = 0; k < 3; k++) {
+                facets.push_back(strtoll(p, &end, 10) - 1);
+                p = end;
+                while(*p != '\0' && *p != ' ' && *p != '\t')
+                    p++;
+            }
+            marks.push_back(curMark);
+            n++;
+        }
+        return n;
+    }
+};
+
+}
+
+bool MESHIO::MeshStreamReader::open(const std::string &filename)
+{
+    this->filename = filename;
+    file.open(filename);
+    if(!file.is_open()) {
+        std::cout << "No such file. - " << filename << std::endl;
+        return false;
+    }
+    f.rdbuf(file.rdbuf());
+    f.clear();
+    return readHeader();
+}
+
+bool MESHIO::MeshStreamReader::open(std::istream &in, const std::string &name)
+{
+    filename = name;
+    f.rdbuf(in.rdbuf());
+    f.clear();
+    return readHeader();
+}
+
+namespace {
+
+/********************************* Writers *********************************/
+
+class VTKStreamWriter : public MESHIO::MeshStreamWriter {
+public:
+    std::streampos pointSlot = -1;
+    std::streampos facetSlot = -1;
+    std::streampos sizeSlot = -1;
+    FILE *markSpill = nullptr;
+    const MESHIO::MeshAttributes *attributes = nullptr;
+
+    ~VTKStreamWriter() {
+        if(markSpill)
+            fclose(markSpill);
+    }
+    void beginPoints(long nPoints, long nFacets) override {
+        f.precision(std::numeric_limits<double>::digits10 + 1);
+        f << "# vtk DataFile Version 2.0\n";
+        f << "TetWild Mesh\n";
+        f << "ASCII\n";
+        f << "DATASET UNSTRUCTURED_GRID\n";
+        f << "POINTS ";
+        writeCount(nPoints, pointSlot);
+        f << " double\n";
+    }
+    void writePoints(const std::vector<double> &points) override {
+        for(size_t i = 0; i < points.size(); i += 3)
+            f << points[i] << " " << points[i + 1] << " " << points[i + 2] << "\n";
+        pointCount += points.size() / 3;
+    }
+    void beginFacets(long nFacets, int nCorner) override {
+        this->nCorner = nCorner;
+        f << "CELLS ";
+        writeCount(nFacets, facetSlot);
+        f << " ";
+        writeCount(nFacets < 0 ? -1 : nFacets * (nCorner + 1), sizeSlot);
+        f << "\n";
+    }
+    void writeFacets(const std::vector<int64_t> &facets, const std::vector<int> &marks, bool hasMarks) override {
+        for(size_t i = 0; i < facets.size(); i += nCorner) {
+            f << nCorner << " ";
+            for(int j = 0; j < nCorner; j++)
+                f << facets[i + j] << " ";
+            f << "\n";
+        }
+        facetCount += facets.size() / nCorner;
+        // The markers go after CELL_TYPES, so they wait in a temporary file, not in memory.
+        if(hasMarks) {
+            if(!markSpill)
+                markSpill = tmpfile();
+            for(int m : marks)
+                fprintf(markSpill, "%d\n", m);
+        }
+    }
+    void writeAttributes(const MESHIO::MeshAttributes &attributes) override {
+        this->attributes = &attributes;
+    }
+    bool finish() override {
+        int cellType = 0;
+        if(nCorner == 2)
+            cellType = 3;
+        else if(nCorner == 3)
+            cellType = 5;
+        else if(nCorner == 4)
+            cellType = 10;
+        f << "CELL_TYPES " << facetCount << "\n";
+        for(long i = 0; i < facetCount; i++)
+            f << cellType << "\n";
+        if(markSpill) {
+            f << "CELL_DATA " << facetCount << "\n";
+            f << "SCALARS  int 1\n";
+            f << "LOOKUP_TABLE default\n";
+            rewind(markSpill);
+            char buffer[1 << 16];
+            size_t n;
+            while((n = fread(buffer, 1, sizeof(buffer), markSpill)) > 0)
+                f.write(buffer, n);
+            f << "\n";
+        }
+        if(attributes)
+            MESHIO::writeVTKArrays(f, *attributes, pointCount, facetCount, markSpill != nullptr);
+        patchCount(pointSlot, pointCount);
+        patchCount(facetSlot, facetCount);
+        patchCount(sizeSlot, facetCount * (nCorner + 1));
+        f.close();
+        return true;
+    }
+};
+
+class PLYStreamWriter : public MESHIO::MeshStreamWriter {
+public:
+    std::streampos pointSlot = -1;
+    std::streampos facetSlot = -1;
+
+    void beginPoints(long nPoints, long nFacets) override {
+        f.precision(std::numeric_limits<double>::digits10 + 1);
+        f << "ply\n";
+        f << "format ascii 1.0\n";
+        f << "comment VTK generated PLY File\n";
+        f << "obj_info vtkPolyData points and polygons: vtk4.0\n";
+        f << "element vertex ";
+        writeCount(nPoints, pointSlot);
+        f << "\n";
+        f << "property float x\n";
+        f << "property float y\n";
+        f << "property float z\n";
+        f << "element face ";
+        writeCount(nFacets, facetSlot);
+        f << "\n";
+        f << "property list uchar int vertex_indices\n";
+        f << "end_header\n";
+    }
+    void writePoints(const std::vector<double> &points) override {
+        for(size_t i = 0; i < points.size(); i += 3)
+            f << points[i] << " " << points[i + 1] << " " << points[i + 2] << "\n";
+        pointCount += points.size() / 3;
+    }
+    void beginFacets(long nFacets, int nCorner) override {
+        this->nCorner = nCorner;
+        if(nCorner != 3)
+            std::cout << "Unsupported format for .ply file." << std::endl;
+    }
+    void writeFacets(const std::vector<int64_t> &facets, const std::vector<int> &marks, bool hasMarks) override {
+        if(nCorner != 3)
+            return;
+        for(size_t i = 0; i < facets.size(); i += 3)
+            f << 3 << " " << facets[i] << " " << facets[i + 1] << " " << facets[i + 2] << "\n";
+        facetCount += facets.size() / 3;
+    }
+    bool finish() override {
+        patchCount(pointSlot, pointCount);
+        patchCount(facetSlot, facetCount);
+        f.close();
+        return nCorner == 3;
+    }
+};
+
+class PLSStreamWriter : public MESHIO::MeshStreamWriter {
+public:
+    std::streampos pointSlot = -1;
+    std::streampos facetSlot = -1;
+
+    void beginPoints(long nPoints, long nFacets) override {
+        writeCount(nFacets, facetSlot);
+        f << " ";
+        writeCount(nPoints, pointSlot);
+        f << " 0 0 0 0\n";
+    }
+    void writePoints(const std::vector<double> &points) override {
+        for(size_t i = 0; i < points.size(); i += 3)
+            f << ++pointCount << " " << points[i] << " " << points[i + 1] << " " << points[i + 2] << "\n";
+    }
+    void beginFacets(long nFacets, int nCorner) override {
+        this->nCorner = nCorner;
+        if(nCorner != 3)
+            std::cout << "Unsupported format for .pls file." << std::endl;
+    }
+    void writeFacets(const std::vector<int64_t> &facets, const std::vector<int> &marks, bool hasMarks) override {
+        if(nCorner != 3)
+            return;
+        for(size_t i = 0, k = 0; i < facets.size(); i += 3, k++)
+            f << ++facetCount << " " << facets[i] + 1 << " " << facets[i + 1] + 1 << " " << facets[i + 2] + 1 << " " << (hasMarks ? marks[k] : 0) + 1 << "\n";
+    }
+    bool finish() override {
+        patchCount(pointSlot, pointCount);
+        patchCount(facetSlot, facetCount);
+        f.close();
+        return nCorner == 3;
+    }
+};
+
+class MESHStreamWriter : public MESHIO::MeshStreamWriter {
+public:
+    std::streampos pointSlot = -1;
+    std::streampos facetSlot = -1;
+
+    void beginPoints(long nPoints, long nFacets) override {
+        f.precision(std::numeric_limits<double>::digits10 + 1);
+        f << "MeshVersionFormatted 1\n";
+        f << "Dimension 3\n";
+        f << "Vertices\n";
+        writeCount(nPoints, pointSlot);
+        f << "\n";
+    }
+    void writePoints(const std::vector<double> &points) override {
+        for(size_t i = 0; i < points.size(); i += 3)
+            f << points[i] << " " << points[i + 1] << " " << points[i + 2] << " " << ++pointCount << "\n";
+    }
+    void beginFacets(long nFacets, int nCorner) override {
+        this->nCorner = nCorner;
+        if(nCorner == 3)
+            f << "Triangles\n";
+        else if(nCorner == 4)
+            f << "Tetrahedra\n";
+        else {
+            std::cout << "Unsupported format for .mesh file." << std::endl;
+            return;
+        }
+        writeCount(nFacets, facetSlot);
+        f << "\n";
+    }
+    void writeFacets(const std::vector<int64_t> &facets, const std::vector<int> &marks, bool hasMarks) override {
+        if(nCorner != 3 && nCorner != 4)
+            return;
+        for(size_t i = 0; i < facets.size(); i += nCorner) {
+            for(int j = 0; j < nCorner; j++)
+                f << facets[i + j] + 1 << " ";
+            f << ++facetCount << "\n";
+        }
+    }
+    bool finish() override {
+        patchCount(pointSlot, pointCount);
+        patchCount(facetSlot, facetCount);
+        f.close();
+        return nCorner == 3 || nCorner == 4;
+    }
+};
+
+class FacetStreamWriter : public MESHIO::MeshStreamWriter {
+public:
+    std::streampos pointSlot = -1;
+    std::streampos facetSlot = -1;
+
+    void beginPoints(long nPoints, long nFacets) override {
+        f.precision(std::numeric_limits<double>::digits10 + 1);
+        f << "FACET FILE V3.0  exported from Meshconverter http://10.12.220.71/tools/meshconverter \n";
+        f << 1 << "\n";
+        f << "Grid\n";
+        f << "0, 0.00 0.00 0.00 0.00\n";
+        writeCount(nPoints, pointSlot);
+        f << "\n";
+    }
+    void writePoints(const std::vector<double> &points) override {
+        for(size_t i = 0; i < points.size(); i += 3)
+            f << points[i] << " " << points[i + 1] << " " << points[i + 2] << "\n";
+        pointCount += points.size() / 3;
+    }
+    void beginFacets(long nFacets, int nCorner) override {
+        this->nCorner = nCorner;
+        f << 1 << "\n";
+        f << "Triangles\n";
+        writeCount(nFacets, facetSlot);
+        f << " 3\n";
+    }
+    void writeFacets(const std::vector<int64_t> &facets, const std::vector<int> &marks, bool hasMarks) override {
+        for(size_t i = 0, k = 0; i < facets.size(); i += nCorner, k++) {
+            f << " " << facets[i] + 1 << " " << facets[i + 1] + 1 << " " << facets[i + 2] + 1 << " 0 ";
+            f << (hasMarks ? marks[k] : 0);
+            f << " " << ++facetCount << "\n";
+        }
+    }
+    bool finish() override {
+        patchCount(pointSlot, pointCount);
+        patchCount(facetSlot, facetCount);
+        f.close();
+        return true;
+    }
+};
+
+// A facet stream can not be sorted, so a group is opened whenever the marker changes.
+class OBJStreamWriter : public MESHIO::MeshStreamWriter {
+public:
+    bool grouped = false;
+    int curGroup = 0;
+
+    void beginPoints(long nPoints, long nFacets) override {
+        f.precision(std::numeric_limits<double>::digits10 + 1);
+        char stime[BUFFER_LENGTH] = {0};
+        time_t now_time;
+        time(&now_time);
+        strftime(stime, sizeof(stime), "%H:%M:%S", localtime(&now_time));
+        f << "# TIGER Mesh converter. (c) 2021.\n";
+        f << "# Created File: " << stime << "\n";
+        f << "# \n";
+        f << "# object default\n";
+        f << "# \n";
+        f << "\n";
+    }
+    void writePoints(const std::vector<double> &points) override {
+        for(size_t i = 0; i < points.size(); i += 3)
+            f << "v " << points[i] << " " << points[i + 1] << " " << points[i + 2] << "\n";
+        pointCount += points.size() / 3;
+    }
+    void beginFacets(long nFacets, int nCorner) override {
+        this->nCorner = nCorner;
+        f << "# " << pointCount << " vertices\n\n";
+    }
+    void writeFacets(const std::vector<int64_t> &facets, const std::vector<int> &marks, bool hasMarks) override {
+        for(size_t i = 0, k = 0; i < facets.size(); i += nCorner, k++) {
+            int group = hasMarks ? marks[k] : 0;
+            if(!grouped || group != curGroup) {
+                grouped = true;
+                curGroup = group;
+                f << "g " << curGroup << "\n";
+            }
+            f << "f";
+            for(int j = 0; j < nCorner; j++)
+                f << " " << facets[i + j] + 1;
+            f << "\n";
+        }
+        facetCount += facets.size() / nCorner;
+    }
+    bool finish() override {
+        f << "# " << facetCount << " faces\n\n";
+        f.close();
+        return true;
+    }
+};
+
+}
+
+bool MESHIO::MeshStreamWriter::open(const std::string &filename)
+{
+    this->filename = filename;
+    f.open(filename, std::ios::out | std::ios::binary);
+    if(!f.is_open()) {
+        std::cout << "Write file failed. - " << filename << std::endl;
+        return false;
+    }
+    std::cout << "Writing mesh to - " << filename << std::endl;
+    return true;
+}
+
+/**
+ * Write a known count, or reserve a blank field of COUNT_WIDTH characters for patchCount.
+ */
+void MESHIO::MeshStreamWriter::writeCount(long n, std::streampos &slot)
+{
+    if(n >= 0) {
+        f << n;
+        slot = -1;
+        return;
+    }
+    slot = f.tellp();
+    f << std::string(COUNT_WIDTH, ' ');
+}
+
+void MESHIO::MeshStreamWriter::patchCount(std::streampos slot, long n)
+{
+    if(slot == std::streampos(-1))
+        return;
+    std::streampos end = f.tellp();
+    f.seekp(slot);
+    f << n;
+    f.seekp(end);
+}
+
+std::unique_ptr<MESHIO::MeshStreamReader> MESHIO::makeStreamReader(const std::string &format)
+{
+    if(format == "pls")
+        return std::unique_ptr<MeshStreamReader>(new PLSStreamReader());
+    if(format == "vtk")
+        return std::unique_ptr<MeshStreamReader>(new VTKStreamReader());
+    if(format == "mesh")
+        return std::unique_ptr<MeshStreamReader>(new MESHStreamReader());
+    if(format == "obj")
+        return std::unique_ptr<MeshStreamReader>(new OBJStreamReader());
+    return nullptr;
+}
+
+std::unique_ptr<MESHIO::MeshStreamWriter> MESHIO::makeStreamWriter(const std::string &format)
+{
+    if(format == "vtk")
+        return std::unique_ptr<MeshStreamWriter>(new VTKStreamWriter());
+    if(format == "ply")
+        return std::unique_ptr<MeshStreamWriter>(new PLYStreamWriter());
+    if(format == "pls")
+        return std::unique_ptr<MeshStreamWriter>(new PLSStreamWriter());
+    if(format == "mesh")
+        return std::unique_ptr<MeshStreamWriter>(new MESHStreamWriter());
+    if(format == "facet")
+        return std::unique_ptr<MeshStreamWriter>(new FacetStreamWriter());
+    if(format == "obj")
+        return std::unique_ptr<MeshStreamWriter>(new OBJStreamWriter());
+    return nullptr;
+}
+
+/**
+ * Convert a mesh file without loading it: chunks pulled from the reader are pushed to
+ * every writer, so memory stays bounded by the chunk size whatever the mesh size. Only
+ * the VTK data arrays are read whole, after the facets, and go to the VTK outputs.
+ * @param input input filename, the format is given by the extension.
+ * @param outputs output filenames, the formats are given by the extensions.
+ * @return 1/-1
+ */
+int MESHIO::streamConvert(const std::string &input, const std::vector<std::string> &outputs)
+{
+    MESH_TRACE("streamConvert", input);
+    const long chunkSize = 1 << 16;
+
+    std::unique_ptr<MeshStreamReader> reader = makeStreamReader(fileExtension(input));
+    if(!reader) {
+        std::cout << "Unsupported input format for streaming - " << fileExtension(input) << std::endl;
+        return -1;
+    }
+    // Every format is checked before any file is opened, so a refused output leaves no empty files.
+    std::vector<std::unique_ptr<MeshStreamWriter>> writers;
+    for(const std::string &output : outputs) {
+        std::unique_ptr<MeshStreamWriter> writer = makeStreamWriter(fileExtension(output));
+        if(!writer) {
+            std::cout << "Unsupported output format for streaming - " << fileExtension(output) << std::endl;
+            return -1;
+        }
+        writers.push_back(std::move(writer));
+    }
+    if(!reader->open(input))
+        return -1;
+    for(size_t i = 0; i < writers.size(); i++)
+        if(!writers[i]->open(outputs[i]))
+            return -1;
+
+    std::vector<double> points;
+    for(auto &writer : writers)
+        writer->beginPoints(reader->nPoints, reader->nFacets);
+    while(reader->readPoints(points, chunkSize) > 0) {
+        for(auto &writer : writers)
+            writer->writePoints(points);
+    }
+
+    if(!reader->beginFacets())
+        return -1;
+    std::vector<int64_t> facets;
+    std::vector<int> marks;
+    for(auto &writer : writers)
+        writer->beginFacets(reader->nFacets, reader->nCorner);
+    while(reader->readFacets(facets, marks, chunkSize) > 0) {
+        for(auto &writer : writers)
+            writer->writeFacets(facets, marks, reader->hasMarks);
+    }
+    MeshAttributes attributes;
+    if(reader->readAttributes(attributes) < 0)
+        return -1;
+    for(auto &writer : writers)
+        writer->writeAttributes(attributes);
+
+    int result = 1;
+    for(auto &writer : writers) {
+        if(!writer->finish())
+            result = -1;
+    }
+    return result;
+}
@@ -0,0 +1,82 @@
+#ifndef MESH_STREAM_H
+#define MESH_STREAM_H
+
+#include "MeshAttributes.h"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MESHIO {
+
+	/**
+	 * Pull interface over a mesh file. All points are read first, then all facets, a chunk
+	 * at a time, so memory use does not depend on the size of the mesh.
+	 * Counts are -1 as long as the format has not stated them.
+	 */
+	class MeshStreamReader {
+	public:
+		long nPoints = -1;
+		long nFacets = -1;
+		int nCorner = 3;
+		bool hasMarks = false;
+
+		virtual ~MeshStreamReader() {}
+		bool open(const std::string &filename);
+		// Read from a stream the caller keeps alive, name is only used in messages.
+		bool open(std::istream &in, const std::string &name = "");
+		// Fill points with up to maxCount points (x y z), return the number read, 0 at the end.
+		virtual long readPoints(std::vector<double> &points, long maxCount) = 0;
+		// Move on to the facets. nFacets and nCorner are known afterwards if the format states them.
+		virtual bool beginFacets() = 0;
+		// Fill facets with up to maxCount zero based facets and marks with their markers.
+		// Indices are 64-bit, so a stream is not limited to 2^31 points.
+		virtual long readFacets(std::vector<int64_t> &facets, std::vector<int> &marks, long maxCount) = 0;
+		// After the facets, the point and cell data arrays that follow them, none for most formats.
+		// Unlike points and facets they are held in memory. @return 1/-1
+		virtual int readAttributes(MeshAttributes &attributes) { attributes.clear(); return 1; }
+
+	protected:
+		std::ifstream file;
+		std::istream f{nullptr};  // reads from file, or from the stream given to open
+		std::string filename;
+
+		// Parse what precedes the points, nPoints is known afterwards if the format states it.
+		virtual bool readHeader() = 0;
+	};
+
+	/**
+	 * Push interface writing a mesh file incrementally. A count passed as -1 is written as
+	 * a blank placeholder and patched in by finish(), once the real count is known.
+	 */
+	class MeshStreamWriter {
+	public:
+		virtual ~MeshStreamWriter() {}
+		bool open(const std::string &filename);
+		virtual void beginPoints(long nPoints, long nFacets) = 0;
+		virtual void writePoints(const std::vector<double> &points) = 0;
+		virtual void beginFacets(long nFacets, int nCorner) = 0;
+		virtual void writeFacets(const std::vector<int64_t> &facets, const std::vector<int> &marks, bool hasMarks) = 0;
+		// Arrays to write along in finish(), kept by reference; formats without data arrays ignore them.
+		virtual void writeAttributes(const MeshAttributes &) {}
+		virtual bool finish() = 0;
+
+	protected:
+		std::ofstream f;
+		std::string filename;
+		long pointCount = 0;
+		long facetCount = 0;
+		int nCorner = 3;
+
+		void writeCount(long n, std::streampos &slot);
+		void patchCount(std::streampos slot, long n);
+	};
+
+	std::unique_ptr<MeshStreamReader> makeStreamReader(const std::string &format);
+	std::unique_ptr<MeshStreamWriter> makeStreamWriter(const std::string &format);
+	int streamConvert(const std::string &input, const std::vector<std::string> &outputs);
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "MeshTrace.h"
+#include "MiniJson.h"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+struct TraceEvent {
+    const char *name;
+    std::string detail;
+    long long start;
+    long long end;
+};
+
+struct ThreadBuffer {
+    int tid;
+    bool main;
+    std::vector<TraceEvent> events;
+};
+
+std::mutex registryLock;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+long long traceOrigin = 0;
+std::thread::id mainThread;
+
+// Registered on the first span of a thread and kept until exit, so buffers of finished pool threads are still written.
+ThreadBuffer &threadBuffer()
+{
+    static thread_local ThreadBuffer *buffer = nullptr;
+    if(!buffer) {
+        std::lock_guard<std::mutex> guard(registryLock);
+        registry.emplace_back(new ThreadBuffer());
+        buffer = registry.back().get();
+        buffer->tid = (int)registry.size();
+        buffer->main = std::this_thread::get_id() == mainThread;
+    }
+    return *buffer;
+}
+
+}
+
+std::atomic<bool> MESHIO::Trace::active(false);
+
+void MESHIO::Trace::start()
+{
+    traceOrigin = nowMicros();
+    mainThread = std::this_thread::get_id();
+    active.store(true);
+}
+
+void MESHIO::Trace::record(const char *name, const std::string &detail, long long startMicros, long long endMicros)
+{
+    threadBuffer().events.push_back({name, detail, startMicros, endMicros});
+}
+
+/**
+ * {"traceEvents": [{"name": "readVTK", "cat": "mesh", "ph": "X", "ts": .., "dur": .., "pid": 1, "tid": 2,
+ *   "args": {"detail": "part.vtk"}}, ...], "displayTimeUnit": "ms"}
+ */
+bool MESHIO::Trace::write(const std::string &filename)
+{
+    active.store(false);
+    std::ofstream f(filename);
+    if(!f.is_open()) {
+        std::cout << "Write trace failed. - " << filename << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(registryLock);
+    f << "{\"traceEvents\": [";
+    bool first = true;
+    for(const auto &buffer : registry) {
+        f << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+          << ", \"args\": {\"name\": \"" << (buffer->main ? "main" : "worker " + std::to_string(buffer->tid)) << "\"}}";
+        first = false;
+        for(const TraceEvent &e : buffer->events) {
+            f << ",\n{\"name\": " << jsonString(e.name) << ", \"cat\": \"mesh\", \"ph\": \"X\", \"ts\": " << e.start - traceOrigin
+              << ", \"dur\": " << e.end - e.start << ", \"pid\": 1, \"tid\": " << buffer->tid;
+            if(!e.detail.empty())
+                f << ", \"args\": {\"detail\": " << jsonString(e.detail) << "}";
+            f << "}";
+        }
+    }
+    f << "\n], \"displayTimeUnit\": \"ms\"}\n";
+    return true;
+}
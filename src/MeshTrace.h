@@ -0,0 +1,59 @@
+#ifndef MESH_TRACE_H
+#define MESH_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace MESHIO {
+
+	/**
+	 * Scoped spans written as Chrome trace-event JSON (chrome://tracing, Perfetto).
+	 * Every thread records into its own buffer, so spans inside OpenMP regions and pool
+	 * tasks cost no locking. While tracing is off a span is one relaxed atomic load.
+	 */
+	namespace Trace {
+		extern std::atomic<bool> active;
+
+		inline bool enabled() { return active.load(std::memory_order_relaxed); }
+		inline long long nowMicros() {
+			return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+		void start();
+		// Stop recording and write every span recorded so far.
+		bool write(const std::string &filename);
+		void record(const char *name, const std::string &detail, long long startMicros, long long endMicros);
+	}
+
+	class TraceSpan {
+	public:
+		explicit TraceSpan(const char *name) {
+			if(Trace::enabled()) {
+				this->name = name;
+				startMicros = Trace::nowMicros();
+			}
+		}
+		TraceSpan(const char *name, const std::string &detail) : TraceSpan(name) {
+			if(this->name)
+				this->detail = detail;
+		}
+		~TraceSpan() {
+			if(name)
+				Trace::record(name, detail, startMicros, Trace::nowMicros());
+		}
+		TraceSpan(const TraceSpan &) = delete;
+		TraceSpan &operator=(const TraceSpan &) = delete;
+
+	private:
+		const char *name = nullptr;
+		std::string detail;
+		long long startMicros = 0;
+	};
+};
+
+#define MESH_TRACE_JOIN2(a, b) a##b
+#define MESH_TRACE_JOIN(a, b) MESH_TRACE_JOIN2(a, b)
+// Span from here to the end of the enclosing scope, name must be a string literal.
+#define MESH_TRACE(...) MESHIO::TraceSpan MESH_TRACE_JOIN(meshTraceSpan, __LINE__)(__VA_ARGS__)
+
+#endif
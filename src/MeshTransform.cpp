@@ -0,0 +1,120 @@
+#include "MeshTransform.h"
+#include "MeshTrace.h"
+#include "meshIO.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+/**
+ * Rotation by PI * angle around the axis through start.
+ */
+Eigen::Matrix4d MESHIO::rotationTransform(const Eigen::Vector3d &start, const Eigen::Vector3d &axis, double angle)
+{
+    Eigen::Affine3d A = Eigen::Translation3d(start) * Eigen::AngleAxisd(M_PI * angle, axis.normalized()) * Eigen::Translation3d(-start);
+    return A.matrix();
+}
+
+/**
+ * Compose a sequence of operation strings into a single matrix.
+ * @param ops operations, the first one is applied first.
+ * @param A composed transform.
+ * @return false if an operation is malformed.
+ */
+bool MESHIO::parseTransform(const vector<string> &ops, Eigen::Matrix4d &A)
+{
+    A.setIdentity();
+    for(const string &op : ops) {
+        size_t colon = op.find(':');
+        string name = op.substr(0, colon);
+        vector<double> args;
+        string axisName;
+        if(colon != string::npos) {
+            stringstream ss(op.substr(colon + 1));
+            string word;
+            while(getline(ss, word, ',')) {
+                if(word == "x" || word == "y" || word == "z") {
+                    axisName = word;
+                    continue;
+                }
+                try {
+                    args.push_back(stod(word));
+                } catch(...) {
+                    std::cout << "Illegal transform parameter \"" << word << "\" in - " << op << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        Eigen::Matrix4d step = Eigen::Matrix4d::Identity();
+        if(name == "rotate" && args.size() == 4) {
+            step = rotationTransform(Eigen::Vector3d::Zero(), Eigen::Vector3d(args[0], args[1], args[2]), args[3]);
+        }
+        else if(name == "rotate" && args.size() == 7) {
+            step = rotationTransform(Eigen::Vector3d(args[0], args[1], args[2]), Eigen::Vector3d(args[3], args[4], args[5]), args[6]);
+        }
+        else if(name == "translate" && args.size() == 3) {
+            step.block<3, 1>(0, 3) << args[0], args[1], args[2];
+        }
+        else if(name == "scale" && args.size() == 1) {
+            step.block<3, 3>(0, 0) *= args[0];
+        }
+        else if(name == "scale" && args.size() == 3) {
+            step.block<3, 3>(0, 0) = Eigen::Vector3d(args[0], args[1], args[2]).asDiagonal();
+        }
+        else if(name == "mirror" && (!axisName.empty() || args.size() == 3)) {
+            Eigen::Vector3d n = Eigen::Vector3d::Zero();
+            if(!axisName.empty())
+                n[axisName[0] - 'x'] = 1.0;
+            else
+                n << args[0], args[1], args[2];
+            n.normalize();
+            step.block<3, 3>(0, 0) -= 2.0 * n * n.transpose();
+        }
+        else {
+            std::cout << "The format of transform is Error. - " << op << std::endl;
+            std::cout << "Format is rotate:[start_x,start_y,start_z,]end_x,end_y,end_z,angle | translate:x,y,z | scale:s | scale:sx,sy,sz | mirror:x|y|z | mirror:nx,ny,nz" << std::endl;
+            return false;
+        }
+        A = step * A;
+    }
+    return true;
+}
+
+/**
+ * Apply an affine transform in place, in one pass over V.
+ * V is column major, so x, y and z are three contiguous arrays and the loop vectorizes.
+ * A transform with negative determinant (mirror) also flips the facet winding.
+ * @param A
+ * @param V
+ * @param T
+ * @return
+ */
+bool MESHIO::applyTransform(const Eigen::Matrix4d &A, Eigen::MatrixXd &V, Eigen::MatrixXi &T)
+{
+    MESH_TRACE("applyTransform");
+    if(V.cols() != 3) {
+        std::cout << "Transform needs 3D points." << std::endl;
+        return false;
+    }
+    const double a00 = A(0, 0), a01 = A(0, 1), a02 = A(0, 2), a03 = A(0, 3);
+    const double a10 = A(1, 0), a11 = A(1, 1), a12 = A(1, 2), a13 = A(1, 3);
+    const double a20 = A(2, 0), a21 = A(2, 1), a22 = A(2, 2), a23 = A(2, 3);
+    double *x = V.col(0).data();
+    double *y = V.col(1).data();
+    double *z = V.col(2).data();
+    const long n = V.rows();
+#pragma omp parallel for simd schedule(static)
+    for(long i = 0; i < n; i++) {
+        const double px = x[i], py = y[i], pz = z[i];
+        x[i] = a00 * px + a01 * py + a02 * pz + a03;
+        y[i] = a10 * px + a11 * py + a12 * pz + a13;
+        z[i] = a20 * px + a21 * py + a22 * pz + a23;
+    }
+
+    // Swapping two corners reverses triangles and quads and flips tetrahedra.
+    if(A.block<3, 3>(0, 0).determinant() < 0 && T.cols() >= 3)
+        T.col(0).swap(T.col(2));
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef MESH_TRANSFORM_H
+#define MESH_TRANSFORM_H
+
+#include <Eigen/Dense>
+#include <string>
+#include <vector>
+
+namespace MESHIO {
+
+	/**
+	 * Affine transforms in homogeneous coordinates. A sequence of operations is composed
+	 * into one 4x4 matrix, so the points are only visited once whatever the length of the sequence.
+	 *
+	 * Operation strings, applied in the given order:
+	 *   rotate:end_x,end_y,end_z,angle
+	 *   rotate:start_x,start_y,start_z,end_x,end_y,end_z,angle   (angle in units of PI, as -r)
+	 *   translate:x,y,z
+	 *   scale:s  or  scale:sx,sy,sz
+	 *   mirror:x|y|z  or  mirror:nx,ny,nz   (plane through the origin)
+	 */
+	Eigen::Matrix4d rotationTransform(const Eigen::Vector3d &start, const Eigen::Vector3d &axis, double angle);
+	bool parseTransform(const std::vector<std::string> &ops, Eigen::Matrix4d &A);
+	bool applyTransform(const Eigen::Matrix4d &A, Eigen::MatrixXd &V, Eigen::MatrixXi &T);
+};
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef MINI_JSON_H
+#define MINI_JSON_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Just enough JSON for the small messages and reports of the converter:
+ * a parsed value tree and string quoting for the writers.
+ */
+class JsonValue {
+public:
+    enum Type { Null, Bool, Number, String, Array, Object };
+    Type type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    inline const JsonValue *find(const std::string &key) const {
+        for(const auto &m : members)
+            if(m.first == key)
+                return &m.second;
+        return nullptr;
+    }
+
+    static inline bool parse(const std::string &source, JsonValue &value, std::string *error = nullptr) {
+        size_t pos = 0;
+        bool ok = parseValue(source, pos, value, 0);
+        skipSpace(source, pos);
+        if(ok && pos != source.size())
+            ok = false;
+        if(!ok && error)
+            *error = "Illegal JSON near offset " + std::to_string(pos);
+        return ok;
+    }
+
+private:
+    static inline void skipSpace(const std::string &s, size_t &pos) {
+        while(pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\n' || s[pos] == '\r'))
+            pos++;
+    }
+    static inline void appendUtf8(std::string &out, unsigned code) {
+        if(code < 0x80) {
+            out += (char)code;
+        }
+        else if(code < 0x800) {
+            out += (char)(0xC0 | (code >> 6));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+        else {
+            out += (char)(0xE0 | (code >> 12));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+    }
+    static inline bool parseString(const std::string &s, size_t &pos, std::string &out) {
+        if(pos >= s.size() || s[pos] != '"')
+            return false;
+        pos++;
+        while(pos < s.size() && s[pos] != '"') {
+            char c = s[pos++];
+            if(c != '\\') {
+                out += c;
+                continue;
+            }
+            if(pos >= s.size())
+                return false;
+            c = s[pos++];
+            switch(c) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u':
+                    if(pos + 4 > s.size())
+                        return false;
+                    appendUtf8(out, (unsigned)strtoul(s.substr(pos, 4).c_str(), nullptr, 16));
+                    pos += 4;
+                    break;
+                default: out += c; break;
+            }
+        }
+        if(pos >= s.size())
+            return false;
+        pos++;
+        return true;
+    }
+    static inline bool parseValue(const std::string &s, size_t &pos, JsonValue &value, int depth) {
+        if(depth > 64)
+            return false;
+        skipSpace(s, pos);
+        if(pos >= s.size())
+            return false;
+        char c = s[pos];
+        if(c == '{') {
+            value.type = Object;
+            pos++;
+            skipSpace(s, pos);
+            if(pos < s.size() && s[pos] == '}') {
+                pos++;
+                return true;
+            }
+            while(true) {
+                std::pair<std::string, JsonValue> member;
+                skipSpace(s, pos);
+                if(!parseString(s, pos, member.first))
+                    return false;
+                skipSpace(s, pos);
+                if(pos >= s.size() || s[pos] != ':')
+                    return false;
+                pos++;
+                if(!parseValue(s, pos, member.second, depth + 1))
+                    return false;
+                value.members.push_back(std::move(member));
+                skipSpace(s, pos);
+                if(pos < s.size() && s[pos] == ',') {
+                    pos++;
+                    continue;
+                }
+                if(pos < s.size() && s[pos] == '}') {
+                    pos++;
+                    return true;
+                }
+                return false;
+            }
+        }
+        if(c == '[') {
+            value.type = Array;
+            pos++;
+            skipSpace(s, pos);
+            if(pos < s.size() && s[pos] == ']') {
+                pos++;
+                return true;
+            }
+            while(true) {
+                JsonValue item;
+                if(!parseValue(s, pos, item, depth + 1))
+                    return false;
+                value.items.push_back(std::move(item));
+                skipSpace(s, pos);
+                if(pos < s.size() && s[pos] == ',') {
+                    pos++;
+                    continue;
+                }
+                if(pos < s.size() && s[pos] == ']') {
+                    pos++;
+                    return true;
+                }
+                return false;
+            }
+        }
+        if(c == '"') {
+            value.type = String;
+            return parseString(s, pos, value.text);
+        }
+        if(s.compare(pos, 4, "true") == 0 || s.compare(pos, 5, "false") == 0) {
+            value.type = Bool;
+            value.boolean = (c == 't');
+            pos += value.boolean ? 4 : 5;
+            return true;
+        }
+        if(s.compare(pos, 4, "null") == 0) {
+            value.type = Null;
+            pos += 4;
+            return true;
+        }
+        const char *begin = s.c_str() + pos;
+        char *end;
+        value.number = strtod(begin, &end);
+        if(end == begin)
+            return false;
+        value.type = Number;
+        pos += end - begin;
+        return true;
+    }
+};
+
+// Quote and escape a string for a JSON document.
+inline std::string jsonString(const std::string &s)
+{
+    std::string out = "\"";
+    for(unsigned char c : s) {
+        if(c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        }
+        else if(c == '\n') {
+            out += "\\n";
+        }
+        else if(c == '\t') {
+            out += "\\t";
+        }
+        else if(c < 0x20) {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        }
+        else {
+            out += (char)c;
+        }
+    }
+    return out + "\"";
+}
+
+#endif  // MINI_JSON_H
@@ -0,0 +1,135 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MeshTrace.h"
+
+/**
+ * Work-stealing thread pool. Tasks submitted from outside the pool wait in one shared
+ * queue and start in the order they were submitted. Tasks submitted by a worker stay on
+ * its own deque: it pops them from the back and, when it runs dry, takes the next shared
+ * task or steals from the front of the others.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(int nThreads = 0) {
+        if(nThreads <= 0)
+            nThreads = std::max(1u, std::thread::hardware_concurrency());
+        for(int i = 0; i < nThreads; i++)
+            queues.emplace_back(new WorkQueue());
+        for(int i = 0; i < nThreads; i++)
+            threads.emplace_back([this, i] { this->run(i); });
+    }
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(idleLock);
+            stop = true;
+        }
+        idle.notify_all();
+        for(auto &t : threads)
+            t.join();
+    }
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    inline int size() const {
+        return (int)threads.size();
+    }
+    // Index of the calling worker, -1 outside the pool.
+    static inline int &workerIndex() {
+        static thread_local int index = -1;
+        return index;
+    }
+
+    inline void submit(std::function<void()> task) {
+        int self = workerIndex();
+        WorkQueue &target = self >= 0 ? *queues[self] : inbox;
+        {
+            std::lock_guard<std::mutex> guard(target.lock);
+            target.tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> guard(idleLock);
+            pending++;
+            queued++;
+        }
+        idle.notify_one();
+    }
+    // Block until every submitted task has run.
+    inline void wait() {
+        std::unique_lock<std::mutex> guard(idleLock);
+        done.wait(guard, [this] { return pending == 0; });
+    }
+
+private:
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    WorkQueue inbox;        // submitted from outside the pool, first in first out
+    std::vector<std::thread> threads;
+    std::mutex idleLock;
+    std::condition_variable idle;
+    std::condition_variable done;
+    long pending = 0;       // submitted and not finished, guarded by idleLock
+    long queued = 0;        // sitting in a deque, guarded by idleLock
+    bool stop = false;
+
+    inline bool popTask(int self, std::function<void()> &task) {
+        {
+            WorkQueue &q = *queues[self];
+            std::lock_guard<std::mutex> guard(q.lock);
+            if(!q.tasks.empty()) {
+                task = std::move(q.tasks.back());
+                q.tasks.pop_back();
+                return true;
+            }
+        }
+        const int n = (int)queues.size();
+        for(int k = 0; k < n; k++) {
+            WorkQueue &q = k == 0 ? inbox : *queues[(self + k) % n];
+            std::lock_guard<std::mutex> guard(q.lock);
+            if(q.tasks.empty())
+                continue;
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+    inline void run(int self) {
+        workerIndex() = self;
+        while(true) {
+            std::function<void()> task;
+            if(popTask(self, task)) {
+                {
+                    std::lock_guard<std::mutex> guard(idleLock);
+                    queued--;
+                }
+                {
+                    MESH_TRACE("task");
+                    task();
+                }
+                std::lock_guard<std::mutex> guard(idleLock);
+                if(--pending == 0)
+                    done.notify_all();
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(idleLock);
+            idle.wait(guard, [this] { return stop || queued > 0; });
+            if(stop && queued == 0)
+                return;
+        }
+    }
+};
+
+#endif  // THREAD_POOL_H
@@ -1,5 +1,15 @@
 #include "meshIO.h"
+#include "MeshTransform.h"
+#include "MeshStats.h"
+#include "MeshTrace.h"
+#include "MeshLayout.h"
+#include "MeshCells.h"
+#include "MeshAttributes.h"
+#include "MeshNormals.h"
 #include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <time.h>
@@ -21,6 +31,63 @@ std::vector<std::string> seperate_string(std::string origin) {
     return result;
 }
 
+/**
+ * These readers fill MatrixXi, so the point indices must fit in int. Counts are read as
+ * long, larger meshes go through the 64-bit readMesh overloads of MeshConvert.h.
+ */
+static bool fitsIndex(long nPoints, const std::string &filename) {
+    if(nPoints <= INT_MAX)
+        return true;
+    std::cout << "More points than int indices address, read into MatrixXl." << (filename.empty() ? "" : " - " + filename) << std::endl;
+    return false;
+}
+
+/**
+ * Cells of different sizes do not fit the columns of T: split them into triangles, with
+ * the markers and attributes of their cells.
+ */
+static void splitMixedCells(MESHIO::CellMesh &cells, Eigen::MatrixXi &T, Eigen::MatrixXi &M, MESHIO::MeshAttributes *attributes, const std::string &filename) {
+    if(cells.nCells() == 0)
+        return;
+    const bool marked = (M.rows() == cells.nCells());
+    // A volume mesh keeps its tetrahedra; the surface cells around them are usually its boundary.
+    std::vector<long> tetCells;
+    for(long i = 0; i < cells.nCells(); i++)
+        if(cells.types[i] == MESHIO::CellTetra)
+            tetCells.push_back(i);
+    if(!tetCells.empty()) {
+        std::cout << "Cells of different types, kept the " << tetCells.size() << " tetrahedra. - " << filename << std::endl;
+        T.resize(tetCells.size(), 4);
+        Eigen::MatrixXi TM(marked ? tetCells.size() : 0, 1);
+        for(size_t t = 0; t < tetCells.size(); t++) {
+            const int *c = cells.cell(tetCells[t]);
+            for(int j = 0; j < 4; j++)
+                T(t, j) = c[j];
+            if(marked)
+                TM(t, 0) = M(tetCells[t], 0);
+        }
+        if(marked)
+            M.swap(TM);
+        if(attributes)
+            MESHIO::gatherCells(*attributes, tetCells);
+        cells = MESHIO::CellMesh();
+        return;
+    }
+    std::cout << "Cells other than triangles and tetrahedra, split into triangles. - " << filename << std::endl;
+    if(marked)
+        cells.M.swap(M);
+    Eigen::MatrixXi TM;
+    std::vector<long> cellOfTriangle;
+    MESHIO::triangulate(cells, T, TM, &cellOfTriangle);
+    if(marked)
+        M.swap(TM);
+    if(attributes)
+        MESHIO::gatherCells(*attributes, cellOfTriangle);
+    cells = MESHIO::CellMesh();
+}
+
+static int readVTKData(std::istream &vtk_file, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, MESHIO::MeshAttributes *attributes, std::string mark_pattern, std::string filename);
+
 // The eps file format is 
 /* eps 0.005          
  * id 1 5 7 9 100
@@ -29,6 +96,7 @@ std::vector<std::string> seperate_string(std::string origin) {
  * ...
  */
 int MESHIO::readEPS(std::string filename, int& cou, std::map<int, double>& mpd, std::map<int, vector<int>>& mpi) {
+	MESH_TRACE("readEPS", filename);
 	std::ifstream eps_file;
 	eps_file.open(filename);
 	if(!eps_file.is_open()){
@@ -65,15 +133,47 @@ int MESHIO::readEPS(std::string filename, int& cou, std::map<int, double>& mpd,
 }
 
 int MESHIO::readVTK(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, std::string mark_pattern) {
-    M.resize(1, 1);
-    int nPoints = 0;
-    int nFacets = 0;
     std::ifstream vtk_file;
     vtk_file.open(filename);
     if(!vtk_file.is_open()) {
         std::cout << "No such file. - " << filename << std::endl;
         return -1;
     }
+    return MESHIO::readVTK(vtk_file, V, T, M, mark_pattern, filename);
+}
+
+int MESHIO::readVTK(std::istream &in, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, std::string mark_pattern, std::string filename) {
+    return readVTKData(in, V, T, M, nullptr, mark_pattern, filename);
+}
+
+int MESHIO::readVTK(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, MeshAttributes &attributes, std::string mark_pattern) {
+    std::ifstream vtk_file;
+    vtk_file.open(filename);
+    if(!vtk_file.is_open()) {
+        std::cout << "No such file. - " << filename << std::endl;
+        return -1;
+    }
+    return MESHIO::readVTK(vtk_file, V, T, M, attributes, mark_pattern, filename);
+}
+
+int MESHIO::readVTK(std::istream &in, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, MeshAttributes &attributes, std::string mark_pattern, std::string filename) {
+    attributes.clear();
+    return readVTKData(in, V, T, M, &attributes, mark_pattern, filename);
+}
+
+/**
+ * The VTK reader. The CELL_DATA scalars named mark_pattern go to M; every other array of
+ * CELL_DATA and POINT_DATA goes to attributes, or is skipped when it is null.
+ */
+static int readVTKData(std::istream &vtk_file, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, MESHIO::MeshAttributes *attributes, std::string mark_pattern, std::string filename) {
+    MESH_TRACE("readVTK");
+    M.resize(1, 1);
+    long nPoints = 0;
+    long nFacets = 0;
+    MESHIO::CellMesh cells;  // only while the cells are mixed
+    std::vector<uint8_t> uniformTypes;  // CELL_TYPES of cells of one size, read into T
+    bool onPoints = false;
+    long dataRows = -1;      // rows of the arrays of the current CELL_DATA or POINT_DATA
     std::string vtk_type_str = "POLYDATA ";
     char buffer[BUFFER_LENGTH];
     while(!vtk_file.eof()) {
@@ -93,9 +193,11 @@ int MESHIO::readVTK(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T
         }
         if(line.find("POINTS ") != std::string::npos) {
             std::vector<std::string> words = seperate_string(line);
-            nPoints = stoi(words[1]);
+            nPoints = stol(words[1]);
+            if(!fitsIndex(nPoints, filename))
+                return -1;
             V.resize(nPoints, 3);
-            for(int i = 0; i < nPoints; i++) {
+            for(long i = 0; i < nPoints; i++) {
                 vtk_file.getline(buffer, BUFFER_LENGTH);
                 words = seperate_string(std::string(buffer));
                 V.row(i) << stod(words[0]), stod(words[1]), stod(words[2]);
@@ -103,39 +205,91 @@ int MESHIO::readVTK(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T
         }
         if(line.find(vtk_type_str) != std::string::npos) {
             std::vector<std::string> words = seperate_string(line);
-            nFacets = stoi(words[1]);
-            T.resize(nFacets, stoi(words[2]) / nFacets - 1);
-            for(int i = 0; i < nFacets; i++) {
+            nFacets = stol(words[1]);
+            // Cells of different sizes go to offsets and connectivity from the first that differs.
+            const long size = stol(words[2]);
+            int nCorner = nFacets > 0 && size % nFacets == 0 ? (int)(size / nFacets - 1) : 0;
+            T.resize(nFacets, std::max(nCorner, 0));
+            for(long i = 0; i < nFacets; i++) {
                 vtk_file.getline(buffer, BUFFER_LENGTH);
                 words = seperate_string(std::string(buffer));
-                for(int j = 0; j < stoi(words[0]); j++) 
-                    T(i, j) = stoi(words[j + 1]);
+                const int n = stoi(words[0]);
+                if(nCorner > 0 && n != nCorner) {
+                    for(long r = 0; r < i; r++) {
+                        for(int j = 0; j < nCorner; j++)
+                            cells.connectivity.push_back(T(r, j));
+                        cells.offsets.push_back((long)cells.connectivity.size());
+                        cells.types.push_back(MESHIO::polygonType(nCorner));
+                    }
+                    nCorner = 0;
+                    T.resize(0, 3);
+                }
+                if(nCorner > 0) {
+                    for(int j = 0; j < n; j++) 
+                        T(i, j) = stoi(words[j + 1]);
+                    continue;
+                }
+                for(int j = 0; j < n; j++) 
+                    cells.connectivity.push_back(stoi(words[j + 1]));
+                cells.offsets.push_back((long)cells.connectivity.size());
+                cells.types.push_back(MESHIO::polygonType(n));
+            }
+        }
+        if(line.find("CELL_TYPES ") != std::string::npos) {
+            std::vector<uint8_t> &types = cells.nCells() > 0 ? cells.types : uniformTypes;
+            types.resize(cells.nCells() > 0 ? cells.nCells() : T.rows());
+            for(size_t i = 0; i < types.size(); i++) {
+                vtk_file.getline(buffer, BUFFER_LENGTH);
+                types[i] = (uint8_t)stoi(std::string(buffer));
             }
         }
-        if(line.find("CELL_DATA ") != std::string::npos) {
+        if(line.find("CELL_DATA ") != std::string::npos || line.find("POINT_DATA ") != std::string::npos) {
             std::vector<std::string> words = seperate_string(line);
-            if(stoi(words[1]) != nFacets) {
-                std::cout << "The number of CELL_DATA is not equal to number of cells. -" << filename;
-                std::cout << "Ignore CELL_DATA" << std::endl;
-                return 0;
+            onPoints = (words[0] == "POINT_DATA");
+            dataRows = stol(words[1]);
+            if(dataRows != (onPoints ? nPoints : nFacets)) {
+                std::cout << "The number of " << words[0] << " is not equal to number of " << (onPoints ? "points" : "cells") << ". -" << filename;
+                std::cout << "Ignore " << words[0] << std::endl;
+                dataRows = -1;
             }
-            vtk_file.getline(buffer, BUFFER_LENGTH);
-            std::string data_type = seperate_string(std::string(buffer))[1];
-            if(data_type != mark_pattern) 
-                continue;
+            continue;
+        }
+        if(dataRows < 0 || !isalpha((unsigned char)buffer[0]))
+            continue;
+        std::vector<std::string> words = seperate_string(line);
+        if(!onPoints && words[0] == "SCALARS" && words.size() > 1 && words[1] == mark_pattern) {
             M.resize(nFacets, 1);
-			for (int i = 0; i < nFacets; i++)
+			for (long i = 0; i < nFacets; i++)
 				M(i, 0) = 0;
             vtk_file.getline(buffer, BUFFER_LENGTH);
-            for(int i = 0; i < nFacets; i++) {
+            for(long i = 0; i < nFacets; i++) {
                 vtk_file.getline(buffer, BUFFER_LENGTH);
 				int surface_id=stoi(std::string(buffer));
 				M.row(i) << surface_id;
 					
             }
         }
+        else if(attributes && MESHIO::readVTKArray(vtk_file, line, onPoints, dataRows, *attributes) < 0) {
+            std::cout << "The format of VTK file is illegal, truncated " << words[0] << ". - " << filename << std::endl;
+            return -1;
+        }
+    }
+    // Cells of one size are not necessarily of one type: four corners are a tetrahedron or
+    // a quad. Only triangles and tetrahedra stay in T, other surface cells go to triangles.
+    if(cells.nCells() == 0 && T.cols() > 3) {
+        if(vtk_type_str == "POLYGONS ")
+            uniformTypes.assign(T.rows(), MESHIO::polygonType((int)T.cols()));
+        bool other = false;
+        for(uint8_t type : uniformTypes)
+            other = other || (T.cols() == 4 ? type != MESHIO::CellTetra : MESHIO::isSurfaceCell(type));
+        if(other && uniformTypes.size() == (size_t)T.rows()) {
+            Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> rows = T;
+            for(long i = 0; i < T.rows(); i++)
+                cells.addCell(uniformTypes[i], rows.data() + i * T.cols(), (int)T.cols());
+            T.resize(0, 3);
+        }
     }
-    vtk_file.close();
+    splitMixedCells(cells, T, M, attributes, filename);
     return 1;
 }
 
@@ -146,44 +300,40 @@ int MESHIO::readOBJ(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T
         std::cout << "No such file. - " << filename << std::endl;
         return -1;
     }
-    char buffer[BUFFER_LENGTH];
+    return MESHIO::readOBJ(objFile, V, T, M);
+}
+
+int MESHIO::readOBJ(std::istream &objFile, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M) {
+    MESH_TRACE("readOBJ");
+    string line;
     vector<vector<double>> plist;
     vector<vector<int>> flist;
     vector<int> mlist;
     int curMark = 0;
-    while(!objFile.eof()) {
-        objFile.getline(buffer, BUFFER_LENGTH);
-        if(buffer[0] == 'v') {
-            vector<string> words = seperate_string(string(buffer));
+    while(getline(objFile, line)) {
+        const char *buffer = line.c_str();
+        // Only "v " and "f " lines, not vn/vt.
+        if(buffer[0] == 'v' && (buffer[1] == ' ' || buffer[1] == '\t')) {
+            vector<string> words = seperate_string(line);
             if(words.size() < 4) {
                 continue;
             }
             vector<double> coord;
             for(int ii = 1; ii < 4; ii++) {
-                int wordLen = 0;
-                while(wordLen < words[ii].length()) {
-                    if(words[ii][wordLen] == '/') {
-                        break;
-                    }
-                }
-                coord.push_back(stod(words[ii].substr(0, wordLen)));
+                coord.push_back(stod(words[ii]));
             }
             plist.push_back(coord);
         }
-        if(buffer[0] == 'f') {
-            vector<string> words = seperate_string(string(buffer));
+        if(buffer[0] == 'f' && (buffer[1] == ' ' || buffer[1] == '\t')) {
+            vector<string> words = seperate_string(line);
             if(words.size() < 4) {
                 continue;
             }
             vector<int> facet;
             for(int ii = 1; ii < 4; ii++) {
-                int wordLen = 0;
-                while(wordLen < words[ii].length()) {
-                    if(words[ii][wordLen] == '/') {
-                        break;
-                    }
-                }
-                facet.push_back(stoi(words[ii].substr(0, wordLen)));
+                // Corners look like v, v/vt, v//vn or v/vt/vn.
+                size_t wordLen = words[ii].find('/');
+                facet.push_back(stoi(words[ii].substr(0, wordLen)) - 1);
             }
             flist.push_back(facet);
             mlist.push_back(curMark);
@@ -193,20 +343,22 @@ int MESHIO::readOBJ(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T
         }
     }
 
+    if(!fitsIndex(plist.size(), ""))
+        return -1;
     V.resize(plist.size(), 3);
-    for(int i = 0; i < plist.size(); i++) {
+    for(size_t i = 0; i < plist.size(); i++) {
         for(int j = 0; j < 3; j++) {
             V(i, j) = plist[i][j];
         }
     }
     T.resize(flist.size(), 3);
-    for(int i = 0; i < flist.size(); i++) {
+    for(size_t i = 0; i < flist.size(); i++) {
         for(int j = 0; j < 3; j++) {
             T(i, j) = flist[i][j];
         }
     }
     M.resize(mlist.size(), 1);
-    for(int i = 0; i < mlist.size(); i++) {
+    for(size_t i = 0; i < mlist.size(); i++) {
         M(i, 0) = mlist[i];
     }
 
@@ -220,49 +372,32 @@ int MESHIO::writeVTK(std::string filename, const Eigen::MatrixXd &V, const Eigen
         return -1;
     }
     std::cout << "Writing mesh to - " << filename << std::endl;
-    f.precision(std::numeric_limits<double>::digits10 + 1);
-    f << "# vtk DataFile Version 2.0" << std::endl;
-    f << "TetWild Mesh" << std::endl;
-    f << "ASCII" << std::endl;
-    f << "DATASET UNSTRUCTURED_GRID" << std::endl;
-    f << "POINTS " << V.rows() << " double" << std::endl;
-    for(int i = 0; i < V.rows(); i++)
-        f << V(i, 0) << " " << V(i, 1) << " " << V(i, 2) << std::endl;
-    f << "CELLS " << T.rows() << " " << T.rows() * (T.cols() + 1) << std::endl;
-    for(int i = 0; i < T.rows(); i++) {
-        f << T.cols() << " ";
-        for(int j = 0; j < T.cols(); j++)
-            f <<  T(i, j) << " ";
-        f << std::endl;
-    }
-    f << "CELL_TYPES " << T.rows() << std::endl;
-    int cellType = 0;
-    if(T.cols() == 2)
-        cellType = 3;
-    else if(T.cols() == 3)
-        cellType = 5;
-    else if(T.cols() == 4)
-        cellType = 10;
-    for(int i = 0; i < T.rows(); i++)
-        f << cellType << std::endl;
-    if(M.rows() != T.rows()) {
-        f.close();
-        return 1;
-    }
-    f << "CELL_DATA " << M.rows() << std::endl;
-    f << "SCALARS " << mark_pattern << " int " << M.cols() << std::endl;
-    f << "LOOKUP_TABLE default" << std::endl;
-    for(int i = 0; i < M.rows(); i++) {
-        for(int j = 0; j < M.cols(); j++)
-            f << M(i, j);
-        f << std::endl;
+    return MESHIO::writeVTK(f, V, T, M, mark_pattern);
+}
+
+int MESHIO::writeVTK(std::ostream &f, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi M, std::string mark_pattern) {
+    return Kernels::writeVTK(f, V, T, M, mark_pattern);
+}
+
+int MESHIO::writeVTK(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi M, const MeshAttributes &attributes, std::string mark_pattern) {
+    std::ofstream f(filename);
+    if(!f.is_open()) {
+        std::cout << "Write VTK file failed. - " << filename << std::endl;
+        return -1;
     }
-    f << std::endl;
-    f.close();
-    return 1;
+    std::cout << "Writing mesh to - " << filename << std::endl;
+    return MESHIO::writeVTK(f, V, T, M, attributes, mark_pattern);
+}
+
+// The markers, then the attributes that still have one row per cell or per point.
+int MESHIO::writeVTK(std::ostream &f, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi M, const MeshAttributes &attributes, std::string mark_pattern) {
+    if(Kernels::writeVTK(f, V, T, M, mark_pattern) < 0)
+        return -1;
+    return MESHIO::writeVTKArrays(f, attributes, V.rows(), T.rows(), M.rows() == T.rows());
 }
 
 int MESHIO::writeEpsVTK(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, int& cou,  std::map<int, double> &mpd, std::map<int, vector<int>> &mpi, std::string mark_pattern) {
+	MESH_TRACE("writeEpsVTK", filename);
 	std::ofstream f(filename);
 	if(!f.is_open()) {
 		std::cout << "Write VTK file failed. - " << filename << std::endl;
@@ -320,9 +455,15 @@ int MESHIO::readMESH(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &
         std::cout << "No such file. - " << filename << std::endl;
         return -1;
     }
+    return MESHIO::readMESH(mesh_file, V, T, M);
+}
+
+int MESHIO::readMESH(std::istream &mesh_file, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M) {
+    MESH_TRACE("readMESH");
     int dimension = 3;
-    int nPoints;
-    int nFacets;
+    long nPoints;
+    long nFacets;
+    Eigen::MatrixXi tets, tetMarks;
     char buffer[BUFFER_LENGTH];
     while(!mesh_file.eof()) {
         mesh_file.getline(buffer, BUFFER_LENGTH);
@@ -346,10 +487,12 @@ int MESHIO::readMESH(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &
                 line = (std::string)buffer;
             }
             words = seperate_string(line);
-            nPoints = std::stoi(words[0]);
+            nPoints = std::stol(words[0]);
             std::cout << "Number of points : " << nPoints << std::endl;
+            if(!fitsIndex(nPoints, ""))
+                return -1;
             V.resize(nPoints, dimension);
-            int i = 0;
+            long i = 0;
             while(i < nPoints) {
                 mesh_file.getline(buffer, BUFFER_LENGTH);
                 words = seperate_string(std::string(buffer));
@@ -366,11 +509,11 @@ int MESHIO::readMESH(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &
                 line = (std::string)buffer;
             }
             words = seperate_string(line);
-            nFacets = stoi(words[0]);
+            nFacets = stol(words[0]);
             std::cout << "Number of facets : " << nFacets << std::endl;
             T.resize(nFacets, 3);
             M.resize(nFacets, 1);
-            int i = 0;
+            long i = 0;
             while(i < nFacets) {
                 mesh_file.getline(buffer, BUFFER_LENGTH);
                 words = seperate_string(std::string(buffer));
@@ -384,8 +527,44 @@ int MESHIO::readMESH(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &
                 i++;
             }
         }
+        if(line.find("Tetrahedra") != std::string::npos) {
+            line.clear();
+            while(line.empty()) {
+                mesh_file.getline(buffer, BUFFER_LENGTH);
+                line = (std::string)buffer;
+            }
+            long nTets = atol(line.c_str());
+            std::cout << "Number of tetrahedra : " << nTets << std::endl;
+            tets.resize(nTets, 4);
+            tetMarks.resize(nTets, 1);
+            long i = 0;
+            while(i < nTets && mesh_file.getline(buffer, BUFFER_LENGTH)) {
+                char *p = buffer, *end;
+                long values[5];
+                int n = 0;
+                for(; n < 5; n++, p = end) {
+                    values[n] = strtol(p, &end, 10);
+                    if(end == p)
+                        break;
+                }
+                if(n == 0)
+                    continue;
+                if(n < 5)
+                    std::cout << "Warning : The number of tetrahedra element is not equal 5.\n";
+                for(int j = 0; j < 4; j++)
+                    tets(i, j) = j < n ? (int)values[j] - 1 : 0;
+                tetMarks(i, 0) = n == 5 ? (int)values[4] - 1 : 0;
+                i++;
+            }
+        }
+    }
+    // A volume mesh: the tetrahedra are the cells, its Triangles (usually the boundary) are left out.
+    if(tets.rows() > 0) {
+        if(T.rows() > 0)
+            std::cout << "Read the tetrahedra, the " << T.rows() << " triangles of the file are left out." << std::endl;
+        T.swap(tets);
+        M.swap(tetMarks);
     }
-    mesh_file.close();
     return 1;
 }
 
@@ -396,32 +575,11 @@ int MESHIO::writeMESH(std::string filename, const Eigen::MatrixXd &V, const Eige
         return -1;
     }
     std::cout << "Writing mesh to - " << filename << std::endl;
-    f.precision(std::numeric_limits<double>::digits10 + 1);
-    f << "MeshVersionFormatted 1" << std::endl;
-    f << "Dimension " << V.cols() << std::endl;
-    f << "Vertices" << std::endl;
-    f << V.rows() << std::endl;
-    for(int i = 0; i < V.rows(); i++) {
-        for(int j = 0; j < V.cols(); j++)
-            f << V(i, j) << " ";
-        f << i + 1 << std::endl;
-    }
-    if(T.cols() == 3)
-        f << "Triangles" << std::endl;
-    else if(T.cols() == 4)
-        f << "Tetrahedra" << std::endl;
-    else {
-        std::cout << "Unsupported format for .mesh file." << std::endl;
-        return -1;
-    }
-    f << T.rows() << std::endl;
-    for(int i = 0; i < T.rows(); i++) {
-        for(int j = 0; j < T.cols(); j++)
-            f << T(i, j) + 1 << " ";
-        f << i + 1 << std::endl;
-    }
-    f.close();
-    return 1;
+    return MESHIO::writeMESH(f, V, T);
+}
+
+int MESHIO::writeMESH(std::ostream &f, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T) {
+    return Kernels::writeMESH(f, V, T);
 }
 
 int MESHIO::writePLY(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T) {
@@ -433,24 +591,29 @@ int MESHIO::writePLY(std::string filename, const Eigen::MatrixXd &V, const Eigen
     std::ofstream plyfile;
 
     plyfile.open(filename);
-	plyfile.precision(std::numeric_limits<double>::digits10 + 1);
-    plyfile << "ply" << std::endl;
-    plyfile << "format ascii 1.0" << std::endl;
-    plyfile << "comment VTK generated PLY File" << std::endl;
-    plyfile << "obj_info vtkPolyData points and polygons: vtk4.0" << std::endl;
-    plyfile << "element vertex " << V.rows() << std::endl;
-    plyfile << "property float x" << std::endl;
-    plyfile << "property float y" << std::endl;
-    plyfile << "property float z" << std::endl;
-    plyfile << "element face " << T.rows() << std::endl;
-    plyfile << "property list uchar int vertex_indices" << std::endl;
-    plyfile << "end_header" << std::endl;
-    for(int i = 0; i < V.rows(); i++)
-        plyfile << V(i, 0) << " " << V(i, 1) << " " << V(i, 2) << std::endl;
-    for(int i = 0; i < T.rows(); i++)
-        plyfile << T.cols() << " " << T(i, 0) << " " << T(i, 1) << " " << T(i, 2) << std::endl;
-    plyfile.close();
-    return 1;
+    return MESHIO::writePLY(plyfile, V, T);
+}
+
+int MESHIO::writePLY(std::ostream &plyfile, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T) {
+    return Kernels::writePLY(plyfile, V, T);
+}
+
+int MESHIO::writePLY(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const MeshAttributes &attributes) {
+    if(T.cols() != 3) {
+        std::cout << "Unsupported format for .ply file." << std::endl;
+        return -1;
+    }
+    std::cout << "Writing mesh to - " << filename << std::endl;
+    std::ofstream plyfile(filename);
+    return MESHIO::writePLY(plyfile, V, T, attributes);
+}
+
+int MESHIO::writePLY(std::ostream &plyfile, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const MeshAttributes &attributes) {
+    const MeshAttribute *normals = findPointNormals(attributes, V.rows());
+    if(!normals)
+        return Kernels::writePLY(plyfile, V, T);
+    Eigen::MatrixXd N = normals->toMatrix();
+    return Kernels::writePLY(plyfile, V, T, &N);
 }
 
 int MESHIO::writePLS(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M)
@@ -463,15 +626,14 @@ int MESHIO::writePLS(std::string filename, const Eigen::MatrixXd &V, const Eigen
     std::cout << "Writing mesh to - " << filename << std::endl;
     std::ofstream plsfile;
     plsfile.open(filename);
-    plsfile << T.rows() << " " << V.rows() << " " << "0 0 0 0\n";
-    for(int i = 0; i < V.rows(); i++)
-        plsfile << i + 1 << " " << V(i, 0) << " " << V(i, 1) << " " << V(i, 2) << std::endl;
-    for(int i = 0; i < T.rows(); i++)
-        plsfile << i + 1 << " " << T(i, 0) + 1 << " " << T(i, 1) + 1 << " " << T(i, 2) + 1 << " " << M(i, 0) + 1 << std::endl;
-        
-    plsfile.close();
+    int result = MESHIO::writePLS(plsfile, V, T, M);
     std::cout << "Finish\n";
-    return 1;
+    return result;
+}
+
+int MESHIO::writePLS(std::ostream &plsfile, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M)
+{
+    return Kernels::writePLS(plsfile, V, T, M);
 }
 
 int MESHIO::readPLS(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T,Eigen::MatrixXi &M) {
@@ -481,17 +643,24 @@ int MESHIO::readPLS(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T
 		std::cout << "No such file. - " << filename << std::endl;
 		return -1;
 	}
-	int nPoints = 0;
-	int nFacets = 0;
+	return MESHIO::readPLS(plsfile, V, T, M);
+}
+
+int MESHIO::readPLS(std::istream &plsfile, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M) {
+	MESH_TRACE("readPLS");
+	long nPoints = 0;
+	long nFacets = 0;
 
 	auto& pls_file = plsfile;
 	std::string str;
 	std::getline(pls_file, str);
 	std::stringstream ss(str);
 	ss >> nFacets >> nPoints;
+	if(!fitsIndex(nPoints, ""))
+		return -1;
 	V.resize(nPoints,3);
-	for (int i = 0; i < nPoints; i++) {
-		int index;
+	for (long i = 0; i < nPoints; i++) {
+		long index;
 		double point_coordinate[3];
 		pls_file >> index >> point_coordinate[0] >> point_coordinate[1] >> point_coordinate[2];
 		for(int k=0;k<3;k++)
@@ -499,8 +668,8 @@ int MESHIO::readPLS(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T
 	}
 	M.resize(nFacets,1);
 	T.resize(nFacets, 3);
-	for (int i = 0; i < nFacets; i++) {
-		int index;
+	for (long i = 0; i < nFacets; i++) {
+		long index;
 		int tri[3];
 		pls_file >> index >> tri[0] >> tri[1] >> tri[2] >> M(i,0);
 		tri[0]--; tri[1]--; tri[2]--;
@@ -516,96 +685,37 @@ int MESHIO::writeFacet(std::string filename, const Eigen::MatrixXd & V, const Ei
 	std::cout << "Writing mesh to - " << filename << std::endl;
 	std::ofstream facetfile;
 	facetfile.open(filename);
-	facetfile.precision(std::numeric_limits<double>::digits10 + 1);
-	facetfile << "FACET FILE V3.0  exported from Meshconverter http://10.12.220.71/tools/meshconverter " << std::endl;
-	facetfile << 1 << std::endl;
-	facetfile << "Grid" << std::endl;
-	facetfile << "0, 0.00 0.00 0.00 0.00" << endl;
-	facetfile << V.rows() << endl;
-	for (int i = 0; i < V.rows(); i++)
-		facetfile << V(i, 0) << " " << V(i, 1) << " " << V(i, 2) << std::endl;
-	facetfile << 1 << endl;
-	facetfile << "Triangles" << endl;
-	facetfile << T.rows() << " 3" << endl;
-	
-	for (int i = 0; i < T.rows(); i++) {
-		facetfile << " " << T(i, 0) + 1 << " " << T(i, 1) + 1 << " " << T(i, 2) + 1 << " 0 ";
-		if (M.rows() >= T.rows())
-			facetfile << M(i, 0);
-		else
-			facetfile << 0;
-		facetfile<< " " << i + 1 << std::endl;
-	}
-	return 0;
+	return MESHIO::writeFacet(facetfile, V, T, M);
 }
 
-int MESHIO::writeOBJ(string filename, const Eigen::MatrixXd& V, const Eigen::MatrixXi& F, const Eigen::MatrixXi &M) {
-    // Facet group
-    bool doGroup = (M.rows() == F.rows());
-    vector<vector<int>> flist;
-    for(int i = 0; i < F.rows(); i++) {
-        vector<int> facet;
-        facet.push_back(doGroup ? M(i, 0) : 0);
-        for(int j = 0; j < F.cols(); j++) {
-            facet.push_back(F(i, j));
-        }
-        flist.push_back(facet);
-    }
-    if(doGroup) {
-        sort(flist.begin(), flist.end(), [](vector<int> A, vector<int> B){ return A[0] < B[0]; });
-    }
+int MESHIO::writeFacet(std::ostream &facetfile, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M)
+{
+	return Kernels::writeFacet(facetfile, V, T, M);
+}
 
+int MESHIO::writeOBJ(string filename, const Eigen::MatrixXd& V, const Eigen::MatrixXi& F, const Eigen::MatrixXi &M) {
 	cout << "Writing mesh to - " << filename << endl;
 	ofstream objFile;
 	objFile.open(filename);
-	objFile.precision(std::numeric_limits<double>::digits10 + 1);
-
-    // Get current time.
-    std::string export_time;
-    char stime[BUFFER_LENGTH] = {0};
-    time_t now_time;
-    time(&now_time);
-    strftime(stime,sizeof(stime),"%H:%M:%S",localtime(&now_time));
-    export_time = stime + '\0';
-
-    // Header 
-    objFile << "# TIGER Mesh converter. (c) 2021." << endl;
-    objFile << "# Created File: " << export_time << endl;
-    objFile << "# " << endl;
-    objFile << "# object default" << endl;
-    objFile << "# " << endl;
-    objFile << endl;
-
-    // Write points
-    for(int i = 0; i < V.rows(); i++) {
-        objFile << "v";
-        for(int j = 0; j < V.cols(); j++) {
-            objFile << " " << V(i, j);
-        }
-        objFile << endl;
-    }
-    objFile << "# " << V.rows() << " vertices" << endl << endl;
-
-    // Write facets with groups
-    int curGroup = INT_MIN;
-    for(int i = 0; i < flist.size(); i++) {
-        if(flist[i][0] != curGroup) {
-            curGroup = flist[i][0];
-            objFile << "g " << curGroup << endl;
-        }
-        objFile << "f";
-        for(int j = 1; j < flist[i].size(); j++) {
-            objFile << " " << flist[i][j] + 1;
-        }
-        objFile << endl;
-    }
+	return MESHIO::writeOBJ(objFile, V, F, M);
+}
 
-    // Write facets 
-    objFile << "# " << F.rows() << " faces" << endl << endl;
+int MESHIO::writeOBJ(std::ostream &objFile, const Eigen::MatrixXd& V, const Eigen::MatrixXi& F, const Eigen::MatrixXi &M) {
+    return Kernels::writeOBJ(objFile, V, F, M);
+}
 
-    objFile.close();
+int MESHIO::writeOBJ(string filename, const Eigen::MatrixXd& V, const Eigen::MatrixXi& F, const Eigen::MatrixXi &M, const MeshAttributes &attributes) {
+    cout << "Writing mesh to - " << filename << endl;
+    ofstream objFile(filename);
+    return MESHIO::writeOBJ(objFile, V, F, M, attributes);
+}
 
-    return 1;
+int MESHIO::writeOBJ(std::ostream &objFile, const Eigen::MatrixXd& V, const Eigen::MatrixXi& F, const Eigen::MatrixXi &M, const MeshAttributes &attributes) {
+    const MeshAttribute *normals = findPointNormals(attributes, V.rows());
+    if(!normals)
+        return Kernels::writeOBJ(objFile, V, F, M);
+    Eigen::MatrixXd N = normals->toMatrix();
+    return Kernels::writeOBJ(objFile, V, F, M, &N);
 }
 
 /**
@@ -617,6 +727,7 @@ int MESHIO::writeOBJ(string filename, const Eigen::MatrixXd& V, const Eigen::Mat
  */
 bool MESHIO::rotatePoint(vector<double> rotateVec, Eigen::MatrixXd &V, Eigen::MatrixXi &T)
 {
+	MESH_TRACE("rotatePoint");
 	if(rotateVec.size() == 0) return 0;
 
 	double start_x = 0.0, start_y = 0.0, start_z = 0.0;
@@ -639,29 +750,11 @@ bool MESHIO::rotatePoint(vector<double> rotateVec, Eigen::MatrixXd &V, Eigen::Ma
 		}
 	}
 
-	if(rotateVec.size() == 7) {
-		std::cout << "Rotating\n";
-		for (int i = 0; i < V.rows(); i++) {
-			V(i, 0) -= start_x;
-			V(i, 1) -= start_y;
-			V(i, 2) -= start_z;
-		}
-	}
-	if(rotateVec.size() > 0) {
-		Eigen::AngleAxisd rotationVector(M_PI * angle, Eigen::Vector3d(end_x, end_y, end_z));
-		Eigen::Matrix3d rotationMatrix = Eigen::Matrix3d::Identity();
-		rotationMatrix = rotationVector.toRotationMatrix();
-		Eigen::MatrixXd tmp = rotationMatrix * V.transpose();
-		V = tmp.transpose();
-	}
-	if(rotateVec.size() == 7){
-		for(int i = 0; i < V.rows(); i++){
-			V(i, 0) += start_x;
-			V(i, 1) += start_y;
-			V(i, 2) += start_z;
-		}
-		std::cout << "Rotated\n";
-	}
+	// One fused pass: the shift to the axis origin and back is folded into the matrix.
+	std::cout << "Rotating\n";
+	Eigen::Matrix4d A = rotationTransform(Eigen::Vector3d(start_x, start_y, start_z), Eigen::Vector3d(end_x, end_y, end_z), angle);
+	applyTransform(A, V, T);
+	std::cout << "Rotated\n";
 	return 1;
 }
 
@@ -674,6 +767,7 @@ bool MESHIO::rotatePoint(vector<double> rotateVec, Eigen::MatrixXd &V, Eigen::Ma
  */
 bool MESHIO::addBox(vector<double> boxVec, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M)
 {
+	MESH_TRACE("addBox");
 	if(boxVec.size() == 0) return 0;
 
 	if(boxVec.size() != 3) {
@@ -686,30 +780,15 @@ bool MESHIO::addBox(vector<double> boxVec, Eigen::MatrixXd &V, Eigen::MatrixXi &
 
 	double len = boxVec[0], width = boxVec[1], hight = boxVec[2];
 
-	vector<double> tmpx, tmpy, tmpz;
-
-	for(int i = 0; i < V.rows(); i++)
-	{
-		tmpx.push_back(V(i, 0));
-		tmpy.push_back(V(i, 1));
-		tmpz.push_back(V(i, 2));
-	}
-
-	std::sort(tmpx.begin(), tmpx.end());
-	std::sort(tmpy.begin(), tmpy.end());
-	std::sort(tmpz.begin(), tmpz.end());
+	MeshStats stats;
+	computeStats(V, T, M, stats);
 
-	int tmpid = V.rows() / 2;
-
-	double midx = tmpx[tmpid];
-	double midy = tmpy[tmpid];
-	double midz = tmpz[tmpid];
+	double midx = stats.median.x();
+	double midy = stats.median.y();
+	double midz = stats.median.z();
 
 	std::cout << midx << " " << midy << " " << midz << '\n';
-	std::cout << tmpx[tmpx.size() - 1] - tmpx[0] << " " << tmpy[tmpy.size() - 1] - tmpy[0] << " " << \
-	tmpz[tmpz.size() - 1] - tmpz[0] << '\n';
-
-	tmpx.clear(); tmpy.clear(); tmpz.clear();
+	std::cout << stats.extent().x() << " " << stats.extent().y() << " " << stats.extent().z() << '\n';
 
 
 	Eigen::MatrixXd tmpV;
@@ -724,10 +803,14 @@ bool MESHIO::addBox(vector<double> boxVec, Eigen::MatrixXd &V, Eigen::MatrixXi &
 		for(int j = 0; j < T.cols(); j++)
 			tmpT(i, j) = T(i, j);
 
+	// The box facets get a new marker, if the mesh carries one marker per facet.
+	bool doMarker = (M.rows() == T.rows() && M.cols() > 0 && T.rows() > 0);
 	Eigen::MatrixXi tmpM;
-	tmpM.resize(M.rows() + 12, M.cols());
-	for(int i = 0; i < tmpM.cols(); i++)
-		tmpM(i, 0) = M(i, 0);
+	if(doMarker) {
+		tmpM.resize(M.rows() + 12, M.cols());
+		tmpM.topRows(M.rows()) = M;
+	}
+	int boxMark = doMarker ? M.col(0).maxCoeff() + 1 : 0;
 
 
 	int V_index = V.rows();
@@ -775,7 +858,8 @@ bool MESHIO::addBox(vector<double> boxVec, Eigen::MatrixXd &V, Eigen::MatrixXi &
 		tmpT(i, 0) = V_index + boxTri[j + 0];
 		tmpT(i, 1) = V_index + boxTri[j + 1];
 		tmpT(i, 2) = V_index + boxTri[j + 2];
-		tmpM(i, 0) = M(T.rows() - 1, 0) + 1;
+		if(doMarker)
+			tmpM(i, 0) = boxMark;
 	}
 
 
@@ -783,6 +867,8 @@ bool MESHIO::addBox(vector<double> boxVec, Eigen::MatrixXd &V, Eigen::MatrixXi &
 	T.resize(tmpT.rows(), tmpT.cols());
 	V = tmpV;
 	T = tmpT;
+	if(doMarker)
+		M = tmpM;
 
 	std::cout << "Boxed\n";
 
@@ -790,119 +876,10 @@ bool MESHIO::addBox(vector<double> boxVec, Eigen::MatrixXd &V, Eigen::MatrixXi &
 }
 
 bool MESHIO::reverseOrient(Eigen::MatrixXi &T) {
-	std::cout << "Reversing\n";
-	for(int i = 0; i < T.cols(); i++)
-	{
-		int t = T(i, 0);
-		T(i, 0) = T(i, 2);
-		T(i, 2) = t;
-	}
-	std::cout << "reversed\n";
-	return 1;
+	return Kernels::reverseOrient(T);
 }
 
 bool MESHIO::repair( Eigen::MatrixXd &V,  Eigen::MatrixXi &T, Eigen::MatrixXi M)
 {
-
-    std::cout << "Vertex number is  " << V.rows() << " X " << V.cols() << "  before clean. \n";
-    std::cout << "Cell number is  " << T.rows() << " X " << T.cols() << "  before clean. \n";
-    std::cout << "Attribute number is  " << M.rows() << " X " << M.cols() << "  before clean. \n";
-    // 检测面积为0的单元个数
-
-    Eigen::MatrixXd Tri;
-    Tri.resize(3, 3);
-    vector<int> emptyTri;
-    for(int i = 0; i < T.rows(); i++)
-    {
-        for(int j = 0; j < 3; j++)
-        {
-            Tri(j, 0) = V(T(i, j), 0);
-            Tri(j, 1) = V(T(i, j), 1);
-            Tri(j, 2) = V(T(i, j), 2);
-        }
-        Eigen::Vector3d lin1(Tri(1, 0) - Tri(0, 0), Tri(1, 1) - Tri(0, 1), Tri(1, 2) - Tri(0, 2));
-        Eigen::Vector3d lin2(Tri(2, 0) - Tri(0, 0), Tri(2, 1) - Tri(0, 1), Tri(2, 2) - Tri(0, 2));
-
-        Eigen::Vector3d crossResult = lin1.cross(lin2);
-        double area = crossResult.norm();
-        if(area < 1e-8)
-        {
-            emptyTri.push_back(i);
-        }
-    }
-
-    std::cout << "There are " << emptyTri.size() << " cells whose area is equal to zero.\n";
-
-    // 去除面积为0的单元
-
-    struct node
-    {
-        int oldid;
-        Eigen::Vector3d point;
-    };
-    vector<node> vec(V.rows(), node());
-    map<int, int> mpid;
-
-    for(int i = 0; i < V.rows(); i++)
-    {
-        vec[i].oldid = i;
-        vec[i].point = V.row(i);
-    }
-
-    std::sort(vec.begin(), vec.end(), [](const node& a, const node& b)
-    {
-        if( a.point.x() != b.point.x() ) return a.point.x() < b.point.x();
-        if( a.point.y() != b.point.y() ) return a.point.y() < b.point.y();
-        if( a.point.z() != b.point.z() ) return a.point.z() < b.point.z();
-        return a.oldid < b.oldid;
-    });
-
-    int curid = 0;
-    for(int i = 0; i < vec.size(); i++)
-    {
-        while( i + 1 < vec.size() && (vec[i].point - vec[i + 1].point).norm() < 1e-8 )
-        {
-            mpid[vec[i].oldid] = curid;
-            i++;
-        }
-        mpid[vec[i].oldid] = curid;
-        curid++;
-    }
-
-    V.resize(curid, V.cols());
-
-    for(int i = 0; i < vec.size(); i++)
-    {
-        V.row(mpid[ vec[i].oldid ]) = vec[i].point;
-        while( i + 1 < vec.size() && (vec[i].point - vec[i + 1].point).norm() < 1e-8 ) i++;
-    }
-
-    Eigen::MatrixXi T2;
-    Eigen::MatrixXi M2;
-    T2.resize(T.rows() - emptyTri.size(), T.cols());
-    M2.resize(T.rows() - emptyTri.size(), M.cols());
-
-    int locT2 = 0, locEmptyTri = 0;
-    for(int i = 0; i < T.rows(); i++)
-    {
-        if(emptyTri[locEmptyTri] == i)
-        {
-            locEmptyTri++;
-            continue;
-        }
-        for(int j = 0; j < T.cols(); j++)
-        {
-            T2(locT2, j) = mpid[T(i, j)];
-        }
-        locT2++;
-    }
-
-    T = T2;
-    // M = M2;
-
-    std::cout << "Vertex number is  " << V.rows() << " X " << V.cols() << "  after clean. \n";
-    std::cout << "Cell number is  " << T.rows() << " X " << T.cols() << "  after clean. \n";
-    std::cout << "Attribute number is  " << M.rows() << " X " << M.cols() << "  after clean. \n";
-    std::cout << "Clean all cell whose area is equal to zero. " << '\n';
-	return 0;
+    return Kernels::repair(V, T, M);
 }
@@ -1,7 +1,10 @@
 #ifndef MESHIO_H
 #define MESHIO_H
 
+#include "MeshAttributes.h"
+
 #include <Eigen/Dense>
+#include <iosfwd>
 #include <map>
 #include <string>
 #include <vector>
@@ -15,19 +18,39 @@
 namespace MESHIO{
 
 int readVTK(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, std::string mark_pattern = "");
+int readVTK(std::istream &in, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, std::string mark_pattern = "", std::string filename = "");
+// Also keep every other CELL_DATA and POINT_DATA array.
+int readVTK(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, MeshAttributes &attributes, std::string mark_pattern = "");
+int readVTK(std::istream &in, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M, MeshAttributes &attributes, std::string mark_pattern = "", std::string filename = "");
 int readEPS(std::string filename, int& cou, std::map<int, double>& mpd, std::map<int, std::vector<int>>& mpi);
 int readMESH(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
+int readMESH(std::istream &in, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
 int readPLS(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
+int readPLS(std::istream &in, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
 int readPLY(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M); //TODO
 int readOBJ(std::string filename, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
+int readOBJ(std::istream &in, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
 
 int writeVTK(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi M = Eigen::MatrixXi(), std::string mark_pattern = "");
+int writeVTK(std::ostream &out, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi M = Eigen::MatrixXi(), std::string mark_pattern = "");
+int writeVTK(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi M, const MeshAttributes &attributes, std::string mark_pattern = "");
+int writeVTK(std::ostream &out, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi M, const MeshAttributes &attributes, std::string mark_pattern = "");
 int writeEpsVTK(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, int& cou, std::map<int, double>& mpd, std::map<int, std::vector<int>>& mpi, std::string mark_pattern = "");
 int writeMESH(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T);
+int writeMESH(std::ostream &out, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T);
 int writePLY(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T);
+int writePLY(std::ostream &out, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T);
+// Also write the point normals among attributes (see MeshNormals.h), the other attributes have no place in PLY.
+int writePLY(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const MeshAttributes &attributes);
+int writePLY(std::ostream &out, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const MeshAttributes &attributes);
 int writePLS(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M);
+int writePLS(std::ostream &out, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M);
 int writeFacet(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M);
+int writeFacet(std::ostream &out, const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::MatrixXi &M);
 int writeOBJ(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi& T, const Eigen::MatrixXi &M);
+int writeOBJ(std::ostream &out, const Eigen::MatrixXd &V, const Eigen::MatrixXi& T, const Eigen::MatrixXi &M);
+int writeOBJ(std::string filename, const Eigen::MatrixXd &V, const Eigen::MatrixXi& T, const Eigen::MatrixXi &M, const MeshAttributes &attributes);
+int writeOBJ(std::ostream &out, const Eigen::MatrixXd &V, const Eigen::MatrixXi& T, const Eigen::MatrixXi &M, const MeshAttributes &attributes);
 
 bool rotatePoint(std::vector<double> rotateVec, Eigen::MatrixXd &V, Eigen::MatrixXi &T);
 bool addBox(std::vector<double> boxVec, Eigen::MatrixXd &V, Eigen::MatrixXi &T, Eigen::MatrixXi &M);
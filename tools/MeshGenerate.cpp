@@ -0,0 +1,49 @@
+/**
+ * meshconverter_generate: write a synthetic mesh in any supported format.
+ *
+ *   meshconverter_generate --shape torus --facets 10000000 -o torus.vtk
+ */
+#include "MeshAPI.h"
+#include "MeshGenerator.h"
+#include "CLI11.hpp"
+
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    CLI::App app{"meshconverter_generate"};
+    string shapeName = "sphere";
+    string output;
+    MESHIO::GeneratorOptions opt;
+    app.add_option("--shape", shapeName, "sphere | torus | shells | patches | soup | markers | tets (default: sphere)");
+    app.add_option("--facets", opt.facets, "Requested number of facets. (default: 100000)");
+    app.add_option("--groups", opt.groups, "Number of marker groups of the markers shape. (default: 64)");
+    app.add_option("--seed", opt.seed, "Seed of the patches, soup and tets shapes. (default: 1)");
+    app.add_option("-o", output, "Output file, the format is given by the extension. (vtk, mesh, ply, pls, facet, obj, mcb)")->required();
+    CLI11_PARSE(app, argc, argv);
+
+    MESHIO::MeshFormat format = MESHIO::formatFromName(output);
+    if(format == MESHIO::MeshFormat::Unknown) {
+        cout << "Unsupported output format - " << output << endl;
+        return -1;
+    }
+    if(!MESHIO::shapeFromName(shapeName, opt.shape))
+        return -1;
+
+    Eigen::MatrixXd V;
+    Eigen::MatrixXi F, M;
+    if(MESHIO::generateMesh(opt, V, F, M) < 0)
+        return -1;
+    cout << "Generated " << shapeName << " with " << V.rows() << " points and " << F.rows() << " facets." << endl;
+
+    std::ofstream out(output, std::ios::binary);
+    if(!out.is_open()) {
+        cout << "Write file failed. - " << output << endl;
+        return -1;
+    }
+    cout << "Writing mesh to - " << output << endl;
+    return MESHIO::writeMesh(out, format, V, F, M) == 1 ? 0 : -1;
+}